@@ -2,6 +2,13 @@
 #include "Preferences.h"
 #include "PubSubClient.h"
 #include "Version.h"
+#include "JuraOrderQueue.h"
+#include "JuraPreheat.h"
+#include "JuraJitterProbe.h"
+#include "JuraMemoryMonitor.h"
+#include "JuraUartCalibration.h"
+#include "JuraNetwork.h"
+#include <base64.h>
 
 #define DEFAULT_NUMERIC_STATE 999
 
@@ -9,20 +16,20 @@
 JuraBridge::JuraBridge(
   Preferences &prefsRef, 
   PubSubClient &mqttClientRef,  
-  SemaphoreHandle_t &xMQTTSemaphoreRef, 
-  SemaphoreHandle_t &xUARTSemaphoreRef) :  
+  SemaphoreHandle_t &xMQTTSemaphoreRef) :  
   preferences(prefsRef), 
   mqttClient(mqttClientRef), 
-  xMQTTSemaphore(xMQTTSemaphoreRef), 
-  xUARTSemaphore(xUARTSemaphoreRef), 
-  servicePort(xUARTSemaphoreRef) {
+  xMQTTSemaphore(xMQTTSemaphoreRef),
+  display(servicePort) {
   
   /* set index association table */
   int stateAttributeArraySize = sizeof(JuraEntityConfigurations) / sizeof(JuraEntityConfigurations[0]) ; 
   for (int i = 0; i < stateAttributeArraySize ; i++){
     _stateIndexToConfigurationIndex[(int)JuraEntityConfigurations[i].state] = i; 
     _reportableNumericStates[i] = DEFAULT_NUMERIC_STATE;
+    _reportableStringStates[i] = NULL;
   }
+  memset(_backlog_dirty, 0, sizeof(_backlog_dirty));
 }
 
 /***************************************************************************//**
@@ -33,6 +40,7 @@ JuraBridge::JuraBridge(
  * @param[in] null
  ******************************************************************************/
   void JuraBridge::publishMachineEntityConfigurations() {
+  JURA_MEMORY_PROFILE("entity_config");
 
   /* iterate through state attributes */
   int stateAttributeArraySize = sizeof(JuraEntityConfigurations) / sizeof(JuraEntityConfigurations[0]) ; 
@@ -54,7 +62,7 @@ JuraBridge::JuraBridge(
     char config_topic[255];   
     
     /* mqtt configuration */
-    char buffer[2048];  DynamicJsonDocument mqttJsonConfigurationBody(2048);
+    DynamicJsonDocument mqttJsonConfigurationBody(2048);
  
     /* different payload types */
     if (JuraEntityConfigurations[i].dataType == JuraMachineStateDataType::Boolean){ 
@@ -136,6 +144,9 @@ JuraBridge::JuraBridge(
       case JuraMachineStateUnit::Hours:
         mqttJsonConfigurationBody["unit_of_measurement"] = "hr";
         break;
+      case JuraMachineStateUnit::Bytes:
+        mqttJsonConfigurationBody["unit_of_measurement"] = "B";
+        break;
       case JuraMachineStateUnit::None:
         mqttJsonConfigurationBody["unit_of_measurement"] = "";
         break;
@@ -235,6 +246,7 @@ JuraBridge::JuraBridge(
       case JuraMachineSubsystem::Bridge: 
         mqttJsonConfigurationBody["device"]["identifiers"][0] =   BRIDGE_NAME;
         mqttJsonConfigurationBody["device"]["name"] =             BRIDGE_NAME;
+        mqttJsonConfigurationBody["entity_category"] =            "diagnostic";
         break;
     }
 
@@ -244,11 +256,8 @@ JuraBridge::JuraBridge(
     mqttJsonConfigurationBody["device"]["sw_version"] =       VERSION_STR;
 
     /* publish this device */
-    size_t n = serializeJson(mqttJsonConfigurationBody, buffer);
     ESP_LOGI(TAG,"[enabled]: %s",config_topic);
-    xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
-    mqttClient.publish(config_topic, buffer, n);
-    xSemaphoreGive(xMQTTSemaphore);
+    publishJson(config_topic, mqttJsonConfigurationBody, true);
 
     /* meter the mqtt sending */
     vTaskDelay(500 / portTICK_PERIOD_MS);
@@ -265,6 +274,7 @@ JuraBridge::JuraBridge(
  ******************************************************************************/
 
 void JuraBridge::publishMachineFunctionConfiguration(){
+  JURA_MEMORY_PROFILE("function_config");
 
   /* iterate through state attributes */
   int functionEntityArraySize = sizeof(JuraMachineFunctionEntityConfigurations) / sizeof(JuraMachineFunctionEntityConfigurations[0]) ; 
@@ -283,7 +293,7 @@ void JuraBridge::publishMachineFunctionConfiguration(){
   for (int i = 0; i < functionEntityArraySize; i++){
 
     /* mqtt configuration */
-    char buffer[2048];  DynamicJsonDocument mqttJsonConfigurationBody(2048);
+    DynamicJsonDocument mqttJsonConfigurationBody(2048);
     char config_topic[255]; sprintf(config_topic, "homeassistant/button/%s/config",  JuraMachineFunctionEntityConfigurations[i].entity_id );
     char unique_id[255]; sprintf(unique_id, ENTITY_PREFIX "uid_%s", JuraMachineFunctionEntityConfigurations[i].entity_id );
 
@@ -393,17 +403,37 @@ void JuraBridge::publishMachineFunctionConfiguration(){
     mqttJsonConfigurationBody["device"]["sw_version"] =       VERSION_STR;
 
     /* publish this device */
-    ESP_LOGI(TAG,"[enabled]: %s %s",config_topic, buffer);
-    size_t n = serializeJson(mqttJsonConfigurationBody, buffer);
-    xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
-    mqttClient.publish(config_topic, buffer, n);
-    xSemaphoreGive(xMQTTSemaphore);
+    ESP_LOGI(TAG,"[enabled]: %s",config_topic);
+    publishJson(config_topic, mqttJsonConfigurationBody, true);
 
     /* meter the mqtt sending */
     vTaskDelay(500 / portTICK_PERIOD_MS);
   }
 }
 
+/***************************************************************************//**
+ * Serialize a json document into the shared payload buffer and publish it. The
+ * mqtt semaphore is held for both, so the buffer is never shared.
+ *
+ * @param[out] bool false if the payload did not fit or the publish failed
+ *     
+ * @param[in] const char *topic
+ * @param[in] const JsonDocument &document
+ * @param[in] bool retained
+ ******************************************************************************/
+ bool JuraBridge::publishJson(const char * topic, const JsonDocument &document, bool retained){
+  if (measureJson(document) >= sizeof(_payload)){
+    ESP_LOGE(TAG,"--> Payload for %s exceeds %u bytes", topic, (unsigned) sizeof(_payload));
+    return false;
+  }
+
+  xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
+  size_t n = serializeJson(document, _payload, sizeof(_payload));
+  bool published = mqttClient.publish(topic, (const uint8_t *) _payload, n, retained);
+  xSemaphoreGive(xMQTTSemaphore);
+  return published;
+ }
+
 /***************************************************************************//**
  * Specialized mqtt publication for automatic rinsing 
  *
@@ -419,6 +449,475 @@ void JuraBridge::publishMachineFunctionConfiguration(){
   xSemaphoreGive(xMQTTSemaphore);
  }
 
+/***************************************************************************//**
+ * Publish a completed shot profile as a single message; the sample stream is
+ * base64 encoded and described by the channel and encoding fields
+ *
+ * @param[out] null 
+ *     
+ * @param[in] profile JuraShotProfile completed profile from the recorder
+ ******************************************************************************/
+ void JuraBridge::publishShotProfile(const JuraShotProfile &profile){
+  JURA_MEMORY_PROFILE("shot_profile");
+  DynamicJsonDocument mqttJsonProfileBody(2048);
+
+  mqttJsonProfileBody["seq"] =        profile.sequence;
+  mqttJsonProfileBody["type"] =       profile.dispenseType;
+  mqttJsonProfileBody["ms"] =         profile.duration;
+  mqttJsonProfileBody["n"] =          profile.sampleCount;
+  mqttJsonProfileBody["trunc"] =      profile.truncated;
+  mqttJsonProfileBody["ch"] =         SHOT_PROFILE_CHANNEL_NAMES;
+  mqttJsonProfileBody["enc"] =        SHOT_PROFILE_ENCODING;
+  mqttJsonProfileBody["data"] =       base64::encode(profile.data, profile.length);
+
+  publishJson(MQTT_ROOT MQTT_SHOT_PROFILE, mqttJsonProfileBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish the order queue: depth, the order in service and each pending order
+ * with its eta (s), and the measured service time (ms) of every product made
+ * through the queue. Retained, so a dashboard sees the queue on connect.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] status JuraOrderQueueStatus snapshot from the order queue
+ ******************************************************************************/
+ void JuraBridge::publishOrderQueueStatus(const JuraOrderQueueStatus &status){
+  DynamicJsonDocument mqttJsonOrderBody(1024);
+
+  mqttJsonOrderBody["depth"] = status.depth;
+
+  JsonArray orders = mqttJsonOrderBody.createNestedArray("orders");
+  if (status.serving){
+    JsonObject order = orders.createNestedObject();
+    order["id"] =           status.current.id;
+    order["function"] =     functionKey((JuraFunctionIdentifier) status.current.recipe.function);
+    if (status.current.program != JURA_ORDER_NO_PROGRAM){order["recipe"] = status.current.program;}
+    order["eta"] =          status.currentEta / 1000;
+    order["serving"] =      true;
+  }
+  for (int i = 0; i < status.depth - (status.serving ? 1 : 0); i++){
+    JsonObject order = orders.createNestedObject();
+    order["id"] =           status.pending[i].id;
+    order["function"] =     functionKey((JuraFunctionIdentifier) status.pending[i].recipe.function);
+    if (status.pending[i].program != JURA_ORDER_NO_PROGRAM){order["recipe"] = status.pending[i].program;}
+    order["eta"] =          status.pendingEta[i] / 1000;
+  }
+
+  JsonObject service = mqttJsonOrderBody.createNestedObject("service");
+  for (int i = 0; i < JURA_ORDER_PRODUCT_SLOTS; i++){
+    if (status.serviceCount[i] == 0){continue;}
+    JsonObject product = service.createNestedObject(functionKey((JuraFunctionIdentifier) i));
+    product["ms"] =         status.serviceTime[i];
+    product["n"] =          status.serviceCount[i];
+  }
+
+  publishJson(MQTT_ROOT MQTT_ORDER_STATUS, mqttJsonOrderBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish the stored user recipe programs: slot id, name and bytecode size.
+ * Retained, so the list is available to Home Assistant at any time.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] programs JuraRecipeProgramStore
+ ******************************************************************************/
+ void JuraBridge::publishRecipeProgramList(JuraRecipeProgramStore &programs){
+  DynamicJsonDocument mqttJsonRecipeBody(1024);
+  JsonArray recipes = mqttJsonRecipeBody.to<JsonArray>();
+
+  JuraRecipeProgram program;
+  for (uint8_t id = 0; id < JURA_RECIPE_PROGRAMS_MAX; id++){
+    if (!programs.copy(id, program)){continue;}
+    JsonObject recipe = recipes.createNestedObject();
+    recipe["id"] =          id;
+    recipe["name"] =        program.name;
+    recipe["bytes"] =       program.length;
+  }
+
+  publishJson(MQTT_ROOT MQTT_RECIPE_LIST, mqttJsonRecipeBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish drink latency for the product of the drink just completed, at
+ * /latency/<function> ("machine" for products selected on the machine): ms of
+ * every milestone of that drink from its first, and the median and 90th
+ * percentile of each stage (from the milestone reached before it) and of the
+ * whole drink over the ring. Retained.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] latency JuraLatencyRecorder
+ ******************************************************************************/
+ void JuraBridge::publishDrinkLatency(JuraLatencyRecorder &latency){
+  DynamicJsonDocument mqttJsonLatencyBody(1024);
+  static const char * const milestoneNames[] = JURA_LATENCY_MILESTONE_NAMES;
+
+  JuraLatencyTrace trace;
+  if (!latency.latest(trace)){return;}
+
+  JuraLatencySummary summary;
+  latency.summarize(trace.function, summary);
+
+  int first = 0;
+  while (first < JURA_LATENCY_MILESTONES - 1 && trace.at[first] == 0){first++;}
+
+  JsonObject last = mqttJsonLatencyBody.createNestedObject("last");
+  last["seq"] = trace.sequence;
+  for (int m = first; m < JURA_LATENCY_MILESTONES; m++){
+    if (trace.at[m] == 0){continue;}
+    last[milestoneNames[m]] = trace.at[m] - trace.at[first];
+  }
+
+  mqttJsonLatencyBody["n"] = summary.count;
+  JsonObject total = mqttJsonLatencyBody.createNestedObject("total");
+  total["p50"] = summary.totalP50;
+  total["p90"] = summary.totalP90;
+
+  JsonObject stages = mqttJsonLatencyBody.createNestedObject("stages");
+  for (int m = 0; m < JURA_LATENCY_MILESTONES; m++){
+    if (summary.stageCount[m] == 0){continue;}
+    JsonObject stage = stages.createNestedObject(milestoneNames[m]);
+    stage["p50"] = summary.stageP50[m];
+    stage["p90"] = summary.stageP90[m];
+    stage["n"] =   summary.stageCount[m];
+  }
+
+  const char * key = (JuraFunctionIdentifier) trace.function == JuraFunctionIdentifier::None ? "machine" : functionKey((JuraFunctionIdentifier) trace.function);
+  String topic = String(MQTT_ROOT MQTT_LATENCY "/") + key;
+
+  publishJson(topic.c_str(), mqttJsonLatencyBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish the eeprom research scan after a sweep with changes: a hex bitmap of
+ * words changed since boot (word 0 is the leftmost bit) and the changes since
+ * the last message. States are JuraMachineOperationalState values; through is
+ * a bit per state entered between the two reads of the word's line.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] scanner JuraEepromScanner
+ ******************************************************************************/
+ void JuraBridge::publishEepromScan(JuraEepromScanner &scanner){
+  DynamicJsonDocument mqttJsonScanBody(2560);
+  JuraEepromChange changes[JURA_EEPROM_SCAN_PUBLISH_MAX];
+  int count = scanner.takeChanges(changes, JURA_EEPROM_SCAN_PUBLISH_MAX);
+
+  char bitmap[JURA_EEPROM_SCAN_WORDS / 4 + 1];
+  for (int i = 0; i < JURA_EEPROM_SCAN_WORDS / 4; i++){
+    int nibble = 0;
+    for (int b = 0; b < 4; b++){nibble = (nibble << 1) | scanner.hasChanged(i * 4 + b);}
+    bitmap[i] = "0123456789ABCDEF"[nibble];
+  }
+  bitmap[JURA_EEPROM_SCAN_WORDS / 4] = '\0';
+
+  mqttJsonScanBody["sweep"] =   scanner.sweeps();
+  mqttJsonScanBody["changed"] = bitmap;
+
+  JsonArray list = mqttJsonScanBody.createNestedArray("changes");
+  for (int i = 0; i < count; i++){
+    JsonObject change = list.createNestedObject();
+    change["word"] =    changes[i].word;
+    change["from"] =    changes[i].from;
+    change["to"] =      changes[i].to;
+    change["before"] =  changes[i].before;
+    change["after"] =   changes[i].after;
+    change["through"] = changes[i].through;
+    change["ms"] =      changes[i].at;
+  }
+
+  publishJson(MQTT_ROOT MQTT_RESEARCH_EEPROM, mqttJsonScanBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish the working memory scanner after a sweep, or a dispense with watch
+ * points, that found changes: a hex bitmap of addresses changed since boot
+ * (address 0 is the leftmost bit), the watch points, and the changes since the
+ * last message with the operational state each was read in.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] scanner JuraWorkingMemoryScanner
+ ******************************************************************************/
+ void JuraBridge::publishWorkingMemory(JuraWorkingMemoryScanner &scanner){
+  DynamicJsonDocument mqttJsonMemoryBody(3072);
+  JuraWorkingMemoryChange changes[JURA_WORKING_MEMORY_PUBLISH_MAX];
+  int count = scanner.takeChanges(changes, JURA_WORKING_MEMORY_PUBLISH_MAX);
+
+  char bitmap[JURA_WORKING_MEMORY_WORDS / 4 + 1];
+  for (int i = 0; i < JURA_WORKING_MEMORY_WORDS / 4; i++){
+    int nibble = 0;
+    for (int b = 0; b < 4; b++){nibble = (nibble << 1) | scanner.hasChanged(i * 4 + b);}
+    bitmap[i] = "0123456789ABCDEF"[nibble];
+  }
+  bitmap[JURA_WORKING_MEMORY_WORDS / 4] = '\0';
+
+  mqttJsonMemoryBody["sweep"] =   scanner.sweeps();
+  mqttJsonMemoryBody["changed"] = bitmap;
+
+  uint8_t watches[JURA_WORKING_MEMORY_WATCH_MAX];
+  int watchCount = scanner.watches(watches, JURA_WORKING_MEMORY_WATCH_MAX);
+  JsonObject watchBody = mqttJsonMemoryBody.createNestedObject("watch");
+  for (int i = 0; i < watchCount; i++){
+    char address[3];
+    snprintf(address, sizeof(address), "%02X", watches[i]);
+    watchBody[address] = scanner.value(watches[i]);
+  }
+
+  JsonArray list = mqttJsonMemoryBody.createNestedArray("changes");
+  for (int i = 0; i < count; i++){
+    JsonObject change = list.createNestedObject();
+    change["address"] = changes[i].address;
+    change["from"] =    changes[i].from;
+    change["to"] =      changes[i].to;
+    change["state"] =   changes[i].state;
+    change["watch"] =   changes[i].watched;
+    change["ms"] =      changes[i].at;
+  }
+
+  publishJson(MQTT_ROOT MQTT_RESEARCH_MEMORY, mqttJsonMemoryBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish one window of the poll loop jitter probe (us), with the core and
+ * priority the poll ran at.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] report JuraJitterReport
+ ******************************************************************************/
+ void JuraBridge::publishPollJitter(const JuraJitterReport &report){
+  DynamicJsonDocument mqttJsonJitterBody(512);
+
+  mqttJsonJitterBody["seq"] =         report.sequence;
+  mqttJsonJitterBody["n"] =           report.samples;
+  mqttJsonJitterBody["period"] =      report.periodMean;
+  mqttJsonJitterBody["period_sd"] =   report.periodDeviation;
+  mqttJsonJitterBody["period_max"] =  report.periodMax;
+  mqttJsonJitterBody["late"] =        report.lateMean;
+  mqttJsonJitterBody["late_max"] =    report.lateMax;
+  mqttJsonJitterBody["bound"] =       JURA_POLL_JITTER_BOUND_US;
+  mqttJsonJitterBody["over"] =        report.overBound;
+  mqttJsonJitterBody["core"] =        report.core;
+  mqttJsonJitterBody["priority"] =    report.priority;
+
+  publishJson(MQTT_ROOT MQTT_JITTER, mqttJsonJitterBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish the machine link state; retained, so the last outage survives a
+ * dashboard restart. Times in seconds.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] status JuraConnectionStatus
+ ******************************************************************************/
+ void JuraBridge::publishMachineConnection(const JuraConnectionStatus &status){
+  DynamicJsonDocument mqttJsonConnectionBody(256);
+  static const char * const stateNames[] = {"online", "degraded", "offline", "offline"};
+
+  mqttJsonConnectionBody["state"] =     stateNames[(int) status.state];
+  mqttJsonConnectionBody["for"] =       status.stateMs / 1000;
+  mqttJsonConnectionBody["outages"] =   status.outages;
+  mqttJsonConnectionBody["offline"] =   status.offlineMs / 1000;
+
+  publishJson(MQTT_ROOT MQTT_CONNECTION, mqttJsonConnectionBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish network recovery after a reconnect; retained. Times in ms.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] status JuraNetworkStatus
+ ******************************************************************************/
+ void JuraBridge::publishNetwork(const JuraNetworkStatus &status){
+  DynamicJsonDocument mqttJsonNetworkBody(384);
+
+  mqttJsonNetworkBody["recoveries"] =       status.recoveries;
+  mqttJsonNetworkBody["recovery_ms"] =      status.lastRecoveryMs;
+  mqttJsonNetworkBody["recovery_max_ms"] =  status.maxRecoveryMs;
+  mqttJsonNetworkBody["wifi_ms"] =          status.lastWiFiMs;
+  mqttJsonNetworkBody["wifi_attempts"] =    status.wifiAttempts;
+  mqttJsonNetworkBody["broker_attempts"] =  status.brokerAttempts;
+  mqttJsonNetworkBody["cached_ap"] =        status.fastReassociation;
+  mqttJsonNetworkBody["channel"] =          status.channel;
+  mqttJsonNetworkBody["rssi"] =             status.rssi;
+  mqttJsonNetworkBody["reason"] =           status.lastReason;
+
+  publishJson(MQTT_ROOT MQTT_NETWORK, mqttJsonNetworkBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish the service port character gap; retained. Gaps in microseconds.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] status JuraUartCalibrationStatus
+ ******************************************************************************/
+ void JuraBridge::publishUartCalibration(const JuraUartCalibrationStatus &status){
+  DynamicJsonDocument mqttJsonUartBody(256);
+
+  mqttJsonUartBody["gap_us"] =        status.gapUs;
+  mqttJsonUartBody["default_us"] =    DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL;
+  mqttJsonUartBody["measured_us"] =   status.measuredUs;
+  mqttJsonUartBody["calibrations"] =  status.calibrations;
+  mqttJsonUartBody["fallbacks"] =     status.fallbacks;
+  mqttJsonUartBody["calibrating"] =   status.calibrating;
+
+  publishJson(MQTT_ROOT MQTT_UART, mqttJsonUartBody, true);
+ }
+
+/***************************************************************************//**
+ * Publish service port arbitration per lane over the last report window, and
+ * the display writes saved over the same window.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] stats JuraUartLaneStats[JURA_UART_LANES]
+ ******************************************************************************/
+ void JuraBridge::publishUartLanes(const JuraUartLaneStats * stats){
+  DynamicJsonDocument mqttJsonLanesBody(512);
+  static const char * const laneNames[JURA_UART_LANES] = {"safety", "user", "background"};
+
+  for (int l = 0; l < JURA_UART_LANES; l++){
+    JsonObject lane = mqttJsonLanesBody.createNestedObject(laneNames[l]);
+    lane["transfers"] =   stats[l].transfers;
+    lane["waited"] =      stats[l].waited;
+    lane["mean_us"] =     stats[l].meanWaitUs;
+    lane["max_us"] =      stats[l].maxWaitUs;
+    lane["preempted"] =   stats[l].preempted;
+  }
+
+  JuraDisplayStats displayStats;
+  display.report(displayStats);
+  JsonObject displayBody = mqttJsonLanesBody.createNestedObject("display");
+  displayBody["writes"] =     displayStats.writes;
+  displayBody["skipped"] =    displayStats.skipped;
+  displayBody["merged"] =     displayStats.merged;
+  displayBody["deferred"] =   displayStats.deferred;
+
+  publishJson(MQTT_ROOT MQTT_UART_LANES, mqttJsonLanesBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish memory diagnostics: heap and least stack headroom as bridge entities,
+ * and the full sample (every task's stack and headroom; with MEMORY_PROFILING
+ * the low water marks set by each profiled path) on /diagnostics/memory.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] memory JuraMemoryMonitor, sampled
+ ******************************************************************************/
+ void JuraBridge::publishMemory(JuraMemoryMonitor &memory){
+  DynamicJsonDocument mqttJsonMemoryBody(2048);
+  JuraHeapMemory heap = memory.heap();
+
+  machineStateChanged(JuraMachineStateIdentifier::BridgeFreeHeap,           heap.free);
+  machineStateChanged(JuraMachineStateIdentifier::BridgeMinimumFreeHeap,    heap.minimum);
+  machineStateChanged(JuraMachineStateIdentifier::BridgeLargestFreeBlock,   heap.largest);
+  machineStateChanged(JuraMachineStateIdentifier::BridgeHeapFragmentation,  heap.fragmentation);
+  machineStateChanged(JuraMachineStateIdentifier::BridgeStackHeadroom,      memory.minimumHeadroom());
+
+  JsonObject heapBody = mqttJsonMemoryBody.createNestedObject("heap");
+  heapBody["free"] =        heap.free;
+  heapBody["min"] =         heap.minimum;
+  heapBody["largest"] =     heap.largest;
+  heapBody["frag"] =        heap.fragmentation;
+
+  JsonObject tasks = mqttJsonMemoryBody.createNestedObject("tasks");
+  JuraTaskMemory task;
+  for (int i = 0; memory.task(i, task); i++){
+    JsonObject entry = tasks.createNestedObject(task.name);
+    entry["stack"] =        task.stack;
+    entry["headroom"] =     task.headroom;
+  }
+
+  JuraMemoryPath path;
+  if (JuraMemoryMonitor::pathCount() > 0){
+    JsonObject paths = mqttJsonMemoryBody.createNestedObject("paths");
+    for (int i = 0; JuraMemoryMonitor::path(i, path); i++){
+      JsonObject entry = paths.createNestedObject(path.name);
+      entry["n"] =          path.calls;
+      if (path.headroom != 0xFFFFFFFF){entry["task"] = path.task; entry["headroom"] = path.headroom;}
+      if (path.heapLow != 0xFFFFFFFF){entry["heap_low"] = path.heapLow;}
+    }
+  }
+
+  publishJson(MQTT_ROOT MQTT_MEMORY, mqttJsonMemoryBody, false);
+ }
+
+/***************************************************************************//**
+ * Publish the predictive preheat: the first drink histogram, the next expected
+ * first drink today (hh:mm, start of its bin), and average time from selection
+ * to dispense start for first drinks with and without a preheat ahead of them.
+ * Retained.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] status JuraPreheatStatus snapshot from the planner
+ ******************************************************************************/
+ void JuraBridge::publishPreheatStatus(const JuraPreheatStatus &status){
+  DynamicJsonDocument mqttJsonPreheatBody(1024);
+  const JuraPreheatHistory &history = status.history;
+
+  mqttJsonPreheatBody["clock"] =              status.clockSet;
+  mqttJsonPreheatBody["first_drinks"] =       history.firstDrinks;
+  if (status.nextBin >= 0){
+    int minute = status.nextBin * (1440 / JURA_PREHEAT_BINS);
+    char next[6]; snprintf(next, sizeof(next), "%02d:%02d", minute / 60, minute % 60);
+    mqttJsonPreheatBody["next"] =             next;
+  }
+  mqttJsonPreheatBody["preheats"] =           history.preheats;
+  mqttJsonPreheatBody["warnings_avoided"] =   history.warningsAvoided;
+
+  unsigned long coldMs = history.coldCount > 0 ? history.coldLatencyMs / history.coldCount : 0;
+  unsigned long preheatedMs = history.preheatedCount > 0 ? history.preheatedLatencyMs / history.preheatedCount : 0;
+  JsonObject latency = mqttJsonPreheatBody.createNestedObject("latency");
+  latency["cold_ms"] =                        coldMs;
+  latency["cold_n"] =                         history.coldCount;
+  latency["preheated_ms"] =                   preheatedMs;
+  latency["preheated_n"] =                    history.preheatedCount;
+  if (history.coldCount > 0 && history.preheatedCount > 0){
+    latency["saved_ms"] =                     (long) coldMs - (long) preheatedMs;
+  }
+
+  JsonArray histogram = mqttJsonPreheatBody.createNestedArray("histogram");
+  for (int i = 0; i < JURA_PREHEAT_BINS; i++){histogram.add(history.bins[i]);}
+
+  publishJson(MQTT_ROOT MQTT_PREHEAT, mqttJsonPreheatBody, true);
+ }
+
+/***************************************************************************//**
+ * Entity id of a function, without ENTITY_PREFIX; used as the function name in
+ * order messages.
+ *
+ * @param[out] const char * key, empty if the function has no entity
+ *     
+ * @param[in] JuraFunctionIdentifier identifier
+ ******************************************************************************/
+const char * JuraBridge::functionKey(JuraFunctionIdentifier identifier){
+  int functionEntityArraySize = sizeof(JuraMachineFunctionEntityConfigurations) / sizeof(JuraMachineFunctionEntityConfigurations[0]) ; 
+  for (int i = 0; i < functionEntityArraySize; i++){
+    if (identifier == JuraMachineFunctionEntityConfigurations[i].function){
+      return JuraMachineFunctionEntityConfigurations[i].entity_id + strlen(ENTITY_PREFIX);
+    }
+  }
+  return "";
+}
+
+JuraFunctionIdentifier JuraBridge::functionForKey(const char * key){
+  int functionEntityArraySize = sizeof(JuraMachineFunctionEntityConfigurations) / sizeof(JuraMachineFunctionEntityConfigurations[0]) ; 
+  for (int i = 0; i < functionEntityArraySize; i++){
+    if (strcmp(key, JuraMachineFunctionEntityConfigurations[i].entity_id + strlen(ENTITY_PREFIX)) == 0){
+      return JuraMachineFunctionEntityConfigurations[i].function;
+    }
+  }
+  return JuraFunctionIdentifier::None;
+}
+
 /***************************************************************************//**
  * Subscribe to machine function mqtt topics 
  *
@@ -456,8 +955,15 @@ void JuraBridge::subscribeToBridgeSubtopics(){
   
   mqttClient.subscribe(MQTT_ROOT MQTT_SUBTOPIC_MENU);
   mqttClient.subscribe(MQTT_ROOT MQTT_BRIDGE_RESTART);
+  mqttClient.subscribe(MQTT_ROOT MQTT_UART_CALIBRATE);
   mqttClient.subscribe(MQTT_ROOT MQTT_CONFIG_SEND);
   mqttClient.subscribe(MQTT_ROOT MQTT_DISPENSE_CONFIG);  
+  mqttClient.subscribe(MQTT_ROOT MQTT_ORDER);
+  mqttClient.subscribe(MQTT_ROOT MQTT_MENU_ITEM);
+  mqttClient.subscribe(MQTT_ROOT MQTT_RECIPE_SET);
+  mqttClient.subscribe(MQTT_ROOT MQTT_RECIPE_RUN);
+  mqttClient.subscribe(HA_STATUS_MQTT);
+  if (WORKING_MEMORY_SCANNER){mqttClient.subscribe(MQTT_ROOT MQTT_RESEARCH_MEMORY_WATCH);}
 }
 
 /***************************************************************************//**
@@ -465,9 +971,9 @@ void JuraBridge::subscribeToBridgeSubtopics(){
  *
  * @param[out] null 
  *     
- * @param[in] null
+ * @param[in] priority JuraDisplayPriority
  ******************************************************************************/
-void JuraBridge::instructServicePortToSetReady(){servicePort.transferEncode("DT: READY v" VERSION_MAJOR_STR);}
+void JuraBridge::instructServicePortToSetReady(JuraDisplayPriority priority){display.show("DT: READY v" VERSION_MAJOR_STR, priority);}
 
 /***************************************************************************//**
  * Special handler to print custom message to display; bad characters ignored by machine; 
@@ -476,8 +982,9 @@ void JuraBridge::instructServicePortToSetReady(){servicePort.transferEncode("DT:
  * @param[out] null 
  *     
  * @param[in] command String 10 characters or fewer to display 
+ * @param[in] priority JuraDisplayPriority
  ******************************************************************************/
-void JuraBridge::instructServicePortToDisplayString(String command) {servicePort.transferEncode("DT:" + command);}
+void JuraBridge::instructServicePortToDisplayString(String command, JuraDisplayPriority priority) {display.show(("DT:" + command).c_str(), priority);}
 
 /***************************************************************************//**
  * Special handler to perform specific known command call via UART to machine
@@ -486,24 +993,155 @@ void JuraBridge::instructServicePortToDisplayString(String command) {servicePort
  *     
  * @param[in] command JuraServicePortCommand enum command
  ******************************************************************************/
-void JuraBridge::instructServicePortWithCommand(JuraServicePortCommand command) {servicePort.transferEncodeCommand(command);}
+void JuraBridge::instructServicePortWithCommand(JuraServicePortCommand command) {servicePort.transferEncodeCommand(command, JuraUartLane::User);}
 
 /***************************************************************************//**
  * Special handler to perform specific known function via UART to machine
  *
- * @param[out] null 
+ * @param[out] bool machine acknowledged the command 
  *     
  * @param[in] command JuraFunctionIdentifier
+ * @param[in] lane JuraUartLane; safety for cancels
  ******************************************************************************/
-void JuraBridge::instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier identifier) {
+bool JuraBridge::instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier identifier, JuraUartLane lane) {
   int functionEntityArraySize = sizeof(JuraMachineFunctionEntityConfigurations) / sizeof(JuraMachineFunctionEntityConfigurations[0]) ; 
   for (int i = 0; i < functionEntityArraySize; i++){
     if (identifier == JuraMachineFunctionEntityConfigurations[i].function){
       ESP_LOGI(TAG, "-> Select Function: %s",JuraMachineFunctionEntityConfigurations[i].name );
-      servicePort.transferEncodeCommand(JuraMachineFunctionEntityConfigurations[i].command);
-      break;
+      servicePort.transferEncodeCommand(JuraMachineFunctionEntityConfigurations[i].command, lane);
+      return servicePort.isConnected;
     }
   }
+  return false;
+}
+
+/***************************************************************************//**
+ * Publish every enabled entity's last reported state again, string or number,
+ * for a Home Assistant that has just started; nothing is read from the machine.
+ * The mqtt semaphore is taken per state, so other publishing goes on between.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/
+void JuraBridge::republishMachineStates(){
+  int stateAttributeArraySize = sizeof(JuraEntityConfigurations) / sizeof(JuraEntityConfigurations[0]) ; 
+  for (int i = 0; i < stateAttributeArraySize; i++){
+    if (!republishMachineState(i)){continue;}
+    vTaskDelay(pdMS_TO_TICKS(JURA_REDISCOVERY_METER_MS));
+  }
+}
+
+/* last reported state of one entity; false if none, disabled, or not delivered */
+bool JuraBridge::republishMachineState(int i){
+  if (JuraEntityConfigurations[i].enabled != JuraEntityEnabled::Yes){return false;}
+  if (_reportableNumericStates[i] == DEFAULT_NUMERIC_STATE && _reportableStringStates[i] == NULL){return false;}
+
+  char message_topic[56]; 
+  sprintf(
+    message_topic, 
+    MQTT_ROOT "/%i/%i/%i", 
+    JuraEntityConfigurations[i].machineSubsystemType, 
+    JuraEntityConfigurations[i].subsystemAttributeType,
+    i
+  );
+
+  char mqttFloatToString[8]; 
+  const char * payload = _reportableStringStates[i];
+  if (payload == NULL){
+    dtostrf(_reportableNumericStates[i], 1, 0, mqttFloatToString);
+    payload = mqttFloatToString;
+  }
+
+  xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
+  bool delivered = mqttClient.publish(message_topic, payload);
+  xSemaphoreGive(xMQTTSemaphore);
+  return delivered;
+}
+
+/***************************************************************************//**
+ * Keep a state the broker did not take: its entity joins the dirty set (the
+ * value itself is the last reported one), and a meter value is also logged,
+ * so every drink made during an outage is delivered, not just the last count.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] int entity configuration index
+ * @param[in] int value
+ ******************************************************************************/
+void JuraBridge::deferState(int index, int value){
+  uint32_t bit = 1UL << (index % 32);
+  portENTER_CRITICAL(&_backlog_lock);
+  if (_backlog_dirty[index / 32] & bit){_backlog_coalesced++;}
+  _backlog_dirty[index / 32] |= bit;
+
+  if (JuraEntityConfigurations[index].subsystemAttributeType == JuraMachineSubsystemAttributeType::MeterValue){
+    if (_backlog_count == JURA_BACKLOG_EVENTS){
+      _backlog_dropped++;
+    } else {
+      _backlog_count++;
+    }
+    _backlog_events[_backlog_head] = {(uint8_t) index, value, millis()};
+    _backlog_head = (_backlog_head + 1) % JURA_BACKLOG_EVENTS;
+  }
+  portEXIT_CRITICAL(&_backlog_lock);
+}
+
+/***************************************************************************//**
+ * On reconnect: publish the latest state of every dirty entity in one burst,
+ * then the logged meter values, oldest first, with what was coalesced or
+ * dropped. A state that fails again stays dirty for the next reconnect.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/
+void JuraBridge::replayBacklog(){
+  uint32_t dirty[(JURA_ENTITY_CONFIGURATION_SIZE + 31) / 32];
+  JuraBacklogEvent events[JURA_BACKLOG_EVENTS];
+
+  portENTER_CRITICAL(&_backlog_lock);
+  memcpy(dirty, _backlog_dirty, sizeof(dirty));
+  memset(_backlog_dirty, 0, sizeof(_backlog_dirty));
+  int count = _backlog_count;
+  for (int i = 0; i < count; i++){
+    events[i] = _backlog_events[(_backlog_head + JURA_BACKLOG_EVENTS - count + i) % JURA_BACKLOG_EVENTS];
+  }
+  _backlog_count = 0;
+  uint32_t coalesced = _backlog_coalesced;
+  uint32_t dropped = _backlog_dropped;
+  _backlog_coalesced = 0;
+  _backlog_dropped = 0;
+  portEXIT_CRITICAL(&_backlog_lock);
+
+  int replayed = 0;
+  for (int i = 0; i < JURA_ENTITY_CONFIGURATION_SIZE; i++){
+    if (!(dirty[i / 32] & (1UL << (i % 32)))){continue;}
+    if (republishMachineState(i)){
+      replayed++;
+    } else {
+      portENTER_CRITICAL(&_backlog_lock);
+      _backlog_dirty[i / 32] |= 1UL << (i % 32);
+      portEXIT_CRITICAL(&_backlog_lock);
+    }
+  }
+
+  if (replayed == 0 && count == 0 && dropped == 0){return;}
+  ESP_LOGI(TAG,"--> Backlog: %d states, %d meter values, %u coalesced, %u dropped", replayed, count, coalesced, dropped);
+
+  DynamicJsonDocument mqttJsonBacklogBody(JURA_MQTT_PAYLOAD_SIZE);
+  mqttJsonBacklogBody["replayed"] =   replayed;
+  mqttJsonBacklogBody["coalesced"] =  coalesced;
+  mqttJsonBacklogBody["dropped"] =    dropped;
+  JsonArray logged = mqttJsonBacklogBody.createNestedArray("events");
+  unsigned long now = millis();
+  for (int i = 0; i < count; i++){
+    JsonObject event = logged.createNestedObject();
+    event["entity"] =   JuraEntityConfigurations[events[i].entity].entity_id;
+    event["value"] =    events[i].value;
+    event["age_s"] =    (now - events[i].at) / 1000;
+  }
+  publishJson(MQTT_ROOT MQTT_BACKLOG, mqttJsonBacklogBody, false);
 }
 
 /***************************************************************************//**
@@ -533,6 +1171,7 @@ bool JuraBridge::machineStateStringChanged(JuraMachineStateIdentifier machineSta
 
       /* report integer represtntation of the staet; report the string*/
       _reportableNumericStates[entityConfigurationIndex] = _intState; 
+      _reportableStringStates[entityConfigurationIndex] = _newStringState;
 
       /* record state for bulk reporting */
       char message_topic[56]; 
@@ -544,10 +1183,11 @@ bool JuraBridge::machineStateStringChanged(JuraMachineStateIdentifier machineSta
         entityConfigurationIndex
       );
 
-      /* report out */
+      /* report out; kept for replay if the broker is down */
       xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
-      mqttClient.publish(message_topic, _newStringState);
+      bool delivered = mqttClient.publish(message_topic, _newStringState);
       xSemaphoreGive(xMQTTSemaphore);
+      if (!delivered){deferState(entityConfigurationIndex, _intState);}
 
       /* mark as bridge processing completed only if this is not the first default value */
       if (_intState != DEFAULT_NUMERIC_STATE){
@@ -601,13 +1241,15 @@ bool JuraBridge::machineStateStringChanged(JuraMachineStateIdentifier machineSta
         entityConfigurationIndex
       );
 
-      /* report the string version */
+      /* report the string version; kept for replay if the broker is down */
       xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
-      mqttClient.publish(message_topic, mqttFloatToString);
+      bool delivered = mqttClient.publish(message_topic, mqttFloatToString);
       xSemaphoreGive(xMQTTSemaphore);
+      if (!delivered){deferState(entityConfigurationIndex, _newState);}
 
       /* record the report*/
       _reportableNumericStates[entityConfigurationIndex] = _newState;
+      _reportableStringStates[entityConfigurationIndex] = NULL;
 
        /* save pref only if device is enabeld? */
       if (JuraEntityConfigurations[entityConfigurationIndex].nonvolatile == JuraEntityNonvolatile::Yes){
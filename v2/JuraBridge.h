@@ -1,19 +1,34 @@
 #ifndef JURABRIDGE_H
 #define JURABRIDGE_H
 #include "JuraMachine.h"
+#include "JuraDisplay.h"
 #include <ArduinoJson.h>
 #include <string>
 
 /* forward declarations */
 class Preferences; 
 class PubSubClient; 
+struct JuraOrderQueueStatus;
+class JuraRecipeProgramStore;
+struct JuraPreheatStatus;
+struct JuraJitterReport;
+struct JuraUartCalibrationStatus;
+struct JuraNetworkStatus;
+class JuraMemoryMonitor;
 
 #define JURA_ENTITY_CONFIGURATION_SIZE 200
 
+/* a meter value the broker did not take */
+struct JuraBacklogEvent {
+  uint8_t entity;           /* entity configuration index */
+  int value;
+  unsigned long at;
+};
+
 class JuraBridge {
   public: 
     /* reminder: need to keep preferences init'd in main *.ino; pass reference here */
-    JuraBridge(Preferences &, PubSubClient &, SemaphoreHandle_t &,  SemaphoreHandle_t &);
+    JuraBridge(Preferences &, PubSubClient &, SemaphoreHandle_t &);
     
     /* messages from/to machine */
     bool machineStateChanged(JuraMachineStateIdentifier, int);
@@ -22,32 +37,73 @@ class JuraBridge {
     /* homeassistant mqtt configuration */
     void publishMachineEntityConfigurations();
     void publishMachineFunctionConfiguration();
+    void republishMachineStates();
+
+    /* states held back while the broker was down; on reconnect */
+    void replayBacklog();
     void publishRinseRequest();
+    void publishShotProfile(const JuraShotProfile &);
+    void publishOrderQueueStatus(const JuraOrderQueueStatus &);
+    void publishRecipeProgramList(JuraRecipeProgramStore &);
+    void publishPreheatStatus(const JuraPreheatStatus &);
+    void publishDrinkLatency(JuraLatencyRecorder &);
+    void publishPollJitter(const JuraJitterReport &);
+    void publishMachineConnection(const JuraConnectionStatus &);
+    void publishUartCalibration(const JuraUartCalibrationStatus &);
+    void publishNetwork(const JuraNetworkStatus &);
+    void publishUartLanes(const JuraUartLaneStats *);
+    void publishMemory(JuraMemoryMonitor &);
+    void publishEepromScan(JuraEepromScanner &);
+    void publishWorkingMemory(JuraWorkingMemoryScanner &);
+
+    /* serialize into the shared payload buffer and publish, both under the mqtt semaphore */
+    bool publishJson(const char *, const JsonDocument &, bool);
 
     void subscribeToMachineFunctionButtonCommandTopics();
     void subscribeToBridgeSubtopics();
 
     /* callback for mqtt subscriptions */
-    void instructServicePortToSetReady();
-    void instructServicePortToDisplayString(String);
+    void instructServicePortToSetReady(JuraDisplayPriority = JuraDisplayPriority::Operation);
+    void instructServicePortToDisplayString(String, JuraDisplayPriority = JuraDisplayPriority::Operation);
     void instructServicePortWithCommand(JuraServicePortCommand);
-    void instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier); 
+    bool instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier, JuraUartLane = JuraUartLane::User); 
+
+    /* function entity lookup by entity id, without ENTITY_PREFIX */
+    static const char * functionKey(JuraFunctionIdentifier);
+    static JuraFunctionIdentifier functionForKey(const char *);
 
     /* define service port */
     JuraServicePort servicePort;
+
+    /* DT: text; written only when it changes */
+    JuraDisplayWriter display;
     const char * getJuraPreferenceKey(JuraMachineStateIdentifier);
     SemaphoreHandle_t &xMQTTSemaphore;
 
   private: 
     Preferences &preferences;
     PubSubClient &mqttClient;
-    SemaphoreHandle_t &xUARTSemaphore;
+
+    /* json payloads; one at a time under xMQTTSemaphore, so no task carries one on its stack */
+    char _payload[JURA_MQTT_PAYLOAD_SIZE];
 
     /* string handling */
     char* substr(char*, int, int );
   
     /* machine states; not set precisely */
     int _reportableNumericStates[JURA_ENTITY_CONFIGURATION_SIZE]; 
+    const char * _reportableStringStates[JURA_ENTITY_CONFIGURATION_SIZE];   /* last string reported; callers pass literals */
+    bool republishMachineState(int);
+
+    /* offline backlog: entities whose last state was not delivered, and meter values in order */
+    uint32_t _backlog_dirty[(JURA_ENTITY_CONFIGURATION_SIZE + 31) / 32];
+    JuraBacklogEvent _backlog_events[JURA_BACKLOG_EVENTS];
+    int _backlog_head = 0;
+    int _backlog_count = 0;
+    uint32_t _backlog_coalesced = 0;
+    uint32_t _backlog_dropped = 0;
+    portMUX_TYPE _backlog_lock = portMUX_INITIALIZER_UNLOCKED;
+    void deferState(int, int);
     int _stateIndexToConfigurationIndex[JURA_ENTITY_CONFIGURATION_SIZE]; 
 
 };
@@ -11,6 +11,14 @@
 #include "JuraMachine.h"
 #include "JuraBridge.h"
 #include "JuraCustomMenu.h"
+#include "JuraRecipe.h"
+#include "JuraOrderQueue.h"
+#include "JuraRecipeProgram.h"
+#include "JuraPreheat.h"
+#include "JuraJitterProbe.h"
+#include "JuraMemoryMonitor.h"
+#include "JuraUartCalibration.h"
+#include "JuraNetwork.h"
 
 /* macros */
 #define xSemaphoreWrappedSetBoolean(x,y,z)  xSemaphoreTake(x, portMAX_DELAY ); y = z; xSemaphoreGive(x);
@@ -19,32 +27,65 @@
 /* nvs preferences handler */
 Preferences prefs;
 
-/* need to stop long-run tasks when MQTT signaling is required */
-SemaphoreHandle_t xUARTSemaphore; 
-
 /* need to ensure that different tasks do not call the mqtt client at the same time; */
 SemaphoreHandle_t xMQTTSemaphore; 
 SemaphoreHandle_t xMQTTStatusSemaphore; 
 SemaphoreHandle_t xWIFIStatusSemaphore; 
 SemaphoreHandle_t xMachineReadyStateVariableSemaphore; 
 
+/* given when home assistant comes online; taken by the rediscovery task */
+SemaphoreHandle_t xRediscoverySemaphore;
+
+/* machine readiness and dispense milestones; waited on instead of polling states */
+EventGroupHandle_t xMachineEvents;
+
 /* define comms */
 WiFiClient wifiClient;
 PubSubClient mqttClient(wifiClient);
 
+/* wi-fi and broker links; event driven, never reboots */
+JuraNetworkManager network(mqttClient, prefs);
+
 /* define machine instance */
-JuraBridge bridge(prefs, mqttClient, xMQTTSemaphore, xUARTSemaphore);
-JuraMachine machine(bridge, xMachineReadyStateVariableSemaphore);
+JuraBridge bridge(prefs, mqttClient, xMQTTSemaphore);
+JuraMachine machine(bridge, xMachineReadyStateVariableSemaphore, xMachineEvents);
+
+/* sequenced products (add shot) */
+JuraRecipeEngine recipes(machine, bridge);
+
+/* user recipes, compiled to bytecode and kept in nvs */
+JuraRecipeProgramStore programs(prefs, bridge, recipes);
+
+/* drink orders, served back-to-back */
+JuraOrderQueue orders(machine, bridge, recipes, programs);
+
+/* learns first drink times; preheats through the order queue */
+JuraPreheatPlanner preheat(machine, bridge, orders, prefs);
+
+/* hardware menu items defined over mqtt; packed like the compiled items */
+JuraCustomMenuItem userMenuItems[JURA_USER_MENU_ITEMS_MAX];
+int userMenuItemCount = 0;
+portMUX_TYPE userMenuLock = portMUX_INITIALIZER_UNLOCKED;
+
+/* shortest character gap the machine accepts */
+JuraUartCalibrator uartCalibration(machine, bridge, prefs);
+
+/* poll loop timing */
+JuraJitterProbe pollJitter;
+
+/* stack and heap watermarks */
+JuraMemoryMonitor memory;
 
 /* task handles */
-TaskHandle_t xUART, xLED;
+TaskHandle_t xUART, xLED, xMenu;
 
 /* queue */
 QueueHandle_t xQ_SubscriptionMessage; // payload and topic queue of MQTT payload and topic
-const int payloadSize = 512;
+const int payloadSize = 1024;   /* fits a full recipe upload */
 struct mqtt_message {
   char payload [payloadSize] = {'\0'};
   String topic ;
+  unsigned long receivedAt = 0;   /* millis() in the callback; latency of product topics */
 } rx_message;
 
 /* protected state variables */
@@ -90,6 +131,7 @@ void machineStatePollingHandler (void * pvParameters){
 
 
   int loopIterator = 1; 
+  bool pollable = true;
   for(;;){ 
     /*
 
@@ -115,63 +157,370 @@ void machineStatePollingHandler (void * pvParameters){
       F0-FF :   FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF FFFF
     */
 
-    if (!customMenu.active){
+    /* machine off or unplugged; probe with backoff instead of polling every source into its timeout */
+    bool wasPollable = pollable;
+    pollable = bridge.servicePort.connection.isPollable();
+    if (!pollable && wasPollable){machine.markDisconnected();}
+
+    if (customMenu.active){
+      pollJitter.pause();
+      vTaskDelayMilliseconds(500);
+    }else if (!pollable){
+      pollJitter.pause();
+      bridge.servicePort.probeIfDue();
+      vTaskDelayMilliseconds(JURA_CONNECTION_OFFLINE_TICK_MS);
+    }else{
       machine.handlePoll(loopIterator);
+      uartCalibration.service();
+      bridge.display.service();
       loopIterator = (loopIterator % 100) + 1; 
-      vTaskDelayMilliseconds(10);
-    }else{
-      vTaskDelayMilliseconds(500);
+      pollJitter.beforeDelay(JURA_POLL_INTERVAL_MS);
+      vTaskDelayMilliseconds(JURA_POLL_INTERVAL_MS);
+      pollJitter.afterDelay();
     }
   }
 }
 
 
 /***************************************************************************//**
- * Await the machine ready state then add a shot 
+ * Await the machine ready state then add a shot. Called from the message
+ * worker, which must not wait behind an order; skipped while one is served.
  *
- * @param[out] null 
+ * @param[out] bool false if an order holds the recipe engine or a step timed out
  *     
  * @param[in] addShot int number of shots
  * @param[in] brewLimt int limit for brew out
  ******************************************************************************/
-void awaitDispenseCompletionToAddShots( int addShot = 1, int brewLimit = 17 ){
+bool awaitDispenseCompletionToAddShots( int addShot = 1, int brewLimit = 17 ){
+  if (!recipes.tryAcquire()){
+    ESP_LOGI(TAG,"--> Add shot skipped: an order is being served");
+    return false;
+  }
 
   /* precharge the wait display for between elements */
   bridge.instructServicePortToDisplayString("   WAIT   ");
 
-  /* iterating over two shots */
-  for( int shot = 0; shot < addShot; shot ++){
+  /* each shot: hold out of ready, wait for the machine to allow it, brew, wait for it to start */
+  JuraRecipeStep steps[JURA_RECIPE_MAX_STEPS];
+  int count = 0;
+  for( int shot = 0; shot < addShot && count + 5 <= JURA_RECIPE_MAX_STEPS; shot ++){
+    steps[count++] = {JuraRecipeStepType::MarkAddShot, 0};
+    steps[count++] = {JuraRecipeStepType::AwaitReady, 0};
+    steps[count++] = {JuraRecipeStepType::BrewLimit, brewLimit};
+    steps[count++] = {JuraRecipeStepType::Function, (int) JuraFunctionIdentifier::MakeEspresso};
+    steps[count++] = {JuraRecipeStepType::AwaitDispenseStart, 0};
+  }
 
-    /* define a non-ready state that is not processed in the machine poller; protect  */
-    machine.startAddShotPreparation();
-    /* 
-      NOTE TO READER: intentionally leave the semaphore taken here to prevent a ready state from happen
-      until we get into the while loop below; 
-    */
+  bool completed = recipes.run(steps, count);
+  recipes.release();
+  return completed;
+}
 
-    /* entire the loop before returning the semaphore */
-    xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
-    
-    bool canGiveSemaphore = true;
-    while (machine.states[(int) JuraMachineStateIdentifier::SystemIsReady] == false){
-      vTaskDelayMilliseconds(500);
-      if (canGiveSemaphore){
-        xSemaphoreGive( xMachineReadyStateVariableSemaphore);
-        canGiveSemaphore = false;
-      }
+/***************************************************************************//**
+ * Compile one drink from json into a packed recipe. Without a function key the
+ * recipe applies to the product selected on the machine; an unknown function
+ * is rejected. Limits are clamped to the packed field sizes.
+ *
+ * @param[out] bool false if the function is unknown
+ *     
+ * @param[in] JsonObject drink
+ * @param[out] JuraPackedRecipe &recipe
+ ******************************************************************************/
+bool recipeFromJson(JsonObject drink, JuraPackedRecipe &recipe){
+  JuraFunctionIdentifier function = JuraFunctionIdentifier::None;
+  if (drink.containsKey("function")){
+    function = JuraBridge::functionForKey(drink["function"] | "");
+    if (function == JuraFunctionIdentifier::None){return false;}
+  }
+
+  recipe.function = (uint8_t) function;
+  recipe.milk =   constrain((int) (drink["milk"] | 0), 0, 0xFFFF);
+  recipe.brew =   constrain((int) (drink["brew"] | 0), 0, 0xFFFF);
+  recipe.water =  constrain((int) (drink["water"] | 0), 0, 0xFFFF);
+  recipe.add =    constrain((int) (drink["add"] | 0), 0, 2);
+  return true;
+}
+
+/***************************************************************************//**
+ * Add every drink of an order message to the order queue. The message is a list
+ * of drinks, or a single drink: {"function":"make_espresso","brew":17,"add":1};
+ * function is a function entity id. Drinks that are not products, or that do
+ * not fit in the queue, are logged and dropped.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] const char * payload
+ ******************************************************************************/
+void enqueueOrdersFromMessage(const char * payload){
+  StaticJsonDocument<1024> receivedJson;
+  if (deserializeJson(receivedJson, payload)){
+    ESP_LOGI(TAG,"--> Order: not json");
+    return;
+  }
+
+  /* accept a bare object as a list of one */
+  StaticJsonDocument<1024> listJson;
+  JsonArray drinks;
+  if (receivedJson.is<JsonArray>()){
+    drinks = receivedJson.as<JsonArray>();
+  }else{
+    drinks = listJson.to<JsonArray>();
+    drinks.add(receivedJson.as<JsonObject>());
+  }
+
+  for (JsonObject drink : drinks){
+    JuraPackedRecipe recipe;
+    uint16_t id = recipeFromJson(drink, recipe) ? orders.enqueue(recipe) : 0;
+    if (id == 0){
+      ESP_LOGI(TAG,"--> Order rejected: %s", (const char *) (drink["function"] | ""));
+    }else{
+      ESP_LOGI(TAG,"--> Order %u queued: %s (%i pending)", id, (const char *) (drink["function"] | ""), orders.depth());
+    }
+  }
+}
+
+/***************************************************************************//**
+ * Number of hardware menu items: compiled items, then user items from nvs, then
+ * user recipe programs; the last compiled item (exit) is always shown last.
+ *
+ * @param[out] int count
+ ******************************************************************************/
+int customMenuItemCount(){
+  int storedPrograms = 0;
+  for (uint8_t id = 0; id < JURA_RECIPE_PROGRAMS_MAX; id++){
+    if (programs.exists(id)){storedPrograms++;}
+  }
+  return sizeof(JuraCustomMenuItemConfigurations) / sizeof(JuraCustomMenuItemConfigurations[0]) + userMenuItemCount + storedPrograms;
+}
+
+/***************************************************************************//**
+ * Recipe program slot shown at a menu position.
+ *
+ * @param[out] int8_t slot, or JURA_ORDER_NO_PROGRAM if the item is not a program
+ *     
+ * @param[in] int index
+ ******************************************************************************/
+int8_t customMenuItemProgram(int index){
+  int compiledItems = sizeof(JuraCustomMenuItemConfigurations) / sizeof(JuraCustomMenuItemConfigurations[0]) ;
+  int position = index - (compiledItems - 1) - userMenuItemCount;
+  if (position < 0){return JURA_ORDER_NO_PROGRAM;}
+
+  for (uint8_t id = 0; id < JURA_RECIPE_PROGRAMS_MAX; id++){
+    if (programs.exists(id) && position-- == 0){return id;}
+  }
+  return JURA_ORDER_NO_PROGRAM;
+}
+
+/***************************************************************************//**
+ * Hardware menu item by zero-based position, copied so a concurrent update of
+ * the user items cannot tear it. Program items carry only their name.
+ *
+ * @param[out] JuraCustomMenuItem item
+ *     
+ * @param[in] int index
+ ******************************************************************************/
+JuraCustomMenuItem customMenuItem(int index){
+  int compiledItems = sizeof(JuraCustomMenuItemConfigurations) / sizeof(JuraCustomMenuItemConfigurations[0]) ;
+  int8_t program = customMenuItemProgram(index);
+  JuraCustomMenuItem item;
+
+  JuraRecipeProgram stored;
+  if (program != JURA_ORDER_NO_PROGRAM && programs.copy(program, stored)){
+    memcpy(item.name, stored.name, JURA_CUSTOM_MENU_NAME_SIZE);
+    return item;
+  }
+
+  portENTER_CRITICAL(&userMenuLock);
+  if (index < compiledItems - 1){
+    item = JuraCustomMenuItemConfigurations[index];
+  }else if (index < compiledItems - 1 + userMenuItemCount){
+    item = userMenuItems[index - (compiledItems - 1)];
+  }else{
+    item = JuraCustomMenuItemConfigurations[compiledItems - 1];
+  }
+  portEXIT_CRITICAL(&userMenuLock);
+  return item;
+}
+
+/***************************************************************************//**
+ * Order the item at a menu position: its packed recipe, or its program.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] int index
+ ******************************************************************************/
+void orderCustomMenuItem(int index){
+  int8_t program = customMenuItemProgram(index);
+  if (program != JURA_ORDER_NO_PROGRAM){
+    orders.enqueueProgram(program);
+  }else{
+    orders.enqueue(customMenuItem(index).recipe);
+  }
+}
+
+/***************************************************************************//**
+ * Compile and store, or delete, a user recipe program, then republish the list.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] const char * payload {"id":0,"name":"LUNGO x2","steps":[...]}
+ ******************************************************************************/
+void setRecipeProgramFromMessage(const char * payload){
+  DynamicJsonDocument receivedJson(2048);
+  if (deserializeJson(receivedJson, payload)){return;}
+  JsonObject message = receivedJson.as<JsonObject>();
+
+  int id = message["id"] | -1;
+  if (id < 0 || id >= JURA_RECIPE_PROGRAMS_MAX){return;}
+
+  if (!message.containsKey("steps")){
+    programs.remove(id);
+    ESP_LOGI(TAG,"--> Recipe %i deleted", id);
+  }else{
+    JuraRecipeProgram program;
+    const char * error = JuraRecipeProgramStore::compile(message, program);
+    if (error != nullptr){
+      ESP_LOGI(TAG,"--> Recipe %i rejected: %s", id, error);
+      return;
+    }
+    programs.store(id, program);
+    ESP_LOGI(TAG,"--> Recipe %i stored: %s (%i bytes)", id, program.name, program.length);
+  }
+  bridge.publishRecipeProgramList(programs);
+}
+
+/***************************************************************************//**
+ * Load user menu items; stored as one blob of packed menu items.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/
+void loadUserMenuItemsFromNonVolatileStorage(){
+  size_t length = prefs.getBytesLength(PREF_USER_MENU_KEY);
+  if (length == 0 || length % sizeof(JuraCustomMenuItem) != 0 || length > sizeof(userMenuItems)){return;}
+
+  prefs.getBytes(PREF_USER_MENU_KEY, userMenuItems, length);
+  userMenuItemCount = length / sizeof(JuraCustomMenuItem);
+}
+
+/***************************************************************************//**
+ * Replace the working memory watch points; read during dispenses. Addresses
+ * past the last RM: word, or past JURA_WORKING_MEMORY_WATCH_MAX, are dropped.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] const char * payload hex addresses, e.g. 1F,A4; empty clears
+ ******************************************************************************/
+void setWorkingMemoryWatchesFromMessage(const char * payload){
+  machine.workingMemory.clearWatches();
+  const char * p = payload;
+  while (*p != '\0'){
+    char * end;
+    long address = strtol(p, &end, 16);
+    if (end == p){p++; continue;}
+    if (address < 0 || address >= JURA_WORKING_MEMORY_WORDS || !machine.workingMemory.watch((uint8_t) address)){
+      ESP_LOGI(TAG,"--> Watch point %lX not set", address);
+    }
+    p = end;
+  }
+}
+
+/***************************************************************************//**
+ * Set, append or clear a user menu item, then store all user items. A slot past
+ * the last item appends; a message without a function clears the slot.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] const char * payload {"slot":0,"name":"LUNGO","function":"make_coffee","water":120}
+ ******************************************************************************/
+void setUserMenuItemFromMessage(const char * payload){
+  StaticJsonDocument<512> receivedJson;
+  if (deserializeJson(receivedJson, payload)){return;}
+  JsonObject message = receivedJson.as<JsonObject>();
+
+  int slot = message["slot"] | -1;
+  if (slot < 0 || slot >= JURA_USER_MENU_ITEMS_MAX){return;}
+
+  JuraCustomMenuItem item;
+  bool clear = !message.containsKey("function");
+  if (!clear){
+    if (!recipeFromJson(message, item.recipe)){return;}
+    strncpy(item.name, message["name"] | "  RECIPE", JURA_CUSTOM_MENU_NAME_SIZE - 1);
+  }
+
+  portENTER_CRITICAL(&userMenuLock);
+  if (clear){
+    if (slot < userMenuItemCount){
+      for (int i = slot; i < userMenuItemCount - 1; i++){userMenuItems[i] = userMenuItems[i + 1];}
+      userMenuItemCount--;
+    }
+  }else if (slot < userMenuItemCount){
+    userMenuItems[slot] = item;
+  }else{
+    userMenuItems[userMenuItemCount++] = item;
+  }
+  int count = userMenuItemCount;
+  portEXIT_CRITICAL(&userMenuLock);
+
+  if (count == 0){
+    prefs.remove(PREF_USER_MENU_KEY);
+  }else{
+    prefs.putBytes(PREF_USER_MENU_KEY, userMenuItems, count * sizeof(JuraCustomMenuItem));
+  }
+}
+
+/***************************************************************************//**
+ * Serve queued orders one after another; blocks while the queue is empty.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] pvParameters required for callback
+ ******************************************************************************/
+void orderQueueWorker( void *pvParameters ){
+  JuraOrder order;
+  for (;;){
+    if (orders.take(order)){
+      orders.serve(order);
     }
+  }
+}
 
-    /* between different shots - resting period */              
-    vTaskDelayMilliseconds(2500);
+/***************************************************************************//**
+ * Republish discovery and the last reported states when Home Assistant
+ * restarts, instead of rebooting the bridge. Only mqtt; polling goes on.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] pvParameters required for callback
+ ******************************************************************************/
+void rediscoveryTask( void *pvParameters ){
+  for (;;){
+    xSemaphoreTake(xRediscoverySemaphore, portMAX_DELAY);
 
-    /* set brew limit here */
-    machine.setDispenseLimit(brewLimit, JuraMachineDispenseLimitType::Brew) ;
+    /* let home assistant subscribe before the burst; births during the wait are absorbed */
+    vTaskDelayMilliseconds(JURA_REDISCOVERY_DELAY_MS);
+    xSemaphoreTake(xRediscoverySemaphore, 0);
+    if (!connectedToBroker){continue;}
 
-    /* send the command for this repetition */
-    bridge.instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::MakeEspresso);
+    unsigned long started = millis();
+    bridge.publishMachineEntityConfigurations();
+    bridge.publishMachineFunctionConfiguration();
+    bridge.republishMachineStates();
+    ESP_LOGI(TAG,"--> Home Assistant rediscovery in %lu ms", millis() - started);
+  }
+}
 
-    /* resting period */              
-    vTaskDelayMilliseconds(2500);
+/***************************************************************************//**
+ * Follow selections on the machine for the preheat planner.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] pvParameters required for callback
+ ******************************************************************************/
+void preheatPlannerTask( void *pvParameters ){
+  for (;;){
+    preheat.watch();
   }
 }
 
@@ -192,6 +541,8 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
   {
     /* wait until the message queue includes something; */
     if ( xQueueReceive(xQ_SubscriptionMessage, &px_message, portMAX_DELAY) == pdTRUE ){
+      JURA_MEMORY_PROFILE("message");
+      unsigned long dequeuedAt = millis();
       String mqttMessageString = String(px_message.payload);
       String topic = String(px_message.topic);
       int brewLimit = 0;
@@ -199,6 +550,35 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
       int milkLimit = 0; 
       int waterLimit = 0;
 
+      /* orders carry their own limits; they are applied when each drink is served */
+      if (topic == MQTT_ROOT MQTT_ORDER) {
+        enqueueOrdersFromMessage(px_message.payload);
+        continue;
+      }
+
+      if (topic == MQTT_ROOT MQTT_MENU_ITEM) {
+        setUserMenuItemFromMessage(px_message.payload);
+        continue;
+      }
+
+      if (topic == MQTT_ROOT MQTT_RECIPE_SET) {
+        setRecipeProgramFromMessage(px_message.payload);
+        continue;
+      }
+
+      if (topic == MQTT_ROOT MQTT_RESEARCH_MEMORY_WATCH) {
+        setWorkingMemoryWatchesFromMessage(px_message.payload);
+        continue;
+      }
+
+      /* compiled already; only the id is read */
+      if (topic == MQTT_ROOT MQTT_RECIPE_RUN) {
+        if (!isdigit(px_message.payload[0]) || orders.enqueueProgram(atoi(px_message.payload)) == 0){
+          ESP_LOGI(TAG,"--> Recipe %s not run", px_message.payload);
+        }
+        continue;
+      }
+
       /* was this a json string?  */
       if (mqttMessageString.length() > 0){
 
@@ -235,14 +615,8 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
             /* if addshot is set, we need to wait for non-*/
             if (addShot > 0){
 
-              /* entire the loop before returning the semaphore */
-              bool canGiveSemaphore = true;
-              while (machine.states[(int) JuraMachineStateIdentifier::SystemIsReady] == true){
-                vTaskDelayMilliseconds(500);
-                if (canGiveSemaphore){
-                  canGiveSemaphore = false;
-                }
-              }
+              /* wait for the product to be selected on the machine */
+              machine.awaitMachineEvents(MACHINE_EVENT_NOT_READY, true, MACHINE_EVENT_WAIT_FOREVER);
 
               /* define a non-ready state that is not processed in the machine poller; protect  */
               machine.startAddShotPreparation();
@@ -269,8 +643,16 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
         if (topic == JuraMachineFunctionEntityConfigurations[i].command_topic && 
             JuraMachineFunctionEntityConfigurations[i].command != JuraServicePortCommand::None){
 
+          /* a press must not land inside an order being served */
+          if (!recipes.tryAcquire()){
+            ESP_LOGI(TAG,"--> %s skipped: an order is being served", JuraMachineFunctionEntityConfigurations[i].name);
+            break;
+          }
+
           /* instruct the custom command */          
+          machine.latency.received(JuraMachineFunctionEntityConfigurations[i].function, px_message.receivedAt, dequeuedAt);
           bridge.instructServicePortWithCommand(JuraMachineFunctionEntityConfigurations[i].command);
+          machine.latency.commandSent(JuraMachineFunctionEntityConfigurations[i].function, millis());
 
           /* dealy */
           vTaskDelay(500 / portTICK_PERIOD_MS);
@@ -285,6 +667,7 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
 
           /* set ready */
           bridge.instructServicePortToSetReady();
+          recipes.release();
           break;
         }
       }
@@ -292,13 +675,11 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
       /* --- machine topics and bridge topics  ---  */
       if (topic ==  MQTT_ROOT MQTT_SUBTOPIC_MENU) {
 
-        /* enter settings menu */
-        bridge.instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::SettingsMenu);
-        vTaskDelayMilliseconds(300);
-
-        /* select first menu item */
-        bridge.instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::SelectMenuItem);
-        vTaskDelayMilliseconds(300);
+        /* enter settings menu, select first menu item; each press is confirmed before the next */
+        JuraRecipeStep steps[JURA_RECIPE_MAX_STEPS];
+        int count = 0;
+        steps[count++] = {JuraRecipeStepType::MenuEnter, (int) JuraFunctionIdentifier::SettingsMenu};
+        steps[count++] = {JuraRecipeStepType::MenuFunction, (int) JuraFunctionIdentifier::SelectMenuItem};
 
         //how far into the menu do we go?
         int menu_item = 99;
@@ -313,18 +694,29 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
         if (menu_item < 5){
           //navigate to message 
           for (int i = 0; i < menu_item; i++){
-            bridge.instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::RotaryRight);
-            vTaskDelayMilliseconds(300);
+            steps[count++] = {JuraRecipeStepType::MenuFunction, (int) JuraFunctionIdentifier::RotaryRight};
           }
 
           //press the selected button and be done with it
-          bridge.instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::SelectMenuItem);
-          vTaskDelayMilliseconds(300);
+          steps[count++] = {JuraRecipeStepType::MenuFunction, (int) JuraFunctionIdentifier::SelectMenuItem};
+        }
+
+        /* the message worker never waits behind an order */
+        if (!recipes.tryAcquire()){
+          ESP_LOGI(TAG,"--> Menu navigation skipped while an order is served: %s", mqttMessageString.c_str());
+        }else{
+          if (!recipes.run(steps, count)){
+            ESP_LOGI(TAG,"--> Menu navigation stopped: %s", mqttMessageString.c_str());
+          }
+          recipes.release();
         }
 
       } else if (topic == MQTT_ROOT MQTT_BRIDGE_RESTART) {
         ESP.restart();
 
+      } else if (topic == MQTT_ROOT MQTT_UART_CALIBRATE) {
+        uartCalibration.request();
+
       } else if (topic == MQTT_ROOT MQTT_CONFIG_SEND) {
         bridge.instructServicePortToDisplayString("   WAIT");
         bridge.publishMachineEntityConfigurations();
@@ -334,26 +726,15 @@ void receivedMQTTMessageQueueWorker( void *pvParameters ){
         bridge.instructServicePortToSetReady();
 
       } else if (topic == HA_STATUS_MQTT) {
+        /* home assistant restarted; rediscover in the background, repeated births coalesce */
         if (mqttMessageString == "online"){
-          ESP.restart();
+          xSemaphoreGive(xRediscoverySemaphore);
         }
       }
     }
   }
 }
 
-/***************************************************************************//**
- * RAM held dumping and debug spot for Wifi events. Insert switch 
- * for debugging.
- * 
- * notes: design pattern based on @idahowalker on arduino.cc forums
- *
- * @param[out] null 
- *     
- * @param[in] WiFiEvent_t wifi event for preocessing
- ******************************************************************************/
-void IRAM_ATTR WiFiEvent(WiFiEvent_t event){}
-
 /***************************************************************************//**
  * RAM held mqtt rx event processor; dump received messages into 
  * single-item queue for processing at a later time. Structure message
@@ -368,6 +749,13 @@ void IRAM_ATTR WiFiEvent(WiFiEvent_t event){}
  * @param[in] length unsigned int length of the payload
  ******************************************************************************/
 void IRAM_ATTR mqttCallback(char* topic, byte * payload, unsigned int length){
+  /* a truncated payload would parse as a different message; drop it */
+  if (length > payloadSize - 1){
+    ESP_LOGE(TAG,"--> Message on %s dropped: %u bytes exceeds %i", topic, length, payloadSize - 1);
+    return;
+  }
+
+  rx_message.receivedAt = millis();
   memset( rx_message.payload, '\0', payloadSize ); // clear payload char buffer
   rx_message.topic = ""; //clear topic string buffer
   rx_message.topic = topic; //store new topic
@@ -380,29 +768,6 @@ void IRAM_ATTR mqttCallback(char* topic, byte * payload, unsigned int length){
   xQueueOverwrite( xQ_SubscriptionMessage, (void *) &rx_message );// send data to queue
 } 
 
-/***************************************************************************//**
- * Second function for processing menu items with MQTT handler, but without 
- * requireing a bounce-0ff of the broker ( wifi disconnect is a problem... )
- *
- * @param[out] null 
- *     
- * @param[in] topic const char array pointer to topic of the rx message
- * @param[in] payload const char array pointer to payload of the rx message 
- * @param[in] length unsigned int length of the payload
- ******************************************************************************/
-void IRAM_ATTR mqttCallbackBypassBroker(const char* topic, const char* payload, unsigned int length){
-  memset( rx_message.payload, '\0', payloadSize ); 
-  rx_message.topic = ""; 
-  rx_message.topic = topic; 
-  int i = 0; 
-  for ( i; i < length; i++)
-  {
-    rx_message.payload[i] = (char)payload[i];
-  }
-  rx_message.payload[i] = '\0';
-  xQueueOverwrite( xQ_SubscriptionMessage, (void *) &rx_message );// send data to queue
-} 
-
 /***************************************************************************//**
  * Publish device configuration to Home Assistant via configured broker. 
  *
@@ -413,13 +778,22 @@ void IRAM_ATTR mqttCallbackBypassBroker(const char* topic, const char* payload,
 void refreshConfigurationWithBroker(){
   /* if the version number has changed, update the MQTT reports */
   if (prefs.getInt("version", 0) != VERSION_INT){
-    bridge.instructServicePortToDisplayString(" UPDATING");
+    bridge.instructServicePortToDisplayString(" UPDATING", JuraDisplayPriority::Status);
     bridge.publishMachineEntityConfigurations();
     bridge.publishMachineFunctionConfiguration(); 
 
     /* version stored*/
     prefs.putInt("version", VERSION_INT);
   }
+
+  /* user recipes */
+  bridge.publishRecipeProgramList(programs);
+
+  /* learned first drink pattern */
+  preheat.publishStatus();
+
+  /* character gap */
+  uartCalibration.publishStatus();
 }
 
 /***************************************************************************//**
@@ -435,17 +809,18 @@ void refreshSubscriptionsWithBroker(){
 }
 
 /***************************************************************************//**
- * Connect to the mqtt broker. Called from the connection manager
- * loop. Once connected to mqtt, perform initial mqtt 
+ * Connect to the mqtt broker, if an attempt is due. Called from the 
+ * connection manager loop. 
  *
- * @param[out] none 
+ * @param[out] bool broker connected
  *     
  * @param[in] none 
  ******************************************************************************/
-void connectToBroker(){
+bool connectToBroker(){
+  if (!network.brokerAttemptDue()){return false;}
 
   /* semaphore-protected */
-  bridge.instructServicePortToDisplayString("   MQTT   ");
+  bridge.instructServicePortToDisplayString("   MQTT   ", JuraDisplayPriority::Status);
 
   /* operaitonal state topic */
   char operational_state_topic[56]; 
@@ -461,51 +836,40 @@ void connectToBroker(){
   mqttClient.setKeepAlive( 90 );
   mqttClient.setServer(MQTTBROKER, 1883);
   mqttClient.setBufferSize(2048);       /* for receiving large recipes; discontinyed; not necessary? */
+  mqttClient.setSocketTimeout(JURA_NETWORK_BROKER_TIMEOUT_S);
 
-  while (! mqttClient.connected()){
-    mqttClient.connect(TAG, MQTT_USER, MQTT_PASS, operational_state_topic, 0, false, "OFF" , true);
-    vTaskDelayMilliseconds(2500);
-  }
+  if (!network.connectBroker(TAG, MQTT_USER, MQTT_PASS, operational_state_topic)){return false;}
 
   mqttClient.setCallback( mqttCallback );
 
   /* subscriptions and mqtt first stuffs refreshing goes here */
   xSemaphoreWrappedSetBoolean(xMQTTStatusSemaphore, connectedToBroker, true);   
+  return true;
 } 
 
 /***************************************************************************//**
- * Connect to configured Wi-Fi network.
+ * Connect to configured Wi-Fi network, if an attempt is due.
  *
- * @param[out] none 
+ * @param[out] bool wi-fi connected
  *     
  * @param[in] none 
  ******************************************************************************/
-void connectToWiFiNetwork(){
+bool connectToWiFiNetwork(){
+  if (!network.wifiAttemptDue()){return false;}
 
   /* booting message on display */
-  bridge.instructServicePortToDisplayString("   WIFI   ");
-
-  /* configuration values*/
-  WiFi.mode(WIFI_STA); 
-  WiFi.persistent(true);
-
-  int wifiConnectionAttempt = 0;
-  while (WiFi.status() != WL_CONNECTED){
-    wifiConnectionAttempt++;
-    WiFi.disconnect();
-    WiFi.begin( WIFINAME, WIFIPASS );
-    vTaskDelayMilliseconds(5000);
-    if ( wifiConnectionAttempt == 10 )
-    {
-      ESP.restart();
-    }
-  }
-  WiFi.onEvent( WiFiEvent );
+  bridge.instructServicePortToDisplayString("   WIFI   ", JuraDisplayPriority::Status);
+
+  if (!network.connectWiFi()){return false;}
   
   /* print IP address for debugging - send to frontend?*/
   IPAddress localIP = WiFi.localIP();
   ESP_LOGI(TAG,"Wi-Fi: %i.%i.%i.%i",localIP[0], localIP[1],localIP[2],localIP[3]);
+
+  /* local time of day for the preheat planner */
+  configTzTime(JURA_PREHEAT_TIMEZONE, JURA_PREHEAT_NTP_SERVER);
   xSemaphoreWrappedSetBoolean(xWIFIStatusSemaphore, connectedToNetwork, true);   
+  return true;
 } 
 
 /***************************************************************************//**
@@ -516,30 +880,71 @@ void connectToWiFiNetwork(){
  * @param[in] pvParameters required for callback
  ******************************************************************************/
 void communicationsKeepAliveTask( void *pvParameters ){
+  unsigned long memorySampledAt = 0;
+  unsigned long lanesReportedAt = 0;
   mqttClient.setKeepAlive(90);
   for (;;){
     if ( (wifiClient.connected()) && (WiFi.status() == WL_CONNECTED) && (mqttClient.connected()) ){
       xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
       mqttClient.loop();
       xSemaphoreGive( xMQTTSemaphore );
+
+      /* published from here so the poll loop is not held up by the broker */
+      JuraJitterReport jitter;
+      if (pollJitter.report(jitter)){
+        bridge.publishPollJitter(jitter);
+      }
+
+      /* machine link; on each change between online, degraded and offline */
+      if (bridge.servicePort.connection.takeChange()){
+        bridge.publishMachineConnection(bridge.servicePort.connection.status(millis()));
+      }
+
+      /* stack and heap watermarks */
+      if (millis() - memorySampledAt >= JURA_MEMORY_SAMPLE_MS){
+        memorySampledAt = millis();
+        memory.sample();
+        bridge.publishMemory(memory);
+      }
+
+      /* service port waits per lane */
+      if (millis() - lanesReportedAt >= JURA_UART_LANE_REPORT_MS){
+        lanesReportedAt = millis();
+        JuraUartLaneStats lanes[JURA_UART_LANES];
+        bridge.servicePort.arbiter.report(lanes);
+        bridge.publishUartLanes(lanes);
+      }
     
     }else {
       /* mqtt cannot be available if wifi is not available */
       xSemaphoreWrappedSetBoolean(xMQTTStatusSemaphore, connectedToBroker, false);   
-      xSemaphoreWrappedSetBoolean(xWIFIStatusSemaphore, connectedToNetwork, false);   
-
-      if ( !(wifiClient.connected()) || !(WiFi.status() == WL_CONNECTED)){
-        connectToWiFiNetwork();
+      network.markDown();
+
+      /* one attempt per link when due; woken early by wi-fi events */
+      if (WiFi.status() != WL_CONNECTED){
+        xSemaphoreWrappedSetBoolean(xWIFIStatusSemaphore, connectedToNetwork, false);   
+        if (!connectToWiFiNetwork()){
+          network.await(JURA_NETWORK_LOOP_MS);
+          continue;
+        }
       }
 
-      connectToBroker();
+      if (!connectToBroker()){
+        network.await(JURA_NETWORK_LOOP_MS);
+        continue;
+      }
+      network.markUp();
       refreshSubscriptionsWithBroker();
       refreshConfigurationWithBroker();
+      bridge.replayBacklog();
+      bridge.publishNetwork(network.status());
 
       /* set ready */
-      bridge.instructServicePortToSetReady();
+      bridge.instructServicePortToSetReady(JuraDisplayPriority::Status);
     }
-    vTaskDelayMilliseconds( 250);
+
+    /* returns at once if wi-fi drops */
+    network.await(JURA_NETWORK_LOOP_MS);
   }
 
   /* null = calling task is deleted; should never exit this loop anyway...*/
@@ -547,7 +952,8 @@ void communicationsKeepAliveTask( void *pvParameters ){
 }
 
 /***************************************************************************//**
- * Init states based on stored memory. 
+ * Init states based on stored memory. Loaded, not committed: only changes the
+ * poll sees are stamped and attributed to operations.
  *
  * @param[out] none 
  *     
@@ -570,7 +976,7 @@ void initJuraEntityStatesFromNonVolatileStorage() {
       char prefKey[8]; dtostrf((int) JuraEntityConfigurations[entityConfigurationIndex].state, 4, 0, prefKey);
 
       /* set from preference */
-      machine.states[(int) JuraEntityConfigurations[entityConfigurationIndex].state] = prefs.getInt(prefKey, 0);
+      machine.states.load(JuraEntityConfigurations[entityConfigurationIndex].state, prefs.getInt(prefKey, 0));
       
       /* notify bridge of change */
       bridge.machineStateChanged(JuraEntityConfigurations[entityConfigurationIndex].state, machine.states[ (int) JuraEntityConfigurations[entityConfigurationIndex].state]);
@@ -579,7 +985,7 @@ void initJuraEntityStatesFromNonVolatileStorage() {
     } else if ( (JuraEntityConfigurations[entityConfigurationIndex].dataType == JuraMachineStateDataType::Integer) ||
                 (JuraEntityConfigurations[entityConfigurationIndex].dataType == JuraMachineStateDataType::Boolean) ) {
 
-      machine.states[(int) JuraEntityConfigurations[entityConfigurationIndex].state] = JuraEntityConfigurations[entityConfigurationIndex].defaultValue;
+      machine.states.load(JuraEntityConfigurations[entityConfigurationIndex].state, JuraEntityConfigurations[entityConfigurationIndex].defaultValue);
 
       /* notify bridge of change */
       bridge.machineStateChanged(JuraEntityConfigurations[entityConfigurationIndex].state, machine.states[ (int) JuraEntityConfigurations[entityConfigurationIndex].state]);
@@ -651,7 +1057,13 @@ void IRAM_ATTR buttonInterruptSwitchPressRoutine() {
     menuButton.startat = millis();
     menuButton.endat = 0;
   }
- 
+
+  /* wake the menu handler; it sleeps while the menu is closed and the button untouched */
+  if (xMenu != NULL){
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(xMenu, &woken);
+    if (woken){portYIELD_FROM_ISR();}
+  }
 }
 
 /***************************************************************************//**
@@ -662,10 +1074,17 @@ void IRAM_ATTR buttonInterruptSwitchPressRoutine() {
  * @param[in] none
  ******************************************************************************/
 void customMenuHandler(void * parameter){
-  int menuItems = sizeof(JuraCustomMenuItemConfigurations) / sizeof(JuraCustomMenuItemConfigurations[0]) ; 
   bool canceled = false; 
 
   for(;;){
+    /* idle: block until the button interrupt; a press before this point is already counted */
+    if (!customMenu.active && !menuButton.released && menuButton.startat == 0){
+      ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+
+    /* user items can change at any time */
+    int menuItems = customMenuItemCount();
+
     /* menu active or not? */
     bool userMadeSelectionByHoldingButton = false;
 
@@ -692,44 +1111,28 @@ void customMenuHandler(void * parameter){
           customMenu.time = millis();
 
           /* set menu name; zero indexed but iterator is 1 indexed */
-          bridge.instructServicePortToDisplayString(JuraCustomMenuItemConfigurations[customMenu.item - 1].name);
+          bridge.instructServicePortToDisplayString(customMenuItem(customMenu.item - 1).name, JuraDisplayPriority::Menu);
 
       /* menu active, and user held button*/
       }else if (userMadeSelectionByHoldingButton && customMenu.active){
 
-        /* if the currently-selected item is less than the last item, trigger the appropriate menu item mqtt */
+        /* if the currently-selected item is less than the last item, order its compiled recipe */
         if (customMenu.item < menuItems){
           bridge.instructServicePortToDisplayString("   WAIT");
-
-          /* send mqtt message corresponding to selected emnu item */
-          xSemaphoreTake( xMQTTSemaphore, portMAX_DELAY );
-
-          /* trigger internal mqtt processor for consistently; do not need to bounce from broker */
-          mqttCallbackBypassBroker(
-            JuraCustomMenuItemConfigurations[customMenu.item - 1].topic,
-            JuraCustomMenuItemConfigurations[customMenu.item - 1].payload, 
-            strlen(JuraCustomMenuItemConfigurations[customMenu.item - 1].payload) + 1
-          );
-
-          /*
-          mqttClient.publish(
-            JuraCustomMenuItemConfigurations[customMenu.item - 1].topic,
-            JuraCustomMenuItemConfigurations[customMenu.item - 1].payload 
-          );*/  
-          xSemaphoreGive(xMQTTSemaphore);
+          orderCustomMenuItem(customMenu.item - 1);
 
         }else{
           /* so the ready prompt doesn't show immediately */
           vTaskDelay(750 / portTICK_PERIOD_MS);
 
           /* if we are at the last item, set ready */
-          bridge.instructServicePortToSetReady();
+          bridge.instructServicePortToSetReady(JuraDisplayPriority::Menu);
         }
 
       /* menu is not avtive, but user pressed the button */
       } else if (! customMenu.active ){
         /* start the menu off regardless whether it's being held or not */
-        bridge.instructServicePortToDisplayString(JuraCustomMenuItemConfigurations[0].name);
+        bridge.instructServicePortToDisplayString(customMenuItem(0).name, JuraDisplayPriority::Menu);
         customMenu.item = 1;
         customMenu.active = true;
         customMenu.time = millis();
@@ -752,12 +1155,12 @@ void customMenuHandler(void * parameter){
       if (menuButton.startat != 0){
         if (millis() - menuButton.startat > 800 && !menuButton.isBeingHeld){
           menuButton.isBeingHeld = true; 
-          bridge.instructServicePortToDisplayString("    OK");
+          bridge.instructServicePortToDisplayString("    OK", JuraDisplayPriority::Menu);
           vTaskDelay(250 / portTICK_PERIOD_MS);
         
         }else if (millis() - menuButton.startat > 2500 && menuButton.isBeingHeld && !canceled){
           canceled = true;
-          bridge.instructServicePortToDisplayString("  CANCEL");
+          bridge.instructServicePortToDisplayString("  CANCEL", JuraDisplayPriority::Menu);
           customMenu.item = (customMenu.item % menuItems) - 1; 
           vTaskDelay(500 / portTICK_PERIOD_MS);
         }
@@ -767,7 +1170,7 @@ void customMenuHandler(void * parameter){
     /* is the menu timed out while the button isn't being engaged by the user ? */
     if (!menuButton.isBeingHeld){
       if ((customMenu.active && (millis() - customMenu.time > 15000)) || (userMadeSelectionByHoldingButton && customMenu.active)){
-        if (!userMadeSelectionByHoldingButton){bridge.instructServicePortToSetReady();}
+        if (!userMadeSelectionByHoldingButton){bridge.instructServicePortToSetReady(JuraDisplayPriority::Menu);}
         customMenu.active = false; 
         customMenu.item = 0;
 
@@ -778,9 +1181,38 @@ void customMenuHandler(void * parameter){
         menuButton.isBeingHeld = false;
       }
     }
+
+    /* open menu or button down: poll for hold and timeout */
+    vTaskDelay(pdMS_TO_TICKS(JURA_CUSTOM_MENU_POLL_MS));
   }
 }
 
+/***************************************************************************//**
+ * Create a task with the core, priority and stack from the task topology; the
+ * memory monitor watches its stack from then on.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] JuraTask task
+ * @param[in] TaskFunction_t function
+ * @param[out] TaskHandle_t *handle, may be null
+ ******************************************************************************/
+void startTask(JuraTask task, TaskFunction_t function, TaskHandle_t * handle){
+  for (const JuraTaskConfiguration &configuration : JuraTaskConfigurations){
+    if (configuration.task != task){continue;}
+    BaseType_t core = configuration.core == JURA_TASK_ANY_CORE ? tskNO_AFFINITY : configuration.core;
+    TaskHandle_t created = NULL;
+    if (xTaskCreatePinnedToCore(function, configuration.name, configuration.stack, NULL, configuration.priority, &created, core) != pdPASS){
+      ESP_LOGE(TAG,"--> Task %s not created", configuration.name);
+      return;
+    }
+    if (handle != NULL){*handle = created;}
+    memory.watch(task, configuration.name, configuration.stack, created);
+    return;
+  }
+  ESP_LOGE(TAG,"--> Task %i has no configuration", (int) task);
+}
+
 /***************************************************************************//**
  * Arduino-specific setup loop. 
  *
@@ -792,24 +1224,17 @@ void setup() {
 
   /* led control */
   pinMode(DEV_BOARD_LED_PIN, OUTPUT);
-  xTaskCreate(
-    statusLEDBlinker,   
-    "statusLEDBlinker",  
-    2048,           
-    NULL,      
-    2,
-    &xLED
-  );
+  startTask(JuraTask::StatusLED, statusLEDBlinker, &xLED);
 
-  /* UART requires to much vTaskDelayMilliseconds and blocking; semaphore to prevent doubled instructions */
-  xUARTSemaphore = xSemaphoreCreateBinary(); 
+  /* the service port arbitrates its own access by lane */
   xMQTTSemaphore = xSemaphoreCreateBinary(); 
   xMQTTStatusSemaphore = xSemaphoreCreateBinary();
   xWIFIStatusSemaphore = xSemaphoreCreateBinary();
   xMachineReadyStateVariableSemaphore = xSemaphoreCreateBinary();
+  xMachineEvents = xEventGroupCreate();
+  xRediscoverySemaphore = xSemaphoreCreateBinary();
 
   /* give all semaphores */
-  xSemaphoreGive( xUARTSemaphore);
   xSemaphoreGive( xMQTTSemaphore);
   xSemaphoreGive( xMQTTStatusSemaphore);
   xSemaphoreGive( xWIFIStatusSemaphore);
@@ -826,7 +1251,7 @@ void setup() {
   xQ_SubscriptionMessage = xQueueCreate( 1, sizeof(mqtt_message) );
 
   /* booting message on display */
-  bridge.instructServicePortToDisplayString(" STARTING ");
+  bridge.instructServicePortToDisplayString(" STARTING ", JuraDisplayPriority::Status);
 
   /* print hardware information */
   ESP_LOGI(TAG,"jurabridge v" VERSION_STR);
@@ -834,47 +1259,33 @@ void setup() {
   //set output pin modes
   pinMode(DEV_BOARD_BUTTON_PIN, INPUT_PULLUP);
   attachInterrupt(DEV_BOARD_BUTTON_PIN, buttonInterruptSwitchPressRoutine,CHANGE);
-  xTaskCreate(
-    customMenuHandler,   
-    "customMenuHandler",  
-    10000,           
-    NULL,      
-    2,
-    NULL
-  );
+  startTask(JuraTask::CustomMenu, customMenuHandler, &xMenu);
 
   /* init preferences */
   prefs.begin(PREF_KEY, false);
+  network.begin(WIFINAME, WIFIPASS);
+  loadUserMenuItemsFromNonVolatileStorage();
+  programs.load();
+  preheat.begin();
+  uartCalibration.begin();
 
   /* mqtt keepalive; design pattern inspired by @idahowalker */
-  xTaskCreate( 
-    communicationsKeepAliveTask, 
-    "communicationsKeepAliveTask", 
-    10000, 
-    NULL, 
-    5, 
-    NULL)
-  ;
+  startTask(JuraTask::CommunicationsKeepAlive, communicationsKeepAliveTask, NULL);
 
   /* mqtt queue */
-  xTaskCreate( 
-    receivedMQTTMessageQueueWorker,
-    "receivedMQTTMessageQueueWorker", 
-    10000, 
-    NULL, 
-    5, 
-    NULL
-  );
+  startTask(JuraTask::MessageWorker, receivedMQTTMessageQueueWorker, NULL);
+
+  /* order queue */
+  startTask(JuraTask::OrderWorker, orderQueueWorker, NULL);
+
+  /* preheat planner */
+  startTask(JuraTask::PreheatPlanner, preheatPlannerTask, NULL);
+
+  /* home assistant rediscovery */
+  startTask(JuraTask::Rediscovery, rediscoveryTask, NULL);
 
   /* uart task */
-  xTaskCreate(
-    machineStatePollingHandler,        
-    "machineStatePollingHandler",      
-    10000,            
-    NULL,            
-    4,               
-    &xUART
-  );
+  startTask(JuraTask::MachinePolling, machineStatePollingHandler, &xUART);
 
 }
 
@@ -2,9 +2,18 @@
 #define JURACONFIGURATION_H
 #include "JuraEnums.h"
 
+/* language standard: gnu++17, as the arduino-esp32 2.x and 3.x cores build sketches; the headers use
+   if constexpr, fold expressions and multi-statement constexpr functions. the 1.x core (gnu++11) is not supported */
+#if __cplusplus < 201703L
+#error "jurabridge requires C++17; build with arduino-esp32 core 2.x or later"
+#endif
+
 /* debugging and ressearch feature flags */
 #define PRINT_UNHANDLED    false    /* print values that aren't curerntly captured; for investigation of new values and when they change*/
 #define PRINT_KNOWN_VALUES false    /* for debugging, print captured values when recognized andupdated */
+#define MEMORY_PROFILING   false    /* attribute stack and heap low water marks to instrumented code paths; published with memory diagnostics */
+#define EEPROM_SCANNER     false    /* scan every RT: line while idle or ready; changed words published to MQTT_ROOT/research/eeprom */
+#define WORKING_MEMORY_SCANNER false /* scan RM: working memory while idle or ready, and watch points during dispenses; MQTT_ROOT/research/memory */
 
 /* ESP */
 #define BRIDGE_NAME       "Jura Bridge"
@@ -31,6 +40,11 @@
 #define DEV_BOARD_UART_RX_PIN                   16
 #define DEV_BOARD_UART_TX_PIN                   17
 #define DEV_BOARD_UART_TIMEOUT                  300
+#define DEV_BOARD_UART_CHAR_DELAY_MS            8       /* pause after each encoded character until calibrated; known safe */
+#define DEV_BOARD_UART_RESPONSE_TIMEOUT_MS      5000    /* wait for a reply while the machine is online */
+#define JURA_WIRE_BYTES_PER_CHAR                4       /* two data bits per wire byte */
+#define JURA_WIRE_COMMAND_MAX                   9       /* longest static command with crlf, characters; "RT:0000\r\n" */
+#define JURA_WIRE_DYNAMIC_MAX                   64      /* longest free-form command (display text), characters */
 
 /* timeout values for force refresh */
 #define JURA_MACHINE_EEPROM_TIMEOUT             3000000
@@ -41,6 +55,7 @@
 /* timeout values for calculated properties */ 
 #define JURA_MACHINE_BEANS_REFILLED_TIMEOUT           5000
 #define JURA_MACHINE_DRAINAGE_TRAY_EMPTIED            5000
+#define JURA_MACHINE_RECENT_CHANGE_WINDOW_MS          15000 /* completion handler: states changed this recently are attributed to the last operation */
 
 /* timeouts for machine operations */
 #define JURA_MACHINE_AWAIT_NEXT_INSTRUCTION_TIMEOUT_S 120
@@ -49,8 +64,127 @@
 #define JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S 90
 #define JURA_MACHINE_AUTOMATIC_BREW_GROUP_RINSE_TIMEOUT_S 300
 
+/* recipe engine */
+#define JURA_RECIPE_MAX_STEPS                   16
+#define JURA_RECIPE_READY_TIMEOUT_MS            300000 /* longest wait for the machine to finish the previous product */
+#define JURA_RECIPE_DISPENSE_START_TIMEOUT_MS   15000  /* a product command the machine has not started by now is abandoned */
+#define JURA_RECIPE_SELECTION_TIMEOUT_MS        120000 /* user did not select a product on the machine; matches the idle limit reset */
+#define JURA_MENU_STEP_TIMEOUT_MS               1500   /* an acknowledged menu press not registered by now aborts navigation */
+#define JURA_MENU_STEP_POLL_MS                  20     /* between reads of the menu signature word */
+#define JURA_MENU_STEP_RETRIES                  2      /* resends of a menu press the machine did not acknowledge; also rereads of an unanswered signature */
+#define JURA_MENU_ENTRY_SETTLE_MS               300    /* after the press that opens a menu, before its first button */
+
+/* custom menu */
+#define JURA_CUSTOM_MENU_NAME_SIZE              12     /* display name, terminated; the display shows ten characters */
+#define JURA_CUSTOM_MENU_POLL_MS                50     /* menu handler poll while the menu is open or the button is down; blocked otherwise */
+#define JURA_USER_MENU_ITEMS_MAX                8      /* menu items stored in nvs, shown before the exit item */
+
+/* user recipe programs */
+#define JURA_RECIPE_PROGRAMS_MAX                8      /* nvs slots */
+#define JURA_RECIPE_PROGRAM_MAX_BYTES           64     /* bytecode per program; bounds the steps of a run */
+#define JURA_RECIPE_PROGRAM_VERSION             1      /* stored with each program; others are ignored on load */
+
+/* order queue */
+#define JURA_ORDER_QUEUE_MAX                    8      /* pending orders; further orders are rejected until one is served */
+#define JURA_ORDER_DEFAULT_SERVICE_MS           60000  /* eta estimate for a product with no measured service time */
+
+/* task topology; see JuraTaskConfigurations */
+#define JURA_TASK_ANY_CORE                      -1
+#define JURA_POLL_INTERVAL_MS                   10     /* sleep between machine polls */
+#define JURA_POLL_JITTER_WINDOW                 1000   /* polls per jitter report */
+#define JURA_POLL_JITTER_BOUND_US               2000   /* poll wake lateness the shipped layout stays under while wi-fi is busy */
+
+/* uart character gap calibration; IC: trials bisecting between 0 and DEV_BOARD_UART_CHAR_DELAY_MS */
+#define JURA_UART_CALIBRATION_TRIALS            20     /* valid replies in a row for a gap to pass */
+#define JURA_UART_CALIBRATION_RESOLUTION_US     250
+#define JURA_UART_CALIBRATION_MARGIN_PCT        50     /* added to the shortest passing gap */
+#define JURA_UART_CALIBRATION_MARGIN_MIN_US     1000   /* added at least */
+#define JURA_UART_CALIBRATION_RETRY_MS          60000  /* after a calibration the machine did not answer */
+#define JURA_UART_FALLBACK_WINDOW               200    /* transfers per error rate window */
+#define JURA_UART_FALLBACK_FAILURES             3      /* unanswered in a window, while online, before the default gap is restored */
+
+/* uart arbitration */
+#define JURA_UART_LANE_WAITERS                  8      /* per lane; at least the number of tasks that talk to the machine */
+#define JURA_UART_PREEMPT_GRACE_MS              300    /* a user transfer waits this long for its reply before a safety transfer cuts in */
+#define JURA_UART_DRAIN_QUIET_MS                50     /* after a cut reply, the line is clear once nothing arrives for this long */
+#define JURA_UART_DRAIN_MAX_MS                  500    /* longest wait for the rest of a cut reply */
+#define JURA_UART_LANE_REPORT_MS                60000
+
+/* DT: display text */
+#define JURA_DISPLAY_MIN_INTERVAL_MS            200    /* between writes; text set sooner is written by the poll task, last one wins */
+#define JURA_DISPLAY_HOLD_MS                    2000   /* a text keeps lower priority text off the display this long */
+
+/* machine connection */
+#define JURA_CONNECTION_OFFLINE_FAILURES        3      /* unanswered transfers in a row before polling stops */
+#define JURA_CONNECTION_DEGRADED_TIMEOUT_MS     1000   /* reply wait after an unanswered transfer */
+#define JURA_CONNECTION_PROBE_TIMEOUT_MS        300    /* reply wait while offline */
+#define JURA_CONNECTION_PROBE_MIN_MS            1000   /* first probe interval; doubles per unanswered probe */
+#define JURA_CONNECTION_PROBE_MAX_MS            30000
+#define JURA_CONNECTION_OFFLINE_TICK_MS         100    /* poll task sleep while offline */
+
+/* wi-fi and broker */
+#define JURA_NETWORK_LOOP_MS                    250    /* communications task period while connected; a wi-fi event ends it early */
+#define JURA_NETWORK_WIFI_TIMEOUT_MS            10000  /* wait for an ip per attempt */
+#define JURA_NETWORK_BROKER_TIMEOUT_S           3      /* broker socket timeout per attempt */
+#define JURA_NETWORK_BACKOFF_MIN_MS             500    /* first retry after a failed attempt; doubles per failure, +-25% jitter */
+#define JURA_NETWORK_BACKOFF_MAX_MS             30000
+
+/* offline backlog */
+#define JURA_BACKLOG_EVENTS                     24     /* meter values kept while the broker is down; oldest dropped beyond */
+
+/* home assistant rediscovery */
+#define JURA_REDISCOVERY_DELAY_MS               5000   /* after its birth message, before republishing */
+#define JURA_REDISCOVERY_METER_MS               20     /* between republished states */
+
+/* memory monitor */
+#define JURA_MEMORY_SAMPLE_MS                   30000
+#define JURA_MEMORY_TASKS_MAX                   12
+#define JURA_MEMORY_PROFILE_PATHS_MAX           16
+#define JURA_MQTT_PAYLOAD_SIZE                  2048   /* shared json payload buffer; serialized and sent under the mqtt semaphore */
+
+/* drink latency */
+#define JURA_LATENCY_HISTORY_SIZE               32     /* completed drinks kept for percentiles */
+#define JURA_LATENCY_RECEIPT_WINDOW_MS          30000  /* an mqtt message this long before a product command is taken as its origin */
+#define JURA_LATENCY_COMMAND_WINDOW_MS          15000  /* ready falling this soon after a product command belongs to it */
+
+/* predictive preheat */
+#define JURA_PREHEAT_TIMEZONE                   "UTC0"          /* posix tz; defaults to UTC, so bins are utc times of day. set local time (e.g. "EST5EDT,M3.2.0,M11.1.0") so the pattern follows daylight saving */
+#define JURA_PREHEAT_NTP_SERVER                 "pool.ntp.org"
+#define JURA_PREHEAT_BINS                       48     /* time of day histogram; half hour bins */
+#define JURA_PREHEAT_IDLE_GAP_MIN               120    /* a selection after this long without one is a first drink */
+#define JURA_PREHEAT_LEAD_MIN                   10     /* flush this far ahead of the expected first drink */
+#define JURA_PREHEAT_EFFECT_MIN                 30     /* a first drink this soon after a flush counts as preheated */
+#define JURA_PREHEAT_MIN_FIRST_DRINKS           5      /* first drinks observed before any prediction is made */
+#define JURA_PREHEAT_MIN_SHARE_PCT              15     /* share of first drinks a bin needs to trigger a flush */
+#define JURA_PREHEAT_FLUSH_ML                   30     /* hot water; same as the flush heat menu item */
+#define JURA_PREHEAT_CHECK_INTERVAL_MS          60000
+
+/* eeprom research scanner */
+#define JURA_EEPROM_SCAN_LINES                  16     /* RT:0000 - RT:00F0; the lines with static commands */
+#define JURA_EEPROM_SCAN_WORDS_PER_LINE         16
+#define JURA_EEPROM_SCAN_WORDS                  (JURA_EEPROM_SCAN_LINES * JURA_EEPROM_SCAN_WORDS_PER_LINE)
+#define JURA_EEPROM_SCAN_HISTORY                32     /* recent changes kept for publishing */
+#define JURA_EEPROM_SCAN_PUBLISH_MAX            16     /* changes per message */
+
+/* working memory research scanner */
+#define JURA_WORKING_MEMORY_WORDS               224    /* RM:00 - RM:DF; one word per byte address */
+#define JURA_WORKING_MEMORY_BATCH               4      /* addresses read per due scan poll */
+#define JURA_WORKING_MEMORY_WATCH_MAX           8      /* watch points; one is read per due watch poll, round robin */
+#define JURA_WORKING_MEMORY_HISTORY             48     /* recent changes kept for publishing */
+#define JURA_WORKING_MEMORY_PUBLISH_MAX         24     /* changes per message */
+
+/* shot profile recorder */
+#define SHOT_PROFILE_HISTORY_SIZE               8     /* completed profiles kept in ring (psram if available) */
+#define SHOT_PROFILE_MAX_BYTES                  1024  /* encoded bytes per profile; profile is marked truncated when full */
+#define SHOT_PROFILE_SETTLE_TIMEOUT_MS          5000  /* no volume change for this long with pump off closes the profile */
+
 /* preference keys */
 #define PREF_KEY                                "jb"
+#define PREF_USER_MENU_KEY                      "umenu" /* blob of packed user menu items */
+#define PREF_RECIPE_PROGRAM_KEY                 "rcp"   /* followed by the slot number */
+#define PREF_PREHEAT_KEY                        "preheat" /* blob of the first drink histogram and preheat results */
+#define PREF_NETWORK_CACHE_KEY                  "netcache" /* bssid and channel of the last association */
+#define PREF_UART_GAP_KEY                       "uartgap" /* calibrated character gap, us, margin included */
 
 /* temperature thresholds */
 #define COLD_MODE_THRESHOLD                     60
@@ -2135,6 +2269,86 @@ static const JuraEntityConfiguration JuraEntityConfigurations[] = {
     JuraMachineSubsystem::Controller,
     JuraEntityNonvolatile::No,
   },
+  {
+    JuraMachineStateIdentifier::BridgeFreeHeap,
+    NAME_PREFIX "Bridge Free Heap",
+    ENTITY_PREFIX "bridge_free_heap",
+    JuraMachineStateDataType::Integer,
+    JuraMachineStateCategory::Diagnostic,
+    JuraMachineDeviceClass::None,
+    JuraMachineStateIcon::Info,
+    JuraMachineStateUnit::Bytes,
+    JuraEntityEnabled::Yes,
+    JuraEntitySerialPrintable::No,
+    JuraEntityAvailabilityFollowsReadyState::No,
+    JuraMachineSubsystemAttributeType::DataValue,
+    JuraMachineSubsystem::Bridge,
+    JuraEntityNonvolatile::No,
+  },
+  {
+    JuraMachineStateIdentifier::BridgeMinimumFreeHeap,
+    NAME_PREFIX "Bridge Minimum Free Heap",
+    ENTITY_PREFIX "bridge_minimum_free_heap",
+    JuraMachineStateDataType::Integer,
+    JuraMachineStateCategory::Diagnostic,
+    JuraMachineDeviceClass::None,
+    JuraMachineStateIcon::Info,
+    JuraMachineStateUnit::Bytes,
+    JuraEntityEnabled::Yes,
+    JuraEntitySerialPrintable::No,
+    JuraEntityAvailabilityFollowsReadyState::No,
+    JuraMachineSubsystemAttributeType::DataValue,
+    JuraMachineSubsystem::Bridge,
+    JuraEntityNonvolatile::No,
+  },
+  {
+    JuraMachineStateIdentifier::BridgeLargestFreeBlock,
+    NAME_PREFIX "Bridge Largest Free Block",
+    ENTITY_PREFIX "bridge_largest_free_block",
+    JuraMachineStateDataType::Integer,
+    JuraMachineStateCategory::Diagnostic,
+    JuraMachineDeviceClass::None,
+    JuraMachineStateIcon::Info,
+    JuraMachineStateUnit::Bytes,
+    JuraEntityEnabled::Yes,
+    JuraEntitySerialPrintable::No,
+    JuraEntityAvailabilityFollowsReadyState::No,
+    JuraMachineSubsystemAttributeType::DataValue,
+    JuraMachineSubsystem::Bridge,
+    JuraEntityNonvolatile::No,
+  },
+  {
+    JuraMachineStateIdentifier::BridgeHeapFragmentation,
+    NAME_PREFIX "Bridge Heap Fragmentation",
+    ENTITY_PREFIX "bridge_heap_fragmentation",
+    JuraMachineStateDataType::Integer,
+    JuraMachineStateCategory::Diagnostic,
+    JuraMachineDeviceClass::None,
+    JuraMachineStateIcon::Info,
+    JuraMachineStateUnit::Percent,
+    JuraEntityEnabled::Yes,
+    JuraEntitySerialPrintable::No,
+    JuraEntityAvailabilityFollowsReadyState::No,
+    JuraMachineSubsystemAttributeType::DataValue,
+    JuraMachineSubsystem::Bridge,
+    JuraEntityNonvolatile::No,
+  },
+  {
+    JuraMachineStateIdentifier::BridgeStackHeadroom,
+    NAME_PREFIX "Bridge Stack Headroom",
+    ENTITY_PREFIX "bridge_stack_headroom",
+    JuraMachineStateDataType::Integer,
+    JuraMachineStateCategory::Diagnostic,
+    JuraMachineDeviceClass::None,
+    JuraMachineStateIcon::Info,
+    JuraMachineStateUnit::Bytes,
+    JuraEntityEnabled::Yes,
+    JuraEntitySerialPrintable::No,
+    JuraEntityAvailabilityFollowsReadyState::No,
+    JuraMachineSubsystemAttributeType::DataValue,
+    JuraMachineSubsystem::Bridge,
+    JuraEntityNonvolatile::No,
+  },
 };  
 
 /*
@@ -2145,7 +2359,8 @@ static const JuraEntityConfiguration JuraEntityConfigurations[] = {
 
 */
 
-static const JuraMachineFunctionEntityConfiguration JuraMachineFunctionEntityConfigurations[] = {
+/* constexpr: custom menu topics are resolved against this table at compile time */
+static constexpr JuraMachineFunctionEntityConfiguration JuraMachineFunctionEntityConfigurations[] = {
   {
     JuraFunctionIdentifier::PowerOff, 
     NAME_PREFIX "Power Off",
@@ -2403,4 +2618,52 @@ static const JuraMachineFunctionEntityConfiguration JuraMachineFunctionEntityCon
   }
 };
 
+/*
+
+  name:         JuraTaskConfigurations
+  type:         table
+  description:  core, priority and stack of every task. wi-fi, lwip and the
+                arduino event loop run on core 0, so the service port poll is
+                pinned alone at the top of core 1; it sleeps between polls,
+                which is when the order worker, menu and planner run. each of
+                those blocks when idle (the order worker on its queue, the
+                menu on a notification from the button interrupt, the planner
+                between checks) so the arduino loop task, which runs setup()
+                on core 1 at priority 1, is never starved. mqtt work stays on core 0 next
+                to the network stack it waits on; rediscovery runs there at the
+                lowest priority, so its burst yields to the broker loop and the
+                message worker. the poll jitter probe reports
+                how late the poll wakes against JURA_POLL_JITTER_BOUND_US.
+
+                stack sizes are estimates, not measurements: tasks keep the
+                10000 bytes they ran with before the memory monitor existed
+                (the led blinker and planner their smaller originals) until
+                its stack high water marks on /diagnostics/memory justify
+                cutting them. json payloads are serialized into the bridge's
+                shared buffer, so no task holds one on its stack.
+
+*/
+static constexpr JuraTaskConfiguration JuraTaskConfigurations[] = {
+  {JuraTask::StatusLED,               "statusLEDBlinker",               JURA_TASK_ANY_CORE, 1,  2048},
+  {JuraTask::CustomMenu,              "customMenuHandler",              1,                  3,  10000},
+  {JuraTask::CommunicationsKeepAlive, "communicationsKeepAliveTask",    0,                  3,  10000},
+  {JuraTask::MessageWorker,           "receivedMQTTMessageQueueWorker", 0,                  3,  10000},
+  {JuraTask::OrderWorker,             "orderQueueWorker",               1,                  4,  10000},
+  {JuraTask::PreheatPlanner,          "preheatPlannerTask",             1,                  2,  4096},
+  {JuraTask::Rediscovery,             "rediscoveryTask",                0,                  1,  10000},
+  {JuraTask::MachinePolling,          "machineStatePollingHandler",     1,                  10, 10000},
+};
+
+/*
+
+  name:         JuraWorkingMemoryRanges
+  type:         array
+  description:  RM: addresses swept by the working memory scanner; narrow to
+                the ranges under investigation to revisit them more often
+
+*/
+static constexpr JuraWorkingMemoryRange JuraWorkingMemoryRanges[] = {
+  {0x00, 0xDF},
+};
+
 #endif
\ No newline at end of file
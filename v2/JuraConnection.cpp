@@ -0,0 +1,103 @@
+#include "JuraConnection.h"
+
+JuraConnectionMonitor::JuraConnectionMonitor() {}
+
+/* caller holds the lock; probing is part of an outage, not a change of it */
+void JuraConnectionMonitor::setState(JuraConnectionState state, unsigned long now){
+  bool outage = state == JuraConnectionState::Offline || state == JuraConnectionState::Probing;
+  bool wasOutage = _state == JuraConnectionState::Offline || _state == JuraConnectionState::Probing;
+  if (state != _state && !(outage && wasOutage)){
+    _changed = true;
+    _state_since = now;
+  }
+  _state = state;
+}
+
+/***************************************************************************//**
+ * Advance the state machine with the outcome of one transfer.
+ *
+ * @param[out] null
+ *
+ * @param[in] bool answered
+ * @param[in] unsigned long now
+ ******************************************************************************/
+void JuraConnectionMonitor::record(bool answered, unsigned long now){
+  portENTER_CRITICAL(&_lock);
+  bool outage = _state == JuraConnectionState::Offline || _state == JuraConnectionState::Probing;
+
+  if (answered){
+    if (outage){_offline_total += now - _state_since;}
+    _failures = 0;
+    _backoff = 0;
+    setState(JuraConnectionState::Online, now);
+
+  } else if (outage){
+    _failures++;
+    _backoff = _backoff * 2 > JURA_CONNECTION_PROBE_MAX_MS ? JURA_CONNECTION_PROBE_MAX_MS : _backoff * 2;
+    _next_probe = now + _backoff;
+    setState(JuraConnectionState::Offline, now);
+
+  } else if (++_failures >= JURA_CONNECTION_OFFLINE_FAILURES){
+    _outages++;
+    _backoff = JURA_CONNECTION_PROBE_MIN_MS;
+    _next_probe = now + _backoff;
+    setState(JuraConnectionState::Offline, now);
+
+  } else {
+    setState(JuraConnectionState::Degraded, now);
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+bool JuraConnectionMonitor::beginProbe(unsigned long now){
+  portENTER_CRITICAL(&_lock);
+  bool due = _state == JuraConnectionState::Offline && (long) (now - _next_probe) >= 0;
+  if (due){setState(JuraConnectionState::Probing, now);}
+  portEXIT_CRITICAL(&_lock);
+  return due;
+}
+
+bool JuraConnectionMonitor::isPollable(){
+  portENTER_CRITICAL(&_lock);
+  bool pollable = _state == JuraConnectionState::Online || _state == JuraConnectionState::Degraded;
+  portEXIT_CRITICAL(&_lock);
+  return pollable;
+}
+
+/* a machine that has stopped answering is not waited on for long */
+unsigned long JuraConnectionMonitor::responseTimeout(){
+  switch (state()){
+    case JuraConnectionState::Online:   return DEV_BOARD_UART_RESPONSE_TIMEOUT_MS;
+    case JuraConnectionState::Degraded: return JURA_CONNECTION_DEGRADED_TIMEOUT_MS;
+    default:                            return JURA_CONNECTION_PROBE_TIMEOUT_MS;
+  }
+}
+
+JuraConnectionState JuraConnectionMonitor::state(){
+  portENTER_CRITICAL(&_lock);
+  JuraConnectionState state = _state;
+  portEXIT_CRITICAL(&_lock);
+  return state;
+}
+
+JuraConnectionStatus JuraConnectionMonitor::status(unsigned long now){
+  JuraConnectionStatus status;
+  portENTER_CRITICAL(&_lock);
+  bool outage = _state == JuraConnectionState::Offline || _state == JuraConnectionState::Probing;
+  status.state =      _state;
+  status.failures =   _failures;
+  status.outages =    _outages;
+  status.offlineMs =  _offline_total + (outage ? now - _state_since : 0);
+  status.stateMs =    now - _state_since;
+  status.backoffMs =  _backoff;
+  portEXIT_CRITICAL(&_lock);
+  return status;
+}
+
+bool JuraConnectionMonitor::takeChange(){
+  portENTER_CRITICAL(&_lock);
+  bool changed = _changed;
+  _changed = false;
+  portEXIT_CRITICAL(&_lock);
+  return changed;
+}
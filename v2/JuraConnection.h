@@ -0,0 +1,64 @@
+#ifndef JURACONNECTION_H
+#define JURACONNECTION_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* health of the service port link to the machine */
+enum class JuraConnectionState {Online, Degraded, Offline, Probing};
+
+struct JuraConnectionStatus {
+  JuraConnectionState state;
+  int failures;                 /* consecutive unanswered transfers */
+  uint32_t outages;             /* times the machine went offline since boot */
+  unsigned long offlineMs;      /* total time offline since boot, current outage included */
+  unsigned long stateMs;        /* time in the current state (offline and probing are one) */
+  unsigned long backoffMs;      /* current probe interval; 0 unless offline */
+};
+
+/*
+
+  name:         JuraConnectionMonitor
+  type:         class
+  description:  connection state machine fed by every service port transfer.
+
+                online: answering. degraded: one or more unanswered transfers
+                in a row; polling continues with a shorter response timeout.
+                offline: JURA_CONNECTION_OFFLINE_FAILURES in a row; polling
+                stops, and a probe is sent at an interval that doubles from
+                JURA_CONNECTION_PROBE_MIN_MS to JURA_CONNECTION_PROBE_MAX_MS.
+                probing: a probe is in flight. any answer returns to online.
+
+*/
+class JuraConnectionMonitor {
+public:
+  JuraConnectionMonitor();
+
+  /* every tracked transfer, while holding the port */
+  void record(bool, unsigned long);
+
+  /* offline with a probe due: moves to probing and returns true */
+  bool beginProbe(unsigned long);
+
+  bool isPollable();
+  unsigned long responseTimeout();
+  JuraConnectionState state();
+  JuraConnectionStatus status(unsigned long);
+
+  /* true once per change between online, degraded and offline */
+  bool takeChange();
+
+private:
+  JuraConnectionState _state = JuraConnectionState::Online;
+  int _failures = 0;
+  uint32_t _outages = 0;
+  unsigned long _offline_total = 0;
+  unsigned long _state_since = 0;
+  unsigned long _backoff = 0;
+  unsigned long _next_probe = 0;
+  bool _changed = false;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  void setState(JuraConnectionState, unsigned long);
+};
+
+#endif
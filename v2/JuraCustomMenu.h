@@ -1,15 +1,17 @@
 #ifndef JURACUSTOMMENU_H
 #define JURACUSTOMMENU_H
-#include "JuraEnums.h"
+#include "JuraPackedRecipe.h"
 /*
 
   name:         JuraCustomMenuItemConfiguration
   type:         array
-  description:  this array contains mqtt topics AND ORDER and messages for custom menu items
+  description:  this array contains mqtt topics AND ORDER and messages for custom menu items;
+                each entry is compiled to a packed recipe at build time, so an unknown topic,
+                an unknown payload key or a name longer than the display fails the build
 
 */
 
-static const JuraCustomMenuItemConfiguration JuraCustomMenuItemConfigurations[] {
+static constexpr JuraCustomMenuItem JuraCustomMenuItemConfigurations[] {
   {
     " RISTR x2",
     MQTT_ROOT MQTT_SUBTOPIC_FUNCTION "make_espresso",
@@ -0,0 +1,113 @@
+#include "JuraDisplay.h"
+
+JuraDisplayWriter::JuraDisplayWriter(JuraServicePort &servicePort) : _service_port(servicePort) {}
+
+/* caller holds the lock */
+void JuraDisplayWriter::set(const char * text, JuraDisplayPriority priority, unsigned long now){
+  if (_pending){_stats.merged++;}
+  strncpy(_desired, text, JURA_WIRE_DYNAMIC_MAX);
+  _desired[JURA_WIRE_DYNAMIC_MAX] = '\0';
+  _priority = priority;
+  _held_at = now;
+  _pending = true;
+}
+
+/***************************************************************************//**
+ * Ask for a text. Behind a hold of higher priority it is deferred; otherwise
+ * it replaces any text not yet written and is written if the interval allows.
+ *
+ * @param[out] null
+ *
+ * @param[in] const char *text full DT: command
+ * @param[in] JuraDisplayPriority priority
+ ******************************************************************************/
+void JuraDisplayWriter::show(const char * text, JuraDisplayPriority priority){
+  unsigned long now = millis();
+  portENTER_CRITICAL(&_lock);
+  if (priority < _priority && now - _held_at < JURA_DISPLAY_HOLD_MS){
+    if (_has_deferred){_stats.merged++;}
+    strncpy(_deferred, text, JURA_WIRE_DYNAMIC_MAX);
+    _deferred[JURA_WIRE_DYNAMIC_MAX] = '\0';
+    _deferred_priority = priority;
+    _has_deferred = true;
+    _stats.deferred++;
+    portEXIT_CRITICAL(&_lock);
+    return;
+  }
+  _has_deferred = false;
+  set(text, priority, now);
+  portEXIT_CRITICAL(&_lock);
+
+  flush();
+}
+
+/***************************************************************************//**
+ * Show a deferred text once its hold has ended, and write any pending text.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraDisplayWriter::service(){
+  unsigned long now = millis();
+  portENTER_CRITICAL(&_lock);
+  if (_has_deferred && now - _held_at >= JURA_DISPLAY_HOLD_MS){
+    _has_deferred = false;
+    set(_deferred, _deferred_priority, now);
+  }
+  bool pending = _pending;
+  portEXIT_CRITICAL(&_lock);
+
+  if (pending){flush();}
+}
+
+/***************************************************************************//**
+ * Write the desired text if it differs from the last one sent, the interval
+ * has passed and no other task is writing; otherwise it stays pending.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraDisplayWriter::flush(){
+  char text[JURA_WIRE_DYNAMIC_MAX + 1];
+
+  portENTER_CRITICAL(&_lock);
+  unsigned long now = millis();
+  if (!_pending || _writing || (_written_at != 0 && now - _written_at < JURA_DISPLAY_MIN_INTERVAL_MS)){
+    portEXIT_CRITICAL(&_lock);
+    return;
+  }
+  _pending = false;
+  if (strcmp(_desired, _shown) == 0){
+    _stats.skipped++;
+    portEXIT_CRITICAL(&_lock);
+    return;
+  }
+  strcpy(text, _desired);
+  _writing = true;
+  portEXIT_CRITICAL(&_lock);
+
+  _service_port.transferEncode(text, JuraUartLane::User);
+  bool answered = _service_port.isConnected;
+
+  portENTER_CRITICAL(&_lock);
+  _writing = false;
+  _written_at = millis();
+  strcpy(_shown, answered ? text : "");
+  _stats.writes++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraDisplayWriter::invalidate(){
+  portENTER_CRITICAL(&_lock);
+  _shown[0] = '\0';
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraDisplayWriter::report(JuraDisplayStats &stats){
+  portENTER_CRITICAL(&_lock);
+  stats = _stats;
+  _stats = {};
+  portEXIT_CRITICAL(&_lock);
+}
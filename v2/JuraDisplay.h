@@ -0,0 +1,81 @@
+#ifndef JURADISPLAY_H
+#define JURADISPLAY_H
+#include "JuraConfiguration.h"
+#include "JuraServicePort.h"
+#include <Arduino.h>
+
+/* who asked for the text on the display, lowest first */
+enum class JuraDisplayPriority {
+  Status,         /* boot and connection progress */
+  Operation,      /* orders, recipes, add shot, ready afterwards */
+  Menu,           /* the hardware button menu */
+};
+
+/* display traffic over one report window */
+struct JuraDisplayStats {
+  uint32_t writes;
+  uint32_t skipped;               /* same text as already shown */
+  uint32_t merged;                /* replaced before it was written */
+  uint32_t deferred;              /* held back behind a higher priority */
+};
+
+/*
+
+  name:         JuraDisplayWriter
+  type:         class
+  description:  keeps the DT: text the display should show and writes it only
+                when it differs from what the machine was last sent. writes
+                are at least JURA_DISPLAY_MIN_INTERVAL_MS apart; text set
+                sooner waits for the poll task, and only the last of a burst is
+                written.
+
+                a text holds the display for JURA_DISPLAY_HOLD_MS against
+                lower priorities; the latest of those is shown when the hold
+                ends. the machine overwrites DT: text on its own screens, so
+                the last write is forgotten when the operational state changes
+                or the machine goes offline.
+
+*/
+class JuraDisplayWriter {
+public:
+  JuraDisplayWriter(JuraServicePort &);
+
+  /* full command, e.g. "DT:   WAIT"; written now if the interval allows */
+  void show(const char *, JuraDisplayPriority);
+
+  /* pending text; poll task, between polls */
+  void service();
+
+  /* the machine's own screen replaced the text */
+  void invalidate();
+
+  /* stats since the last report; resets them */
+  void report(JuraDisplayStats &);
+
+private:
+  JuraServicePort &_service_port;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  /* wanted now; written if different from shown */
+  char _desired[JURA_WIRE_DYNAMIC_MAX + 1] = {};
+  JuraDisplayPriority _priority = JuraDisplayPriority::Status;
+  unsigned long _held_at = 0;
+  bool _pending = false;
+
+  /* latest lower priority text behind a hold */
+  char _deferred[JURA_WIRE_DYNAMIC_MAX + 1] = {};
+  JuraDisplayPriority _deferred_priority = JuraDisplayPriority::Status;
+  bool _has_deferred = false;
+
+  /* last sent */
+  char _shown[JURA_WIRE_DYNAMIC_MAX + 1] = {};
+  unsigned long _written_at = 0;
+  bool _writing = false;
+
+  JuraDisplayStats _stats = {};
+
+  void set(const char *, JuraDisplayPriority, unsigned long);
+  void flush();
+};
+
+#endif
@@ -0,0 +1,103 @@
+#include "JuraEepromScanner.h"
+#include "JuraPollPlan.h"
+
+JuraEepromScanner::JuraEepromScanner() {
+  memset(_line_state, -1, sizeof(_line_state));
+  memset(_changes, 0, sizeof(_changes));
+}
+
+void JuraEepromScanner::noteOperationalState(int state){
+  if (state == _state || state < 0 || state >= 32){return;}
+  _state = state;
+  for (int l = 0; l < JURA_EEPROM_SCAN_LINES; l++){
+    _line_through[l] |= (1UL << state);
+  }
+}
+
+/***************************************************************************//**
+ * Read the next line of the scan if it is due. A line that fails to read is
+ * retried on the next due poll.
+ *
+ * @param[out] bool true if a sweep completed and changes are waiting
+ *
+ * @param[in] int iterator
+ * @param[in] JuraServicePort &servicePort
+ ******************************************************************************/
+bool JuraEepromScanner::step(int iterator, JuraServicePort &servicePort){
+  if (_poll_rate <= 0 || _poll_rate >= POLL_DISABLED){return false;}
+  if (iterator % _poll_rate != 0){return false;}
+
+  if (!readLine(_line, servicePort)){return false;}
+
+  if (++_line < JURA_EEPROM_SCAN_LINES){return false;}
+  _line = 0;
+  _sweeps++;
+  return _sequence != _published;
+}
+
+/***************************************************************************//**
+ * Read one RT: line of sixteen words and record every word that changed since
+ * the line was last read. The first read of a line only sets the baseline.
+ *
+ * @param[out] bool false if the response was invalid
+ *
+ * @param[in] int line
+ * @param[in] JuraServicePort &servicePort
+ ******************************************************************************/
+bool JuraEepromScanner::readLine(int line, JuraServicePort &servicePort){
+  JuraServicePortCommand command = (JuraServicePortCommand) ((int) JuraServicePortCommand::RT0 + line);
+  String response = servicePort.transferEncodeCommand(command);
+  if (response.length() != JURA_EEPROM_SCAN_WORDS_PER_LINE * 4){return false;}
+
+  uint16_t words[JURA_EEPROM_SCAN_WORDS_PER_LINE];
+  for (int i = 0; i < JURA_EEPROM_SCAN_WORDS_PER_LINE; i++){
+    uint16_t value = 0;
+    for (int k = 0; k < 4; k++){
+      char c = response.charAt(i * 4 + k);
+      int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+      if (digit < 0){return false;}
+      value = (value << 4) | digit;
+    }
+    words[i] = value;
+  }
+
+  unsigned long now = millis();
+  for (int i = 0; i < JURA_EEPROM_SCAN_WORDS_PER_LINE; i++){
+    int word = line * JURA_EEPROM_SCAN_WORDS_PER_LINE + i;
+    if (_line_read[line] && words[i] != _value[word]){
+      _changed[word / 32] |= (1UL << (word % 32));
+      _through[word] |= _line_through[line] | (_state >= 0 ? (1UL << _state) : 0);
+
+      JuraEepromChange &change = _changes[_head];
+      change.sequence = ++_sequence;
+      change.word =     word;
+      change.from =     _value[word];
+      change.to =       words[i];
+      change.before =   _line_state[line];
+      change.after =    _state;
+      change.through =  _line_through[line];
+      change.at =       now;
+      _head = (_head + 1) % JURA_EEPROM_SCAN_HISTORY;
+      if (_count < JURA_EEPROM_SCAN_HISTORY){_count++;}
+
+      if (PRINT_UNHANDLED){ESP_LOGI(TAG,"UKN: [cmd:RT] [word:0x%02X] = %d -> %d (state %d -> %d, through 0x%X)", word, change.from, change.to, change.before, change.after, change.through);}
+    }
+    _value[word] = words[i];
+  }
+
+  _line_read[line] = true;
+  _line_state[line] = _state;
+  _line_through[line] = 0;
+  return true;
+}
+
+int JuraEepromScanner::takeChanges(JuraEepromChange * changes, int max){
+  int n = 0;
+  for (int i = 0; i < _count && n < max; i++){
+    const JuraEepromChange &change = _changes[(_head + JURA_EEPROM_SCAN_HISTORY - _count + i) % JURA_EEPROM_SCAN_HISTORY];
+    if ((int16_t) (change.sequence - _published) <= 0){continue;}
+    changes[n++] = change;
+  }
+  _published = _sequence;
+  return n;
+}
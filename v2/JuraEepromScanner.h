@@ -0,0 +1,81 @@
+#ifndef JURAEEPROMSCANNER_H
+#define JURAEEPROMSCANNER_H
+#include "JuraConfiguration.h"
+#include "JuraServicePort.h"
+#include <Arduino.h>
+
+/* one word that changed between two reads of its line */
+struct JuraEepromChange {
+  uint16_t sequence;
+  uint8_t word;             /* eeprom word address */
+  uint16_t from;
+  uint16_t to;
+  uint8_t before;           /* operational state at the previous read of the line */
+  uint8_t after;            /* operational state when the change was read */
+  uint32_t through;         /* operational states entered between the two reads; bit per state */
+  unsigned long at;
+};
+
+/*
+
+  name:         JuraEepromScanner
+  type:         class
+  description:  research scanner over the whole RT: address space, one line
+                per due poll. it is a poll plan source, listed only in the idle
+                and ready plans, so it never takes uart time from dispense
+                polling; with EEPROM_SCANNER off it is never due.
+
+                keeps the last value of every word, a bitmap of words that
+                have changed since boot, the operational states each word has
+                changed through, and a ring of recent changes. every change is
+                attributed to the operational states entered between the two
+                reads of its line. poll task only; not locked.
+
+*/
+class JuraEepromScanner {
+public:
+  JuraEepromScanner();
+
+  /* set by the poll plan; POLL_DISABLED stops the scan */
+  void setPollRate(int modulus) {_poll_rate = modulus;}
+
+  /* every poll; records operational state transitions for attribution */
+  void noteOperationalState(int);
+
+  /* read the next line if due; true when a sweep completes with unpublished changes */
+  bool step(int, JuraServicePort &);
+
+  int sweeps() {return _sweeps;}
+  bool hasChanged(int word) {return (_changed[word / 32] >> (word % 32)) & 1;}
+  uint16_t value(int word) {return _value[word];}
+  uint32_t changedThrough(int word) {return _through[word];}
+
+  /* changes not yet published, oldest first; marks them published */
+  int takeChanges(JuraEepromChange *, int);
+
+private:
+  int _poll_rate = 0;
+  int _line = 0;
+  int _sweeps = 0;
+  int _state = -1;
+
+  uint16_t _value[JURA_EEPROM_SCAN_WORDS] = {};
+  uint32_t _changed[JURA_EEPROM_SCAN_WORDS / 32] = {};
+  uint32_t _through[JURA_EEPROM_SCAN_WORDS] = {};
+
+  /* per line: state at the last read, states entered since */
+  int8_t _line_state[JURA_EEPROM_SCAN_LINES];
+  uint32_t _line_through[JURA_EEPROM_SCAN_LINES] = {};
+  bool _line_read[JURA_EEPROM_SCAN_LINES] = {};
+
+  /* recent changes */
+  JuraEepromChange _changes[JURA_EEPROM_SCAN_HISTORY];
+  int _head = 0;
+  int _count = 0;
+  uint16_t _sequence = 0;
+  uint16_t _published = 0;
+
+  bool readLine(int, JuraServicePort &);
+};
+
+#endif
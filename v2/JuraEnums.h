@@ -6,9 +6,29 @@
 #define MQTT_SUBTOPIC_FUNCTION  "/machine/function/"
 #define MQTT_SUBTOPIC_MENU      "/machine/menu"         /* message: mclean, rinse, mrinse, clean, filter */
 #define MQTT_BRIDGE_RESTART     "/bridge/restart"       /* message: none */
+#define MQTT_UART_CALIBRATE     "/bridge/calibrate"     /* message: none; finds the shortest character gap the machine accepts */
 #define MQTT_CONFIG_SEND        "/configuration"        /* message: none */
 #define HA_STATUS_MQTT          "homeassistant/status"  /* message: online (when HA reboots) */
 #define MQTT_DISPENSE_CONFIG    "/limits"               /* message:  {"water":50, "brew" : 15, "milk" : 50, "add" : 1} */
+#define MQTT_SHOT_PROFILE       "/profile"              /* published: one compressed trace per completed dispense */
+#define MQTT_ORDER              "/order"                /* message:  [{"function":"make_espresso", "brew":17, "add":1}, {"function":"make_coffee"}] */
+#define MQTT_ORDER_STATUS       "/order/status"         /* published: queue depth, eta per pending order, service time per product */
+#define MQTT_MENU_ITEM          "/menu/item"            /* message:  {"slot":0, "name":"LUNGO", "function":"make_coffee", "water":120}; without function clears the slot */
+#define MQTT_RECIPE_SET         "/recipe/set"           /* message:  {"id":0, "name":"LUNGO x2", "steps":[{"op":"press","function":"make_coffee"}, ...]}; without steps deletes */
+#define MQTT_RECIPE_RUN         "/recipe/run"           /* message:  recipe id, e.g. 0 */
+#define MQTT_RECIPE_LIST        "/recipe/list"          /* published: id, name and size of every stored recipe */
+#define MQTT_JITTER             "/diagnostics/jitter"   /* published: poll loop period and wake lateness (us), per window of polls */
+#define MQTT_CONNECTION         "/diagnostics/connection" /* published: machine link state (online, degraded, offline), outages and time offline */
+#define MQTT_NETWORK            "/diagnostics/network"  /* published: on each reconnect, time from loss to broker connected (last, max), attempts, cached access point used */
+#define MQTT_UART               "/diagnostics/uart"     /* published: character gap in use, shortest passing gap of the last calibration, fallbacks to the default */
+#define MQTT_UART_LANES         "/diagnostics/uart/lanes" /* published: transfers, waits (mean and max, us) and preempted reply waits per lane; display writes and writes saved */
+#define MQTT_MEMORY             "/diagnostics/memory"   /* published: heap, stack headroom per task, and with MEMORY_PROFILING the low water marks per code path */
+#define MQTT_LATENCY            "/latency"              /* published: at /latency/<function>, milestones of the last drink and p50/p90 of every stage */
+#define MQTT_RESEARCH_EEPROM    "/research/eeprom"      /* published: with EEPROM_SCANNER, words changed since boot and recent changes with the operational states they changed through */
+#define MQTT_RESEARCH_MEMORY    "/research/memory"      /* published: with WORKING_MEMORY_SCANNER, RM: words changed since boot, recent changes and watch points */
+#define MQTT_RESEARCH_MEMORY_WATCH "/research/memory/watch" /* message:  hex addresses read during dispenses, e.g. 1F,A4; empty clears */
+#define MQTT_BACKLOG            "/backlog"              /* published: after a broker outage, meter values (drink counters) in order and states coalesced or dropped */
+#define MQTT_PREHEAT            "/preheat"              /* published: first drink histogram, next preheat, latency with and without preheat */
 
 
 /*
@@ -77,6 +97,9 @@ enum class JuraServicePortCommand {
   FA_0B, /* ena micro 90 - make hot water */
   FA_0C,  /* ena micro 90 - make milk foam */
 
+  /* single eeprom words */
+  RE1F,   /* word 0x1F; changes with each rotary or center button press in menus */
+
   /* working memroy */
   RM00,
   RM01,
@@ -489,6 +512,16 @@ enum class JuraMachineStateIdentifier {
   BrewLimit, 
   MilkLimit, 
   WaterLimit,
+
+  /* BRIDGE DIAGNOSTICS */
+  BridgeFreeHeap,
+  BridgeMinimumFreeHeap,
+  BridgeLargestFreeBlock,
+  BridgeHeapFragmentation,
+  BridgeStackHeadroom,
+
+  /* number of identifiers; keep last */
+  Count
 };
 
 /* meta states */
@@ -544,18 +577,34 @@ enum class JuraMachineDispenseLimitType             { Water, Milk, Brew, None};
 enum class JuraMachineStateDataType                 { Boolean, Integer, String };
 enum class JuraMachineStateCategory                 { Config, Diagnostic };
 enum class JuraMachineDeviceClass                   { Opening, Problem, Door, Moving, Power, Running, None };
-enum class JuraMachineStateUnit                     { Preparation, Operation, Celcius, Milliliters, MicrolitersPerSecond, Grams, Seconds, Hours, Percent, Dose, Cycle, None};
+enum class JuraMachineStateUnit                     { Preparation, Operation, Celcius, Milliliters, MicrolitersPerSecond, Grams, Seconds, Hours, Percent, Dose, Cycle, Bytes, None};
 enum class JuraMachineStateIcon                     { Info, Coffee, Counter, Water, Alert, Check, Thermometer, Valve, Speedometer, Function};
 enum class JuraEntityEnabled                        { Yes, No };
 enum class JuraEntitySerialPrintable                { Yes, No };
 enum class JuraEntityNonvolatile                    { Yes, No };
 enum class JuraEntityAvailabilityFollowsReadyState  { Yes, No };
 
+/* sources polled through the service port; order matches JuraMachine::setPollRate */
+enum class JuraPollSource                           { IC, CS, HZ, RT0, RT1, RT2, RT4, RT5, RT7, RT8, RTA, RTD, EepromScan, WorkingMemoryScan, WorkingMemoryWatch, Count };
+
 /*characterizing operational states */
 enum class JuraMachineOperationalStateTemperatureType          { Steam, High, Normal, Low, Undeterminable};
 enum class JuraMachineOperationalStateFlowRateType             { Unrestricted, PressureBrew, Venturi, Undeterminable};
 enum class JuraMachineOperationalStateDispenseQuantityType     { Beverage, MilkRinse, BrewGroupRinse, FilterFlush, NoDispense, Undeterminable };
 
+/* poll plan entry; period is the modulus applied to the poll iterator */
+struct JuraPollPlanEntry {
+  JuraPollSource source;
+  int period;
+};
+
+/* poll plan for a single operational state */
+struct JuraPollPlan {
+  JuraMachineOperationalState state;
+  const JuraPollPlanEntry * entries;
+  int size;
+};
+
 /* configuration structure for tracked entities */
 struct JuraEntityConfiguration {
   JuraMachineStateIdentifier state;
@@ -622,10 +671,37 @@ struct JuraMachineFunctionEntityConfiguration {
   JuraMachineReadyState associatedReadyState;
 };
 
-struct JuraCustomMenuItemConfiguration {
-  const char name[255];
-  const char topic[255];
-  const char payload[255];
+/*
+
+  name:         JuraTask
+  type:         enum
+  description:  tasks created at boot; each has an entry in the task topology
+                table, JuraTaskConfigurations
+
+*/
+enum class JuraTask {
+  StatusLED = 0,
+  CustomMenu,
+  CommunicationsKeepAlive,
+  MessageWorker,
+  OrderWorker,
+  PreheatPlanner,
+  Rediscovery,
+  MachinePolling,
+};
+
+struct JuraTaskConfiguration {
+  JuraTask task;
+  const char name[32];
+  int core;             /* JURA_TASK_ANY_CORE: not pinned */
+  int priority;
+  int stack;            /* bytes */
+};
+
+/* working memory addresses scanned in order, inclusive */
+struct JuraWorkingMemoryRange {
+  int first;
+  int last;
 };
 
 #endif
\ No newline at end of file
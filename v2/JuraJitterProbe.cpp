@@ -0,0 +1,82 @@
+#include "JuraJitterProbe.h"
+#include <math.h>
+
+JuraJitterProbe::JuraJitterProbe() {
+  memset(&_report, 0, sizeof(_report));
+}
+
+void JuraJitterProbe::beforeDelay(unsigned long requestedMs){
+  _requested_us = requestedMs * 1000UL;
+  _delay_started = micros();
+}
+
+/***************************************************************************//**
+ * Sample one wake: lateness against the requested sleep and, if the previous
+ * wake was in the same run, the period. Running mean and variance (Welford).
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraJitterProbe::afterDelay(){
+  unsigned long now = micros();
+
+  int32_t late = (int32_t) (now - _delay_started - _requested_us);
+  _late_total += late;
+  if (_samples == 0 || late > _late_max){_late_max = late;}
+  if (late > JURA_POLL_JITTER_BOUND_US){_over_bound++;}
+  _samples++;
+
+  if (_last_wake != 0){
+    uint32_t period = now - _last_wake;
+    _periods++;
+    double delta = period - _period_mean;
+    _period_mean += delta / _periods;
+    _period_m2 += delta * (period - _period_mean);
+    if (period > _period_max){_period_max = period;}
+  }
+  _last_wake = now;
+
+  if (_samples >= JURA_POLL_JITTER_WINDOW){close();}
+}
+
+void JuraJitterProbe::pause(){
+  _last_wake = 0;
+}
+
+/* publishable copy of the window; the next one starts empty */
+void JuraJitterProbe::close(){
+  JuraJitterReport report;
+  report.sequence =         ++_sequence;
+  report.samples =          _samples;
+  report.periodMean =       (uint32_t) _period_mean;
+  report.periodDeviation =  _periods > 1 ? (uint32_t) sqrt(_period_m2 / (_periods - 1)) : 0;
+  report.periodMax =        _period_max;
+  report.lateMean =         (int32_t) (_late_total / _samples);
+  report.lateMax =          _late_max;
+  report.overBound =        _over_bound;
+  report.core =             xPortGetCoreID();
+  report.priority =         uxTaskPriorityGet(NULL);
+
+  portENTER_CRITICAL(&_lock);
+  _report = report;
+  _fresh = true;
+  portEXIT_CRITICAL(&_lock);
+
+  _samples = 0;
+  _periods = 0;
+  _period_mean = 0;
+  _period_m2 = 0;
+  _period_max = 0;
+  _late_total = 0;
+  _late_max = 0;
+  _over_bound = 0;
+}
+
+bool JuraJitterProbe::report(JuraJitterReport &report){
+  portENTER_CRITICAL(&_lock);
+  bool fresh = _fresh;
+  if (fresh){report = _report; _fresh = false;}
+  portEXIT_CRITICAL(&_lock);
+  return fresh;
+}
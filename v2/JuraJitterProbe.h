@@ -0,0 +1,68 @@
+#ifndef JURAJITTERPROBE_H
+#define JURAJITTERPROBE_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* one window of JURA_POLL_JITTER_WINDOW polls; all times in us */
+struct JuraJitterReport {
+  uint16_t sequence;
+  uint32_t samples;
+  uint32_t periodMean;      /* wake to wake, poll included */
+  uint32_t periodDeviation; /* standard deviation */
+  uint32_t periodMax;
+  int32_t  lateMean;        /* wake after the requested delay; slightly negative is tick rounding */
+  int32_t  lateMax;
+  uint32_t overBound;       /* wakes later than JURA_POLL_JITTER_BOUND_US */
+  int core;
+  int priority;
+};
+
+/*
+
+  name:         JuraJitterProbe
+  type:         class
+  description:  measures the poll loop from inside it. each sleep is bracketed,
+                so lateness isolates scheduling (preemption by higher priority
+                work on the same core) from the variable length of the poll
+                itself, which only shows in the period. a window is closed
+                every JURA_POLL_JITTER_WINDOW polls and kept until read.
+
+*/
+class JuraJitterProbe {
+public:
+  JuraJitterProbe();
+
+  /* around the sleep between polls */
+  void beforeDelay(unsigned long);
+  void afterDelay();
+
+  /* polling paused (custom menu); the next wake starts a fresh period */
+  void pause();
+
+  /* latest closed window; true once per window */
+  bool report(JuraJitterReport &);
+
+private:
+  unsigned long _delay_started = 0;
+  unsigned long _requested_us = 0;
+  unsigned long _last_wake = 0;
+
+  /* window in progress */
+  uint32_t _samples = 0;
+  uint32_t _periods = 0;
+  double _period_mean = 0;
+  double _period_m2 = 0;
+  uint32_t _period_max = 0;
+  int64_t _late_total = 0;
+  int32_t _late_max = 0;
+  uint32_t _over_bound = 0;
+
+  JuraJitterReport _report;
+  bool _fresh = false;
+  uint16_t _sequence = 0;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  void close();
+};
+
+#endif
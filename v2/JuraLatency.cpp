@@ -0,0 +1,172 @@
+#include "JuraLatency.h"
+
+JuraLatencyRecorder::JuraLatencyRecorder() {
+  memset(_traces, 0, sizeof(_traces));
+  memset(&_open, 0, sizeof(_open));
+}
+
+/* products only; settings and menu commands are not drinks */
+bool JuraLatencyRecorder::isTracked(JuraFunctionIdentifier function){
+  return function >= JuraFunctionIdentifier::MakeEspresso && function <= JuraFunctionIdentifier::MakeMilkFoam;
+}
+
+/* both stamps come from the same message, so receipt never follows dequeue */
+void JuraLatencyRecorder::received(JuraFunctionIdentifier function, unsigned long receivedAt, unsigned long dequeuedAt){
+  if (!isTracked(function)){return;}
+  portENTER_CRITICAL(&_lock);
+  _pending_received = receivedAt;
+  _pending_dequeued = dequeuedAt;
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Open a drink; receipt and dequeue stamps recent enough to have caused it are
+ * moved into it. Any drink in progress is dropped. Caller holds the lock.
+ *
+ * @param[out] null
+ *
+ * @param[in] uint8_t function
+ * @param[in] unsigned long now
+ ******************************************************************************/
+void JuraLatencyRecorder::open(uint8_t function, unsigned long now){
+  memset(&_open, 0, sizeof(_open));
+  _open.function = function;
+
+  if (_pending_received != 0 && now - _pending_received <= JURA_LATENCY_RECEIPT_WINDOW_MS){
+    _open.at[(int) JuraLatencyMilestone::Received] = _pending_received;
+    _open.at[(int) JuraLatencyMilestone::Dequeued] = _pending_dequeued;
+  }
+  _pending_received = 0;
+  _pending_dequeued = 0;
+  _is_open = true;
+}
+
+/***************************************************************************//**
+ * A product command was written to the service port.
+ *
+ * @param[out] null
+ *
+ * @param[in] JuraFunctionIdentifier function
+ * @param[in] unsigned long now
+ ******************************************************************************/
+void JuraLatencyRecorder::commandSent(JuraFunctionIdentifier function, unsigned long now){
+  if (!isTracked(function)){return;}
+
+  portENTER_CRITICAL(&_lock);
+  open((uint8_t) function, now);
+  _open.at[(int) JuraLatencyMilestone::CommandSent] = now;
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Mark a machine milestone on the drink in progress. Each is kept the first time
+ * it is reached, except the dispense end, which is the last. Ready falling opens
+ * a drink for a product selected on the machine unless a product command was
+ * sent just before it. Ready rising closes the drink; it is kept only if the
+ * pump ran or water flowed.
+ *
+ * @param[out] bool true if a drink was completed
+ *
+ * @param[in] JuraLatencyMilestone milestone
+ * @param[in] unsigned long now
+ ******************************************************************************/
+bool JuraLatencyRecorder::mark(JuraLatencyMilestone milestone, unsigned long now){
+  int m = (int) milestone;
+  bool completed = false;
+
+  portENTER_CRITICAL(&_lock);
+  if (milestone == JuraLatencyMilestone::Selected){
+    unsigned long command = _open.at[(int) JuraLatencyMilestone::CommandSent];
+    bool belongs = _is_open && (_open.at[m] != 0 || (command != 0 && now - command <= JURA_LATENCY_COMMAND_WINDOW_MS));
+    if (!belongs){open((uint8_t) JuraFunctionIdentifier::None, now);}
+  }
+
+  if (_is_open){
+    if (milestone == JuraLatencyMilestone::DispenseEnded || _open.at[m] == 0){_open.at[m] = now;}
+
+    if (milestone == JuraLatencyMilestone::Ready){
+      completed = _open.at[(int) JuraLatencyMilestone::PumpStarted] != 0 || _open.at[(int) JuraLatencyMilestone::FirstFlow] != 0;
+      if (completed){
+        _open.sequence = ++_sequence;
+        _traces[_head] = _open;
+        _head = (_head + 1) % JURA_LATENCY_HISTORY_SIZE;
+        if (_count < JURA_LATENCY_HISTORY_SIZE){_count++;}
+      }
+      _is_open = false;
+    }
+  }
+  portEXIT_CRITICAL(&_lock);
+  return completed;
+}
+
+bool JuraLatencyRecorder::latest(JuraLatencyTrace &trace){
+  portENTER_CRITICAL(&_lock);
+  bool found = _count > 0;
+  if (found){trace = _traces[(_head + JURA_LATENCY_HISTORY_SIZE - 1) % JURA_LATENCY_HISTORY_SIZE];}
+  portEXIT_CRITICAL(&_lock);
+  return found;
+}
+
+/***************************************************************************//**
+ * Median and 90th percentile of every stage, and of the whole drink, over the
+ * drinks of one product in the ring. A stage is skipped for a drink that did
+ * not reach its milestone, or reached none before it.
+ *
+ * @param[out] JuraLatencySummary &summary
+ *
+ * @param[in] uint8_t function
+ ******************************************************************************/
+void JuraLatencyRecorder::summarize(uint8_t function, JuraLatencySummary &summary){
+  unsigned long values[JURA_LATENCY_HISTORY_SIZE];
+  int last = JURA_LATENCY_MILESTONES - 1;
+  memset(&summary, 0, sizeof(summary));
+
+  /* stage m, and the total in the extra pass */
+  for (int m = 0; m <= JURA_LATENCY_MILESTONES; m++){
+    int n = 0;
+    int drinks = 0;
+
+    portENTER_CRITICAL(&_lock);
+    for (int i = 0; i < _count; i++){
+      const JuraLatencyTrace &trace = _traces[i];
+      if (trace.function != function){continue;}
+      drinks++;
+
+      int first = 0;
+      while (first < last && trace.at[first] == 0){first++;}
+
+      if (m == JURA_LATENCY_MILESTONES){
+        if (trace.at[last] != 0 && first < last){values[n++] = trace.at[last] - trace.at[first];}
+        continue;
+      }
+      if (trace.at[m] == 0 || m <= first){continue;}
+      int previous = m - 1;
+      while (trace.at[previous] == 0){previous--;}
+      values[n++] = trace.at[m] - trace.at[previous];
+    }
+    portEXIT_CRITICAL(&_lock);
+
+    summary.count = drinks;
+    if (m == JURA_LATENCY_MILESTONES){
+      summary.totalP50 = percentile(values, n, 50);
+      summary.totalP90 = percentile(values, n, 90);
+    }else{
+      summary.stageCount[m] = n;
+      summary.stageP50[m] = percentile(values, n, 50);
+      summary.stageP90[m] = percentile(values, n, 90);
+    }
+  }
+}
+
+/* nearest rank; sorts values in place */
+unsigned long JuraLatencyRecorder::percentile(unsigned long *values, int n, int p){
+  if (n == 0){return 0;}
+  for (int i = 1; i < n; i++){
+    unsigned long v = values[i];
+    int j = i - 1;
+    while (j >= 0 && values[j] > v){values[j + 1] = values[j]; j--;}
+    values[j + 1] = v;
+  }
+  int rank = (p * n + 99) / 100;
+  return values[rank > 0 ? rank - 1 : 0];
+}
@@ -0,0 +1,94 @@
+#ifndef JURALATENCY_H
+#define JURALATENCY_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* milestones of one drink, in the order they are expected */
+enum class JuraLatencyMilestone : uint8_t {
+  Received = 0,         /* mqtt message arrived */
+  Dequeued,             /* message worker picked it up */
+  CommandSent,          /* product command written to the service port */
+  Selected,             /* machine left ready */
+  GrinderStarted,
+  PumpStarted,
+  FirstFlow,            /* first volume change */
+  DispenseEnded,        /* last dispense settled */
+  Ready,                /* machine ready again; closes the drink */
+  Count
+};
+#define JURA_LATENCY_MILESTONES       ((int) JuraLatencyMilestone::Count)
+#define JURA_LATENCY_MILESTONE_NAMES  {"received", "dequeued", "command", "selected", "grinder", "pump", "flow", "dispensed", "ready"}
+
+/* one drink; at is millis, 0 if the milestone was not reached */
+struct JuraLatencyTrace {
+  uint16_t sequence;
+  uint8_t function;                         /* JuraFunctionIdentifier; None if selected on the machine */
+  unsigned long at[JURA_LATENCY_MILESTONES];
+};
+
+/* percentiles over the ring for one product; a stage ends at its milestone and starts at the one reached before it */
+struct JuraLatencySummary {
+  int count;
+  int stageCount[JURA_LATENCY_MILESTONES];
+  unsigned long stageP50[JURA_LATENCY_MILESTONES];
+  unsigned long stageP90[JURA_LATENCY_MILESTONES];
+  unsigned long totalP50;                   /* first milestone reached to ready */
+  unsigned long totalP90;
+};
+
+/*
+
+  name:         JuraLatencyRecorder
+  type:         class
+  description:  timestamps each drink from the mqtt message to the machine
+                being ready again. receipt and dequeue of a product topic's
+                message, both stamped on that message, are held as pending
+                until the product command opens a drink; a drink selected on the
+                machine opens one when ready falls. machine milestones are
+                marked from the event signaling at the end of every poll, so
+                they are accurate to one poll cycle.
+
+                completed drinks are kept in a ring; percentiles are computed
+                per product on request.
+
+*/
+class JuraLatencyRecorder {
+public:
+  JuraLatencyRecorder();
+
+  /* receipt and dequeue of the message that carries a product command; other functions are ignored */
+  void received(JuraFunctionIdentifier, unsigned long, unsigned long);
+
+  /* opens a drink for a product command; other functions are ignored */
+  void commandSent(JuraFunctionIdentifier, unsigned long);
+
+  /* machine milestones; Ready returns true if it completed a drink */
+  bool mark(JuraLatencyMilestone, unsigned long);
+
+  /* most recently completed drink; false if none */
+  bool latest(JuraLatencyTrace &);
+  void summarize(uint8_t, JuraLatencySummary &);
+
+  static bool isTracked(JuraFunctionIdentifier);
+
+private:
+  JuraLatencyTrace _traces[JURA_LATENCY_HISTORY_SIZE];
+  int _head = 0;
+  int _count = 0;
+  uint16_t _sequence = 0;
+
+  /* drink in progress */
+  JuraLatencyTrace _open;
+  bool _is_open = false;
+
+  /* not yet attributed to a drink */
+  unsigned long _pending_received = 0;
+  unsigned long _pending_dequeued = 0;
+
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  void open(uint8_t, unsigned long);
+  static unsigned long percentile(unsigned long *, int, int);
+};
+
+#endif
@@ -1,18 +1,10 @@
 #include "JuraBridge.h"
 #include "JuraMachine.h"
 
-/* set poll rates */
-#define POLL_MEMORY     -1
-#define POLL_DUTY_FULL  1
-#define POLL_DUTY_50    2
-#define POLL_DUTY_33    3
-#define POLL_DUTY_20    5
-#define POLL_DUTY_15    7
-#define POLL_DUTY_10    11
-#define POLL_DUTY_5     23
-#define POLL_DISABLED   101
-
-JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadyStateVariableSemaphoreRef) :  _bridge(&bridge), xMachineReadyStateVariableSemaphore(xMachineReadyStateVariableSemaphoreRef) {
+#include "JuraPollPlan.h"
+#include "JuraMemoryMonitor.h"
+
+JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadyStateVariableSemaphoreRef, EventGroupHandle_t &xMachineEventsRef) :  _bridge(&bridge), xMachineReadyStateVariableSemaphore(xMachineReadyStateVariableSemaphoreRef), xMachineEvents(xMachineEventsRef) {
 
   /* semaphore for dispense limit setting */
   xDispenseLimitSemaphore = xSemaphoreCreateBinary();
@@ -49,7 +41,6 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
   _cs.setCommand(JuraServicePortCommand::CS);
   
   /* system memory locations  */
-  //_rm00.setCommand(JuraServicePortCommand::RM00);
 
   /* known ignores */
   _cs.setBinIndexIgnore(SUBSTR_BIN_INDEX_UNKNOWN_MACHINE_CONFIGURATION_GROUP_1, 10);
@@ -68,8 +59,8 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
   */
 
   /* meta state */
-  states[(int) JuraMachineStateIdentifier::OperationalState] = (int) JuraMachineOperationalState::Starting;
-  states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::ExecutingOperation;
+  states.commit(JuraMachineStateIdentifier::OperationalState, (int) JuraMachineOperationalState::Starting);
+  states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::ExecutingOperation);
 
   /* fill operational state history */
   for (int i = 0; i < MAX_STATE_EVENT_HISTORY ; i++) {
@@ -135,23 +126,23 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
  * @param[out] bool 
  *     
  * @param[in] JuraMemoryLine *memoryLine,
- * @param[in] int *value, 
+ * @param[in] JuraMachineStateIdentifier state, 
  * @param[in] int value_index, 
  * @param[in] int min_val
  * @param[in] int max_val
  ******************************************************************************/
  bool JuraMachine::didUpdateJuraMemoryLineValue(
   JuraMemoryLine *memoryLine,
-  int *value, 
+  JuraMachineStateIdentifier state, 
   int value_index, 
   int min_val, 
   int max_val){
 
-  if (memoryLine->hasUpdateForIntegerValueOfServicePortResponseSubstringIndex(value_index)){
-    *value = filteredLong(
-      (int) memoryLine->checkIntegerValueOfServicePortResponseSubstringIndex(value_index), 
+  if (memoryLine->hasUpdateForDecimalValueOfServicePortResponseSubstringIndex(value_index)){
+    states.commit(state, filteredLong(
+      (int) memoryLine->returnDecimalValueOfServicePortResponseSubstringIndex(value_index), 
       min_val, 
-      max_val);
+      max_val));
 
     return true;
   }
@@ -164,20 +155,20 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
  *
  * @param[out] bool 
  *     
- * @param[in]   int *value, 
+ * @param[in]   JuraMachineStateIdentifier state, 
  * @param[in]   int value_index, 
  * @param[in]   int bits, 
  * @param[in]   JuraInputBoardBinaryResponseInterpretation _invert
  ******************************************************************************/
  bool JuraMachine::didUpdateJuraInputControlBoardValue(
-  int *value, 
+  JuraMachineStateIdentifier state, 
   int value_index, 
   int bits, 
   JuraInputBoardBinaryResponseInterpretation _invert) {
   /* check for update, if update set value at passed pointer */
   if (_ic.hasUpdateForValueOfServicePortResponseSubstringIndex(value_index, bits)){
     int raw = (int) _ic.returnValueOfServicePortResponseSubstringIndex(value_index, bits);
-    *value = (_invert == JuraInputBoardBinaryResponseInterpretation::Inverted) ? (!(bool) raw) : (int) raw;
+    states.commit(state, (_invert == JuraInputBoardBinaryResponseInterpretation::Inverted) ? (!(bool) raw) : (int) raw);
     return true;
   }
   return false;
@@ -189,14 +180,14 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
  *
  * @param[out] bool 
  *     
- * @param[in] int *value, 
+ * @param[in] JuraMachineStateIdentifier state, 
  * @param[in] int value_index, 
  * @param[in] int bits, 
  * @param[in] JuraSystemCircuitryBinaryResponseInterpretation _invert,
  * @param[in] JuraSystemCircuitryResponseDataType _valueTyp
  ******************************************************************************/
  bool JuraMachine::didUpdateJuraSystemCircuitValue(
-  int *value, 
+  JuraMachineStateIdentifier state, 
   int value_index, 
   int bits, 
   JuraSystemCircuitryBinaryResponseInterpretation _invert,
@@ -208,7 +199,7 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
     /* check for update in change of value */
     if (_cs.hasUpdateForDecimalValueOfServicePortResponseSubstringIndex(value_index)){
       int raw = (int) _cs.returnDecimalValueOfServicePortResponseSubstringIndex(value_index);
-      *value = raw;
+      states.commit(state, raw);
       return true;
     } 
 
@@ -216,7 +207,7 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
     /* check for update, if update set value at passed pointer */
     if (_cs.hasUpdateForValueOfServicePortResponseSubstringIndex(value_index, bits)){
       int raw = (int) _cs.returnValueOfServicePortResponseSubstringIndex(value_index, bits);
-      *value = (_invert == JuraSystemCircuitryBinaryResponseInterpretation::Inverted) ? (!(bool) raw) : (int) raw;
+      states.commit(state, (_invert == JuraSystemCircuitryBinaryResponseInterpretation::Inverted) ? (!(bool) raw) : (int) raw);
       return true;
     }
 
@@ -224,7 +215,7 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
     /* check for update, if update set value at passed pointer */
     if (_cs.hasUpdateForValueOfServicePortResponseSubstringIndex(value_index, bits)){
       int raw = (int) _cs.returnHammingValueOfServicePortResponseSubstringIndex(value_index, bits);
-      *value = raw;
+      states.commit(state, raw);
       return true;
     }
   }
@@ -237,27 +228,48 @@ JuraMachine::JuraMachine(JuraBridge& bridge, SemaphoreHandle_t &xMachineReadySta
  *
  * @param[out] bool 
  *     
- * @param[in] int *value, 
+ * @param[in] JuraMachineStateIdentifier state, 
  * @param[in] int value_index, 
  * @param[in] int min_val
  * @param[in] int max_val
  ******************************************************************************/
  bool JuraMachine::didUpdateJuraHeatedBeverageValue(
-  int *value, 
+  JuraMachineStateIdentifier state, 
   int value_index, 
   int min_val, 
   int max_val){
-  if (_hz.hasUpdateForValueOfServicePortResponseSubstringIndex(value_index)){
-    *value = filteredLong(
-      (int) _hz.returnValueOfServicePortResponseSubstringIndex(value_index), 
+  if (_hz.hasUpdateForDecimalValueOfServicePortResponseSubstringIndex(value_index)){
+    states.commit(state, filteredLong(
+      (int) _hz.returnDecimalValueOfServicePortResponseSubstringIndex(value_index), 
       min_val, 
-      max_val);
+      max_val));
 
     return true;
   }
   return false;
 }
 
+/***************************************************************************//**
+ * The machine stopped answering (powered off or unplugged). Report it as
+ * disconnected and not ready; waiters see ready fall. The first poll after it
+ * answers again derives the operational state afresh.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/
+void JuraMachine::markDisconnected(){
+  ESP_LOGI(TAG,"--> Machine State: DISCONNECTED");
+  _bridge->machineStateStringChanged(JuraMachineStateIdentifier::OperationalState, "DISCONNECTED", (int) JuraMachineOperationalState::Disconnected);
+
+  xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
+  states.commit(JuraMachineStateIdentifier::OperationalState, (int) JuraMachineOperationalState::Disconnected);
+  states.commit(JuraMachineStateIdentifier::SystemIsReady, false);
+  _bridge->machineStateChanged(JuraMachineStateIdentifier::SystemIsReady, states[(int) JuraMachineStateIdentifier::SystemIsReady]);
+  signalMachineEvents();
+  xSemaphoreGive(xMachineReadyStateVariableSemaphore);
+}
+
 /***************************************************************************//**
  * Sampler from generator-esque input to determine whether aggregate
  * reocmmendation state has changed
@@ -277,8 +289,8 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
   
   if (priorState != newState){
     /* update the maintenence recommendation */
-    states[(int) JuraMachineStateIdentifier::HasMaintenanceRecommendation] = newState;
-    last_changed[(int) JuraMachineStateIdentifier::HasMaintenanceRecommendation] = millis();
+    states.commit(JuraMachineStateIdentifier::HasMaintenanceRecommendation, newState);
+    states.touch(JuraMachineStateIdentifier::HasMaintenanceRecommendation, millis());
     return true; 
   }
   return false; 
@@ -307,7 +319,7 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
     states[(int) JuraMachineStateIdentifier::DrainageTrayRemoved] == true);
 
   if (_has_hardware_error != states[(int) JuraMachineStateIdentifier::HasError]){
-    states[(int) JuraMachineStateIdentifier::HasError] = _has_hardware_error;
+    states.commit(JuraMachineStateIdentifier::HasError, _has_hardware_error);
     return true;
   }
   return false;
@@ -333,7 +345,7 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
 
   if ( states[(int) JuraMachineStateIdentifier::GrinderActive] == true ){
     //ESP_LOGI(TAG,"---> Machine State: Grinding ");
-    states[(int) JuraMachineStateIdentifier::HasDose] = true;
+    states.commit(JuraMachineStateIdentifier::HasDose, true);
     new_state = JuraMachineOperationalState::GrindOperation; 
 
   } else if ( states[(int) JuraMachineStateIdentifier::BrewProgramIsCleaning] == true ){
@@ -580,11 +592,11 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
 
           /* reset after at leaset 45 seconds  */
           if (
-            (timenow - last_changed[(int) JuraMachineStateIdentifier::OperationalState] > (1000 * JURA_MACHINE_AWAIT_NEXT_INSTRUCTION_TIMEOUT_S)) && 
+            (timenow - states.lastChanged(JuraMachineStateIdentifier::OperationalState) > (1000 * JURA_MACHINE_AWAIT_NEXT_INSTRUCTION_TIMEOUT_S)) && 
             (states[(int) JuraMachineStateIdentifier::ReadyStateDetail] != (int) JuraMachineReadyState::ReadyForNext)
             ){
             //ESP_LOGI(TAG,"----> Machine Operation:AWAITING NEXT INSTRUCTION");      
-            states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::ReadyForNext;
+            states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::ReadyForNext);
             _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "AWAITING NEXT INSTRUCTION", (int) JuraMachineReadyState::ReadyForNext);
           
             /* reset machine dispense limits */
@@ -593,17 +605,18 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
           }
 
           /* ------------------- below here we perform tasks automatically on idle ------------------- */
-          if (/* if ready for at least x minutes */
+          if (/* if ready for at least x minutes, and no orders are being served */
+            !_maintenance_held &&
             (states[(int) JuraMachineStateIdentifier::OperationalState] == (int) JuraMachineOperationalState::Ready) && 
-            (timenow - last_changed[(int) JuraMachineStateIdentifier::OperationalState] > JURA_MACHINE_AUTOMATIC_MAINTENANCE_TIMEOUT_S * 1000) ){
+            (timenow - states.lastChanged(JuraMachineStateIdentifier::OperationalState) > JURA_MACHINE_AUTOMATIC_MAINTENANCE_TIMEOUT_S * 1000) ){
 
             /* ready state has been milk rinse required for N minutes? */
             if (states[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] == true){
 
               /* wait for five minutes, thereafter rinse milk */
-              if (timenow - last_changed[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] > JURA_MACHINE_AUTOMATIC_MILK_RINSE_TIMEOUT_S * 1000){
+              if (timenow - states.lastChanged(JuraMachineStateIdentifier::RinseMilkSystemRecommended) > JURA_MACHINE_AUTOMATIC_MILK_RINSE_TIMEOUT_S * 1000){
                 _bridge->instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::ConfirmDisplayPrompt);
-                last_changed[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] = timenow;
+                states.touch(JuraMachineStateIdentifier::RinseMilkSystemRecommended, timenow);
               }
             }
 
@@ -611,19 +624,19 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
             if (states[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended] == true){
 
               /* wait for five minutes, thereafter rinse milk */
-              if (timenow - last_changed[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended] > JURA_MACHINE_AUTOMATIC_BREW_GROUP_RINSE_TIMEOUT_S * 1000){
+              if (timenow - states.lastChanged(JuraMachineStateIdentifier::RinseBrewGroupRecommended) > JURA_MACHINE_AUTOMATIC_BREW_GROUP_RINSE_TIMEOUT_S * 1000){
                _bridge->publishRinseRequest();
-                last_changed[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended] = timenow;
+                states.touch(JuraMachineStateIdentifier::RinseBrewGroupRecommended, timenow);
               }
             }
 
             /* limits resets! */
             if (states[(int) JuraMachineStateIdentifier::WaterLimit] > 0 || states[(int) JuraMachineStateIdentifier::BrewLimit] > 0  || states[(int) JuraMachineStateIdentifier::MilkLimit] > 0 ){
-              if (timenow - last_changed[(int) JuraMachineStateIdentifier::WaterLimit] > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
+              if (timenow - states.lastChanged(JuraMachineStateIdentifier::WaterLimit) > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
                 resetDispenseLimits();
-              }else if (timenow - last_changed[(int) JuraMachineStateIdentifier::BrewLimit] > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
+              }else if (timenow - states.lastChanged(JuraMachineStateIdentifier::BrewLimit) > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
                 resetDispenseLimits();
-              }else if (timenow - last_changed[(int) JuraMachineStateIdentifier::MilkLimit] > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
+              }else if (timenow - states.lastChanged(JuraMachineStateIdentifier::MilkLimit) > JURA_MACHINE_AUTOMATIC_DISPENSE_LIMIT_TIMEOUT_S * 1000){
                 resetDispenseLimits();
               }
             }
@@ -632,7 +645,7 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
       }
 
       //set last chagned
-      last_changed[(int) JuraMachineStateIdentifier::OperationalState] = timenow;
+      states.touch(JuraMachineStateIdentifier::OperationalState, timenow);
 
       /* shift history array */
       pushElement(dispenseHistory, MAX_STATE_EVENT_HISTORY, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]);
@@ -646,7 +659,7 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
 
       /* set new operational state; semaphore protected */
       xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
-      states[(int) JuraMachineStateIdentifier::OperationalState] = (int) new_state;
+      states.commit(JuraMachineStateIdentifier::OperationalState, (int) new_state);
       pushElement(operationalStateHistory, MAX_STATE_EVENT_HISTORY, states[(int) JuraMachineStateIdentifier::OperationalState]);
       xSemaphoreGive( xMachineReadyStateVariableSemaphore);
       return true; 
@@ -691,7 +704,7 @@ bool JuraMachine::recommendationStateHasChanged(int iterator, int duty_cycle){
 
   /* full calcualted value of flow only outputs if true */
   if ( (!_not_flowing) != states[(int) JuraMachineStateIdentifier::FlowState]){
-    states[(int) JuraMachineStateIdentifier::FlowState] = (! _not_flowing);
+    states.commit(JuraMachineStateIdentifier::FlowState, (! _not_flowing));
     return true; 
   }
   return false; 
@@ -760,13 +773,109 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
  ******************************************************************************/ 
  void JuraMachine::startAddShotPreparation(){
     pushElement(operationalStateHistory, MAX_STATE_EVENT_HISTORY, (int) JuraMachineOperationalState::AddShotCommand);
-    states[(int) JuraMachineStateIdentifier::OperationalState] = (int) JuraMachineOperationalState::AddShotCommand;
+    states.commit(JuraMachineStateIdentifier::OperationalState, (int) JuraMachineOperationalState::AddShotCommand);
     
     xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
-    states[(int) JuraMachineStateIdentifier::SystemIsReady] = false; 
+    states.commit(JuraMachineStateIdentifier::SystemIsReady, false); 
+    signalMachineEvents();
     xSemaphoreGive(xMachineReadyStateVariableSemaphore);
  }
 
+/***************************************************************************//**
+ * Compare one level with what was last signaled. On change, the matching level
+ * bit replaces its complement and the rising or falling edge bit is set; no edge
+ * is reported for the first signal after boot. Zero bits are skipped.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] int level
+ * @param[in] int &signaled
+ * @param[in] EventBits_t onBit, offBit, roseBit, fellBit
+ * @param[out] EventBits_t &setBits, &clearBits
+ ******************************************************************************/ 
+ void JuraMachine::signalMachineEventLevel(
+  int level, 
+  int &signaled, 
+  EventBits_t onBit, 
+  EventBits_t offBit, 
+  EventBits_t roseBit, 
+  EventBits_t fellBit, 
+  EventBits_t &setBits, 
+  EventBits_t &clearBits){
+
+  if (level == signaled){return;}
+  if (signaled != -1){setBits |= level ? roseBit : fellBit;}
+  setBits |= level ? onBit : offBit;
+  clearBits |= level ? offBit : onBit;
+  signaled = level;
+ }
+
+/***************************************************************************//**
+ * Update the machine event group from readiness, pump, brew group, dispense and
+ * error states. Level bits are set in complementary pairs so waiters can block
+ * on either; edge bits are set here and cleared by waiters. Called at the end of
+ * every poll, so waiters wake within one poll cycle of a change. Caller holds
+ * xMachineReadyStateVariableSemaphore.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/ 
+ void JuraMachine::signalMachineEvents(){
+  EventBits_t setBits = 0;
+  EventBits_t clearBits = 0;
+
+  signalMachineEventLevel(states[(int) JuraMachineStateIdentifier::SystemIsReady] ? 1 : 0, _signaled_ready, 
+    MACHINE_EVENT_READY, MACHINE_EVENT_NOT_READY, MACHINE_EVENT_READY_ROSE, MACHINE_EVENT_READY_FELL, setBits, clearBits);
+
+  signalMachineEventLevel(states[(int) JuraMachineStateIdentifier::PumpActive] ? 1 : 0, _signaled_pump, 
+    MACHINE_EVENT_PUMP_ON, MACHINE_EVENT_PUMP_OFF, MACHINE_EVENT_PUMP_STARTED, MACHINE_EVENT_PUMP_STOPPED, setBits, clearBits);
+
+  signalMachineEventLevel(states[(int) JuraMachineStateIdentifier::BrewGroupIsReady] ? 1 : 0, _signaled_brew_group_ready, 
+    MACHINE_EVENT_BREW_GROUP_READY, 0, 0, 0, setBits, clearBits);
+
+  /* a dispense runs while the pump is on and the flow meter is turning */
+  bool dispensing = states[(int) JuraMachineStateIdentifier::PumpActive] && states[(int) JuraMachineStateIdentifier::FlowState];
+  signalMachineEventLevel(dispensing ? 1 : 0, _signaled_dispensing, 
+    MACHINE_EVENT_DISPENSING, MACHINE_EVENT_NOT_DISPENSING, MACHINE_EVENT_DISPENSE_STARTED, MACHINE_EVENT_DISPENSE_STOPPED, setBits, clearBits);
+
+  signalMachineEventLevel(states[(int) JuraMachineStateIdentifier::HasError] ? 1 : 0, _signaled_error, 
+    MACHINE_EVENT_ERROR, MACHINE_EVENT_NO_ERROR, MACHINE_EVENT_ERROR_RAISED, MACHINE_EVENT_ERROR_CLEARED, setBits, clearBits);
+
+  /* drink milestones from the same edges */
+  unsigned long now = millis();
+  if (setBits & MACHINE_EVENT_READY_FELL)       {latency.mark(JuraLatencyMilestone::Selected, now);}
+  if (states[(int) JuraMachineStateIdentifier::GrinderActive]) {latency.mark(JuraLatencyMilestone::GrinderStarted, now);}
+  if (setBits & MACHINE_EVENT_PUMP_STARTED)     {latency.mark(JuraLatencyMilestone::PumpStarted, now);}
+  if (setBits & MACHINE_EVENT_DISPENSE_STARTED) {latency.mark(JuraLatencyMilestone::FirstFlow, now);}
+  if (setBits & MACHINE_EVENT_DISPENSE_STOPPED) {latency.mark(JuraLatencyMilestone::DispenseEnded, now);}
+  if (setBits & MACHINE_EVENT_READY_ROSE)       {_latency_completed |= latency.mark(JuraLatencyMilestone::Ready, now);}
+
+  /* each dispense gets its own shot profile; opened on the poll task, which owns the recorder */
+  if (setBits & MACHINE_EVENT_DISPENSE_STARTED) {_shot_profile_start_at = now;}
+
+  if (clearBits){xEventGroupClearBits(xMachineEvents, clearBits);}
+  if (setBits){xEventGroupSetBits(xMachineEvents, setBits);}
+ }
+
+/***************************************************************************//**
+ * Block the calling task until machine events are set
+ *
+ * @param[out] EventBits_t bits set at return; compare against the request for timeout
+ *     
+ * @param[in] EventBits_t bits
+ * @param[in] bool waitForAll
+ * @param[in] int timeout (ms); MACHINE_EVENT_WAIT_FOREVER to block indefinitely
+ ******************************************************************************/ 
+ EventBits_t JuraMachine::awaitMachineEvents(EventBits_t bits, bool waitForAll, int timeout){
+  TickType_t ticks = (timeout == MACHINE_EVENT_WAIT_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(timeout);
+  return xEventGroupWaitBits(xMachineEvents, bits, pdFALSE, waitForAll ? pdTRUE : pdFALSE, ticks);
+ }
+
+ void JuraMachine::clearMachineEvents(EventBits_t bits){
+  xEventGroupClearBits(xMachineEvents, bits);
+ }
+
 /***************************************************************************//**
  * Parse through recent history to determine what preceded current ready state
  *
@@ -878,37 +987,30 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     handlePoll(POLL_MEMORY);
   }
 
-  /* determine what states have recently changed among important states to monitor */
-  int stateAttributeArraySize = sizeof(JuraEntityConfigurations) / sizeof(JuraEntityConfigurations[0]) ; 
-
-  /* iterate through all of the machine state attributes */
-  int nowTime = millis();
-  for (int i = 0; i < stateAttributeArraySize ; i++){
-    int index = (int) JuraEntityConfigurations[i].state;
-    if (last_changed[index] != 0 ){
-      if(nowTime - last_changed[index] < 15000){ /* has this value changed in the last 15 seconds? */
-        didUpdateNumEspresso = (index == (int) JuraMachineStateIdentifier::NumEspresso)? true : didUpdateNumEspresso;
-        didUpdateNumCoffee = ( index == (int) JuraMachineStateIdentifier::NumCoffee)? true : didUpdateNumCoffee;
-        didUpdateNumCappuccino = ( index == (int) JuraMachineStateIdentifier::NumCappuccino)? true : didUpdateNumCappuccino;
-        didUpdateNumMacchiato = ( index == (int) JuraMachineStateIdentifier::NumMacchiato)? true : didUpdateNumMacchiato;
-        didUpdateNumPreground = ( index == (int) JuraMachineStateIdentifier::NumPreground)? true : didUpdateNumPreground;
-        didUpdateNumBrewGroupCleanSystemOperations = ( index == (int) JuraMachineStateIdentifier::NumBrewGroupCleanOperations)? true : didUpdateNumBrewGroupCleanSystemOperations;
-        didUpdateNumSpentGrounds = ( index == (int) JuraMachineStateIdentifier::NumSpentGrounds)? true : didUpdateNumSpentGrounds;
-        didUpdateNumMilkFoamPreparations = ( index == (int) JuraMachineStateIdentifier::NumMilkFoamPreparations)? true : didUpdateNumMilkFoamPreparations;
-        didUpdateNumWaterPreparations = ( index == (int) JuraMachineStateIdentifier::NumWaterPreparations)? true : didUpdateNumWaterPreparations;
-        didUpdateNumGrinderOperations = ( index == (int) JuraMachineStateIdentifier::NumGrinderOperations)? true : didUpdateNumGrinderOperations;
-        didUpdateNumCleanMilkSystemOperations = ( index == (int) JuraMachineStateIdentifier::NumCleanMilkSystemOperations)? true : didUpdateNumCleanMilkSystemOperations;
-
-        /* error fixes */
-        drainageTrayFullErrorFixed = (index == (int) JuraMachineStateIdentifier::DrainageTrayFull) ? true : drainageTrayFullErrorFixed;
-        beanHopperEmptyErrorFixed = (index == (int) JuraMachineStateIdentifier::BeanHopperEmpty) ? true  : beanHopperEmptyErrorFixed;
-        beanHopperCoverOpenErrorFixed = (index == (int) JuraMachineStateIdentifier::BeanHopperCoverOpen) ? true  : beanHopperCoverOpenErrorFixed;
-        waterReservoirNeedsFillErrorFixed = (index == (int) JuraMachineStateIdentifier::WaterReservoirNeedsFill) ? true  : waterReservoirNeedsFillErrorFixed;
-        bypassDoserDoorOpenErrorFixed = (index == (int) JuraMachineStateIdentifier::BypassDoserCoverOpen) ? true  : bypassDoserDoorOpenErrorFixed;
-        drainageTrayRemovedErrorFixed = (index == (int) JuraMachineStateIdentifier::DrainageTrayRemoved) ? true : drainageTrayRemovedErrorFixed;
-      }
-    }
-  }
+  /* determine what states have recently changed among important states to monitor; walks only the recent changes */
+  uint32_t recentlyChanged[STATE_STORE_WORDS];
+  states.changedWithin(JURA_MACHINE_RECENT_CHANGE_WINDOW_MS, millis(), recentlyChanged);
+
+  /* counters */
+  didUpdateNumEspresso = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumEspresso);
+  didUpdateNumCoffee = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumCoffee);
+  didUpdateNumCappuccino = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumCappuccino);
+  didUpdateNumMacchiato = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumMacchiato);
+  didUpdateNumPreground = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumPreground);
+  didUpdateNumBrewGroupCleanSystemOperations = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumBrewGroupCleanOperations);
+  didUpdateNumSpentGrounds = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumSpentGrounds);
+  didUpdateNumMilkFoamPreparations = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumMilkFoamPreparations);
+  didUpdateNumWaterPreparations = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumWaterPreparations);
+  didUpdateNumGrinderOperations = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumGrinderOperations);
+  didUpdateNumCleanMilkSystemOperations = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::NumCleanMilkSystemOperations);
+
+  /* error fixes */
+  drainageTrayFullErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::DrainageTrayFull);
+  beanHopperEmptyErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::BeanHopperEmpty);
+  beanHopperCoverOpenErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::BeanHopperCoverOpen);
+  waterReservoirNeedsFillErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::WaterReservoirNeedsFill);
+  bypassDoserDoorOpenErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::BypassDoserCoverOpen);
+  drainageTrayRemovedErrorFixed = JuraStateStore::inMask(recentlyChanged, JuraMachineStateIdentifier::DrainageTrayRemoved);
 
   /* flow characterizations: flow rate */
   JuraMachineOperationalStateFlowRateType brewFlowType = brewGroupOperationOccurred ? characterizeFlowRate(flowRateHistory[brewGroupDispenseIndex]) : JuraMachineOperationalStateFlowRateType::Undeterminable;
@@ -940,32 +1042,32 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
   /* determine what happened the last dispense */
   if (startupOccurred){
     //ESP_LOGI(TAG,"----> Machine Operation: BRIDGE STARTED");
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::BridgeStarted;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::BridgeStarted);
     _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "BRIDGE STARTED", (int) JuraMachineReadyState::BridgeStarted); didSetDetail = true;
 
   } else if (blockingErrorOccurred){
 
     if (beanHopperEmptyErrorFixed || beanHopperCoverOpenErrorFixed){
       //ESP_LOGI(TAG,"----> Machine Operation: FILLED BEANS");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::FilledBeans;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::FilledBeans);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "FILLED BEANS", (int) JuraMachineReadyState::FilledBeans); didSetDetail = true;
     }
     
     if (waterReservoirNeedsFillErrorFixed){
       //ESP_LOGI(TAG,"----> Machine Operation: FILLED WATER");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::FilledWater ;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::FilledWater );
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "FILLED WATER", (int) JuraMachineReadyState::FilledWater); didSetDetail = true;
     }
 
     if (bypassDoserDoorOpenErrorFixed){
       //ESP_LOGI(TAG,"----> Machine Operation: CLOSED BYPASS DOSER DOOR");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::ClosedBypassDoserDoor;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::ClosedBypassDoserDoor);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "CLOSED BYPASS DOSER DOOR", (int) JuraMachineReadyState::ClosedBypassDoserDoor); didSetDetail = true;
     }
     /* specific corrected error */
     if (drainageTrayFullErrorFixed || drainageTrayRemovedErrorFixed){
       //ESP_LOGI(TAG,"----> Machine Operation: REPLACED EMPTY TRAY AND KNOCKBOX");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::ReplacedDrainageTrayAndEmptyKnockbox;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::ReplacedDrainageTrayAndEmptyKnockbox);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "REPLACED DRAINAGE TRAY AND EMPTIED KNOCKBOX", (int) JuraMachineReadyState::ReplacedDrainageTrayAndEmptyKnockbox); didSetDetail = true;
     }
 
@@ -978,7 +1080,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
 
     /* bean hopper empty */
     doserIsEmpty = true; 
-    states[(int) JuraMachineStateIdentifier::BeanHopperEmpty] = true; 
+    states.commit(JuraMachineStateIdentifier::BeanHopperEmpty, true); 
     _bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperEmpty, states[(int) JuraMachineStateIdentifier::BeanHopperEmpty]);
     return;
 
@@ -988,7 +1090,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     doserIsEmpty = true; 
 
     /* quantity */
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::EspressoReady;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::EspressoReady);
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::EspressoReady); didSetDetail = true;
     }else if (brewGroupDispense < 30){
@@ -1002,7 +1104,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
   } else if (didUpdateNumCoffee){ 
     //ESP_LOGI(TAG,"----> Machine Operation: COFFEE READY"); 
     doserIsEmpty = true; 
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::CoffeeReady ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::CoffeeReady );
 
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::EspressoReady); didSetDetail = true;
@@ -1019,7 +1121,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     //ESP_LOGI(TAG,"----> Machine Operation: CAPPUCCINO READY"); 
     doserIsEmpty = true; 
     triggersMilkRinse = true;
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::CappuccinoReady ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::CappuccinoReady );
 
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::CappuccinoReady); didSetDetail = true;
@@ -1032,7 +1134,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     //ESP_LOGI(TAG,"----> Machine Operation: MACCIATTO READY"); 
     doserIsEmpty = true; 
     triggersMilkRinse = true;
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::MacciattoReady ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::MacciattoReady );
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::MacciattoReady); didSetDetail = true;
     }else{
@@ -1043,7 +1145,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     //ESP_LOGI(TAG,"----> Machine Operation: MILK FOAM READY");  
     doserIsEmpty = true; 
     triggersMilkRinse = true;
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::MilkFoamReady ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::MilkFoamReady );
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::MilkFoamReady); didSetDetail = true;
     }else if (brewGroupDispense < 60){
@@ -1056,7 +1158,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
 
   } else if (didUpdateNumWaterPreparations){
     //ESP_LOGI(TAG,"----> Machine Operation: HOT WATER READY"); 
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::HotWaterReady ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::HotWaterReady );
     if (addShotCommand){
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "PREPARING NEXT SHOT", (int) JuraMachineReadyState::HotWaterReady); didSetDetail = true;
     }else{
@@ -1067,14 +1169,14 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     /* brew group clean operation performed */
     //ESP_LOGI(TAG,"----> Machine Operation: CLEAN BREW GROUP COMPLETE"); 
     doserIsEmpty = true; 
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::CleanBrewGroupComplete ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::CleanBrewGroupComplete );
     _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "CLEAN BREW GROUP COMPLETE", (int) JuraMachineReadyState::CleanBrewGroupComplete); didSetDetail = true;
 
   } else if (rinseOperationOccurred && brewGroupOperationOccurred && !grindOperationOccurred) { 
     /* rinse operation  */
     //ESP_LOGI(TAG,"----> Machine Operation: RINSE BREW GROUP COMPLETE");  
     doserIsEmpty = true; 
-    states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::RinseBrewGroupComplete ;
+    states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::RinseBrewGroupComplete );
     _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "RINSE BREW GROUP COMPLETE", (int) JuraMachineReadyState::RinseBrewGroupComplete); didSetDetail = true;
 
   } else if ( /* nothing related to coffee preparation, only relating to milk preparation */
@@ -1085,14 +1187,14 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
     /* milk clean operation here! */
     if (userWaitOperationOccurred || didUpdateNumCleanMilkSystemOperations){
       //ESP_LOGI(TAG,"----> Machine Operation: CLEAN MILK SYSTEM COMPLETE");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::CleanMilkSystemComplete ;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::CleanMilkSystemComplete );
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "CLEAN MILK SYSTEM COMPLETE", (int) JuraMachineReadyState::CleanMilkSystemComplete); didSetDetail = true;
       clearMilkClean = true; 
       clearMilkRinse = true; 
 
     }else{
       //ESP_LOGI(TAG,"----> Machine Operation: RINSE MILK SYSTEM COMPLETE");
-      states[(int) JuraMachineStateIdentifier::ReadyStateDetail] = (int) JuraMachineReadyState::RinseMilkSystemComplete ;
+      states.commit(JuraMachineStateIdentifier::ReadyStateDetail, (int) JuraMachineReadyState::RinseMilkSystemComplete );
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::ReadyStateDetail, "RINSE MILK SYSTEM COMPLETE", (int) JuraMachineReadyState::RinseMilkSystemComplete); didSetDetail = true;
       clearMilkRinse = true;
     }
@@ -1105,18 +1207,18 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
   /* ------------------------------------------------------------------------------------------ */
   /* reset dosing, if a dose has been dosed */
   if (doserIsEmpty){
-    states[(int) JuraMachineStateIdentifier::HasDose] = false;
+    states.commit(JuraMachineStateIdentifier::HasDose, false);
     _bridge->machineStateChanged(JuraMachineStateIdentifier::HasDose ,false);
   }
 
   /* if we need to rinse the milk system, raise the flags! */
   if (triggersMilkRinse){
     /* milk clean & rinse flags */
-    states[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] = true;  
-    states[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended] = true;
+    states.commit(JuraMachineStateIdentifier::RinseMilkSystemRecommended, true);  
+    states.commit(JuraMachineStateIdentifier::CleanMilkSystemRecommended, true);
     
-    last_changed[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] = millis();
-    last_changed[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended] = millis();
+    states.touch(JuraMachineStateIdentifier::RinseMilkSystemRecommended, millis());
+    states.touch(JuraMachineStateIdentifier::CleanMilkSystemRecommended, millis());
 
     _bridge->machineStateChanged(JuraMachineStateIdentifier::RinseMilkSystemRecommended, states[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended]);
     _bridge->machineStateChanged(JuraMachineStateIdentifier::CleanMilkSystemRecommended, states[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended]);
@@ -1125,13 +1227,13 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
 
     /* clear these flags when completed */
     if (clearMilkRinse){
-      states[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] = false;  
-      last_changed[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended] = millis();
+      states.commit(JuraMachineStateIdentifier::RinseMilkSystemRecommended, false);  
+      states.touch(JuraMachineStateIdentifier::RinseMilkSystemRecommended, millis());
       _bridge->machineStateChanged(JuraMachineStateIdentifier::RinseMilkSystemRecommended, states[(int) JuraMachineStateIdentifier::RinseMilkSystemRecommended]);
     }
     if (clearMilkClean){
-      states[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended] = false;
-      last_changed[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended] = millis();
+      states.commit(JuraMachineStateIdentifier::CleanMilkSystemRecommended, false);
+      states.touch(JuraMachineStateIdentifier::CleanMilkSystemRecommended, millis());
       _bridge->machineStateChanged(JuraMachineStateIdentifier::CleanMilkSystemRecommended, states[(int) JuraMachineStateIdentifier::CleanMilkSystemRecommended]);
     }      
   }
@@ -1153,7 +1255,7 @@ JuraMachineOperationalStateDispenseQuantityType JuraMachine::characterizeDispens
 
   if (states[(int) JuraMachineStateIdentifier::ReadyStateDetail] != (int) JuraMachineReadyState::ExecutingOperation || startupOccurred){
     /* this is the only place we set ready! */
-    states[(int) JuraMachineStateIdentifier::OperationalState] = (int) JuraMachineOperationalState::Ready;
+    states.commit(JuraMachineStateIdentifier::OperationalState, (int) JuraMachineOperationalState::Ready);
     _bridge->machineStateStringChanged(JuraMachineStateIdentifier::OperationalState, "READY", states[(int) JuraMachineStateIdentifier::OperationalState]);
   }else{
     return;
@@ -1185,19 +1287,19 @@ void JuraMachine::setDispenseLimit(int dispenseMax, JuraMachineDispenseLimitType
   /* must be greater than zero; must be greater than 15ml and less than 300 ml */
   switch (limitType ){
     case JuraMachineDispenseLimitType::Brew:
-      states[(int)JuraMachineStateIdentifier::BrewLimit] = (dispenseMax >= 15 && dispenseMax < 65) ? dispenseMax : 0 ;
+      states.commit(JuraMachineStateIdentifier::BrewLimit, (dispenseMax >= 15 && dispenseMax < 65) ? dispenseMax : 0 );
       ESP_LOGI(TAG,"Brew limit: %i", dispenseMax);
-      last_changed[(int)JuraMachineStateIdentifier::BrewLimit] = millis();
+      states.touch(JuraMachineStateIdentifier::BrewLimit, millis());
       break; 
     case JuraMachineDispenseLimitType::Milk:
-      states[(int)JuraMachineStateIdentifier::MilkLimit] = (dispenseMax >= 30 && dispenseMax < 300) ? dispenseMax : 0 ;
+      states.commit(JuraMachineStateIdentifier::MilkLimit, (dispenseMax >= 30 && dispenseMax < 300) ? dispenseMax : 0 );
       ESP_LOGI(TAG,"Milk limit: %i", dispenseMax);
-      last_changed[(int)JuraMachineStateIdentifier::MilkLimit] = millis();
+      states.touch(JuraMachineStateIdentifier::MilkLimit, millis());
       break; 
     case JuraMachineDispenseLimitType::Water:  
       ESP_LOGI(TAG,"Water limit: %i", dispenseMax);  
-      states[(int)JuraMachineStateIdentifier::WaterLimit] = (dispenseMax >= 25 && dispenseMax < 300) ? dispenseMax : 0 ;
-      last_changed[(int)JuraMachineStateIdentifier::WaterLimit] = millis();
+      states.commit(JuraMachineStateIdentifier::WaterLimit, (dispenseMax >= 25 && dispenseMax < 300) ? dispenseMax : 0 );
+      states.touch(JuraMachineStateIdentifier::WaterLimit, millis());
       break;
   }
   xSemaphoreGive( xDispenseLimitSemaphore);
@@ -1214,16 +1316,16 @@ void JuraMachine::setDispenseLimit(int dispenseMax, JuraMachineDispenseLimitType
   xSemaphoreTake( xDispenseLimitSemaphore, portMAX_DELAY );
   switch (limitType) {
     case JuraMachineDispenseLimitType::Brew:
-      states[(int)JuraMachineStateIdentifier::BrewLimit] = 0 ;
-      last_changed[(int)JuraMachineStateIdentifier::BrewLimit] = millis();
+      states.commit(JuraMachineStateIdentifier::BrewLimit, 0 );
+      states.touch(JuraMachineStateIdentifier::BrewLimit, millis());
       break; 
     case JuraMachineDispenseLimitType::Milk:
-      states[(int)JuraMachineStateIdentifier::MilkLimit] = 0 ;
-      last_changed[(int)JuraMachineStateIdentifier::MilkLimit] = millis();
+      states.commit(JuraMachineStateIdentifier::MilkLimit, 0 );
+      states.touch(JuraMachineStateIdentifier::MilkLimit, millis());
       break; 
     case JuraMachineDispenseLimitType::Water:    
-      states[(int)JuraMachineStateIdentifier::WaterLimit] = 0 ;
-      last_changed[(int)JuraMachineStateIdentifier::WaterLimit] = millis();
+      states.commit(JuraMachineStateIdentifier::WaterLimit, 0 );
+      states.touch(JuraMachineStateIdentifier::WaterLimit, millis());
       break;
   }
   xSemaphoreGive( xDispenseLimitSemaphore);
@@ -1302,15 +1404,15 @@ void JuraMachine::setDispenseLimit(int dispenseMax, JuraMachineDispenseLimitType
   _bridge->machineStateChanged(JuraMachineStateIdentifier::SystemSteamMode, steam_mode);
 
   /* save states */
-  states[(int) JuraMachineStateIdentifier::CeramicValveCondenserPosition] = isCondenserPosition;
-  states[(int) JuraMachineStateIdentifier::CeramicValveHotWaterPosition] = isHotWaterCircuit;
-  states[(int) JuraMachineStateIdentifier::CeramicValvePressurizingPosition] = isPressurizingPosition;
-  states[(int) JuraMachineStateIdentifier::CeramicValveBrewingPosition] =  isBrewingPosition;
-  states[(int) JuraMachineStateIdentifier::CeramicValveSteamPosition] =  isSteamPosition;
-  states[(int) JuraMachineStateIdentifier::CeramicValveVenturiPosition] =  isVenturiPosition;
-  states[(int) JuraMachineStateIdentifier::CeramicValvePressureReliefPosition] = isPressureReliefPosition;
-  states[(int) JuraMachineStateIdentifier::SystemWaterMode] = water_mode;
-  states[(int) JuraMachineStateIdentifier::SystemSteamMode] = steam_mode;
+  states.commit(JuraMachineStateIdentifier::CeramicValveCondenserPosition, isCondenserPosition);
+  states.commit(JuraMachineStateIdentifier::CeramicValveHotWaterPosition, isHotWaterCircuit);
+  states.commit(JuraMachineStateIdentifier::CeramicValvePressurizingPosition, isPressurizingPosition);
+  states.commit(JuraMachineStateIdentifier::CeramicValveBrewingPosition, isBrewingPosition);
+  states.commit(JuraMachineStateIdentifier::CeramicValveSteamPosition, isSteamPosition);
+  states.commit(JuraMachineStateIdentifier::CeramicValveVenturiPosition, isVenturiPosition);
+  states.commit(JuraMachineStateIdentifier::CeramicValvePressureReliefPosition, isPressureReliefPosition);
+  states.commit(JuraMachineStateIdentifier::SystemWaterMode, water_mode);
+  states.commit(JuraMachineStateIdentifier::SystemSteamMode, steam_mode);
 
   /* ceramic valve states */
   _bridge->machineStateChanged(JuraMachineStateIdentifier::CeramicValveCondenserPosition, isCondenserPosition);
@@ -1365,10 +1467,10 @@ void JuraMachine::handleBrewGroupOutput(){
   _bridge->machineStateChanged(JuraMachineStateIdentifier::BrewGroupIsLocked, isLocked);
 
   /* update local states */
-  states[(int) JuraMachineStateIdentifier::BrewGroupIsRinsing] = isWaterRinsing;
-  states[(int) JuraMachineStateIdentifier::BrewGroupIsOpen] = isOpen;
-  states[(int) JuraMachineStateIdentifier::BrewGroupIsReady] = isReady;
-  states[(int) JuraMachineStateIdentifier::BrewGroupIsLocked] = isLocked;
+  states.commit(JuraMachineStateIdentifier::BrewGroupIsRinsing, isWaterRinsing);
+  states.commit(JuraMachineStateIdentifier::BrewGroupIsOpen, isOpen);
+  states.commit(JuraMachineStateIdentifier::BrewGroupIsReady, isReady);
+  states.commit(JuraMachineStateIdentifier::BrewGroupIsLocked, isLocked);
 
   /* output valve */ 
   int _output_valve_postition = states[(int) JuraMachineStateIdentifier::BrewGroupOutputStatus] >> 7;
@@ -1379,10 +1481,10 @@ void JuraMachine::handleBrewGroupOutput(){
   bool isOutputValveBlockPosition = !isOutputValveBrewPosition && !isOutputValveDrainPosition && !isOutputValveFlushPosition;
 
   /* save state */
-  states[(int) JuraMachineStateIdentifier::OutputValveIsBrewing] = isOutputValveBrewPosition;
-  states[(int) JuraMachineStateIdentifier::OutputValveIsFlushing] = isOutputValveFlushPosition;
-  states[(int) JuraMachineStateIdentifier::OutputValveIsDraining] = isOutputValveDrainPosition;
-  states[(int) JuraMachineStateIdentifier::OutputValveIsBlocking] = isOutputValveBlockPosition;
+  states.commit(JuraMachineStateIdentifier::OutputValveIsBrewing, isOutputValveBrewPosition);
+  states.commit(JuraMachineStateIdentifier::OutputValveIsFlushing, isOutputValveFlushPosition);
+  states.commit(JuraMachineStateIdentifier::OutputValveIsDraining, isOutputValveDrainPosition);
+  states.commit(JuraMachineStateIdentifier::OutputValveIsBlocking, isOutputValveBlockPosition);
 
   /* notify bridge of multiple values derived from the single valve position state */
   _bridge->machineStateChanged(JuraMachineStateIdentifier::OutputValveIsBrewing, isOutputValveBrewPosition);
@@ -1475,16 +1577,16 @@ void JuraMachine::handleThermoblockTemperature(int _temp){
   _bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockOvertemperature, isOvertemp);
   _bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockSanitationTemperature, isSanitationLevel);
 
-  states[(int) JuraMachineStateIdentifier::ThermoblockColdMode] = isColdMode;
-  states[(int) JuraMachineStateIdentifier::ThermoblockLowMode] = isLowMode;
-  states[(int) JuraMachineStateIdentifier::ThermoblockHighMode] = isHighMode;
-  states[(int) JuraMachineStateIdentifier::ThermoblockOvertemperature] = isOvertemp;
-  states[(int) JuraMachineStateIdentifier::ThermoblockSanitationTemperature] = isSanitationLevel;
+  states.commit(JuraMachineStateIdentifier::ThermoblockColdMode, isColdMode);
+  states.commit(JuraMachineStateIdentifier::ThermoblockLowMode, isLowMode);
+  states.commit(JuraMachineStateIdentifier::ThermoblockHighMode, isHighMode);
+  states.commit(JuraMachineStateIdentifier::ThermoblockOvertemperature, isOvertemp);
+  states.commit(JuraMachineStateIdentifier::ThermoblockSanitationTemperature, isSanitationLevel);
 
 
-  states[(int) JuraMachineStateIdentifier::OverextractionLikely] = isOverextractionLikely;
-  states[(int) JuraMachineStateIdentifier::UnderextractionLikely] = isUnderextractionLikely;
-  states[(int) JuraMachineStateIdentifier::RegulateThermoblockTemperatureRecommended] = shouldRecommendWaterPurge;
+  states.commit(JuraMachineStateIdentifier::OverextractionLikely, isOverextractionLikely);
+  states.commit(JuraMachineStateIdentifier::UnderextractionLikely, isUnderextractionLikely);
+  states.commit(JuraMachineStateIdentifier::RegulateThermoblockTemperatureRecommended, shouldRecommendWaterPurge);
   _bridge->machineStateChanged(JuraMachineStateIdentifier::OverextractionLikely, isOverextractionLikely);
   _bridge->machineStateChanged(JuraMachineStateIdentifier::UnderextractionLikely, isUnderextractionLikely);
   _bridge->machineStateChanged(JuraMachineStateIdentifier::RegulateThermoblockTemperatureRecommended, shouldRecommendWaterPurge);
@@ -1502,12 +1604,12 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   /* bean hopper */
   if (( states[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen] == false) ){
     /* has enough time elapsed? */
-    if (millis() -  last_changed[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen] > JURA_MACHINE_BEANS_REFILLED_TIMEOUT){
-      states[(int) JuraMachineStateIdentifier::SpentBeansByWeight] = 0;
+    if (millis() -  states.lastChanged(JuraMachineStateIdentifier::BeanHopperCoverOpen) > JURA_MACHINE_BEANS_REFILLED_TIMEOUT){
+      states.commit(JuraMachineStateIdentifier::SpentBeansByWeight, 0);
       _bridge->machineStateChanged(JuraMachineStateIdentifier::SpentBeansByWeight, states[(int) JuraMachineStateIdentifier::SpentBeansByWeight]);
       _bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperLevel, 100.0);
 
-       states[(int) JuraMachineStateIdentifier::BeanHopperEmpty] = false; 
+       states.commit(JuraMachineStateIdentifier::BeanHopperEmpty, false); 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperEmpty, states[(int) JuraMachineStateIdentifier::BeanHopperEmpty]);
     }
   }
@@ -1548,7 +1650,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
 
   } else {
     /* timestamp */
-    float time_delta = (millis() - last_changed[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]);
+    float time_delta = (millis() - states.lastChanged(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume));
 
     /* calculate */
     float ml_per_min = ((states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume] - prior_dispense) * 100000 / time_delta)  * DISPENSED_ML_CALIBRATION_COEFFICIENT_DEFAULT ;
@@ -1615,33 +1717,33 @@ void JuraMachine::handleBeanHopperCoverOpen(){
       /* set appropriate limits heree --- REMEMBER THAT EACH ARE MULTIPLIED BY 10  */
       if ((flow_rate_average >=0 && flow_rate_average <= 10000) && (temperature_average > 500 && temperature_average < 1800)){
         /* flow rate only if change */
-        states[(int) JuraMachineStateIdentifier::WaterPumpFlowRate] = (int) flow_rate_average * 10;
+        states.commit(JuraMachineStateIdentifier::WaterPumpFlowRate, (int) flow_rate_average * 10);
         _bridge->machineStateChanged(
           JuraMachineStateIdentifier::WaterPumpFlowRate, 
           (int) flow_rate_average * 10 
         );
 
         /* update tempreature values for */
-        states[(int) JuraMachineStateIdentifier::LastDispenseAvgTemperature] = (int) temperature_average;
+        states.commit(JuraMachineStateIdentifier::LastDispenseAvgTemperature, (int) temperature_average);
         _bridge->machineStateChanged(
           JuraMachineStateIdentifier::LastDispenseAvgTemperature, 
           (int) temperature_average  / 10 
         );
 
-        states[(int) JuraMachineStateIdentifier::LastDispenseMaxTemperature] = (int) maxTemp;
+        states.commit(JuraMachineStateIdentifier::LastDispenseMaxTemperature, (int) maxTemp);
         _bridge->machineStateChanged(
           JuraMachineStateIdentifier::LastDispenseMaxTemperature, 
           (int) maxTemp  / 10 
         );
 
-        states[(int) JuraMachineStateIdentifier::LastDispenseMinTemperature] = (int) minTemp;
+        states.commit(JuraMachineStateIdentifier::LastDispenseMinTemperature, (int) minTemp);
         _bridge->machineStateChanged(
           JuraMachineStateIdentifier::LastDispenseMinTemperature, 
           (int) minTemp / 10 
         );
 
         /* characterize temperature trend of this dispense event */
-        states[(int) JuraMachineStateIdentifier::LastDispenseGrossTemperatureTrend] = (int) gross_temperature_trend;
+        states.commit(JuraMachineStateIdentifier::LastDispenseGrossTemperatureTrend, (int) gross_temperature_trend);
         if (gross_temperature_trend > 5){
           _bridge->machineStateStringChanged(
               JuraMachineStateIdentifier::LastDispenseGrossTemperatureTrend, 
@@ -1671,10 +1773,11 @@ void JuraMachine::handleBeanHopperCoverOpen(){
               "MILK",
               (int) 0
           );
+          _shot_profile_dispense_type = 0;
 
           /* set milk dispense */
           if (states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume] * DISPENSED_ML_CALIBRATION_COEFFICIENT_MILK > 10){
-            states[(int) JuraMachineStateIdentifier::LastMilkDispenseVolume] = states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume];
+            states.commit(JuraMachineStateIdentifier::LastMilkDispenseVolume, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]);
             _bridge->machineStateChanged(
               JuraMachineStateIdentifier::LastMilkDispenseVolume, 
               (int) states[(int) JuraMachineStateIdentifier::LastMilkDispenseVolume] * DISPENSED_ML_CALIBRATION_COEFFICIENT_MILK
@@ -1689,9 +1792,10 @@ void JuraMachine::handleBeanHopperCoverOpen(){
                 "BREW",
                 (int) 1
             );
+            _shot_profile_dispense_type = 1;
 
             /* set brew dispense */
-            states[(int) JuraMachineStateIdentifier::LastBrewDispenseVolume] = states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume];
+            states.commit(JuraMachineStateIdentifier::LastBrewDispenseVolume, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]);
             _bridge->machineStateChanged(
               JuraMachineStateIdentifier::LastBrewDispenseVolume, 
               (int) states[(int) JuraMachineStateIdentifier::LastBrewDispenseVolume] * DISPENSED_ML_CALIBRATION_COEFFICIENT_ESPRESSO
@@ -1706,9 +1810,10 @@ void JuraMachine::handleBeanHopperCoverOpen(){
               "WATER",
               (int) 2
           );
+          _shot_profile_dispense_type = 2;
 
           /* set water dispense */
-          states[(int) JuraMachineStateIdentifier::LastWaterDispenseVolume] = states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume];
+          states.commit(JuraMachineStateIdentifier::LastWaterDispenseVolume, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]);
           _bridge->machineStateChanged(
             JuraMachineStateIdentifier::LastWaterDispenseVolume, 
             (int) states[(int) JuraMachineStateIdentifier::LastWaterDispenseVolume] * DISPENSED_ML_CALIBRATION_COEFFICIENT_DEFAULT
@@ -1716,7 +1821,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
         }
 
         /* duration of current dispense */
-        states[(int) JuraMachineStateIdentifier::LastDispenseDuration] = (int) ((int) current_millis - (int) start_time)/1000;
+        states.commit(JuraMachineStateIdentifier::LastDispenseDuration, (int) ((int) current_millis - (int) start_time)/1000);
         _bridge->machineStateChanged(
           JuraMachineStateIdentifier::LastDispenseDuration, 
           (int) ((int) current_millis - (int) start_time)/1000
@@ -1756,7 +1861,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
             (states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume] * calibrationCoefficient) > dispenseLimit - 3){
           /* send cancel command !*/
           ESP_LOGI(TAG,"Interrupting current operation.");
-          _bridge->instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::ConfirmDisplayPrompt);
+          _bridge->instructServicePortWithJuraFunctionIdentifier(JuraFunctionIdentifier::ConfirmDisplayPrompt, JuraUartLane::Safety);
           clearDispenseLimit(dispenseLimitType);
           vTaskDelay(pdMS_TO_TICKS(750));
         }
@@ -1765,245 +1870,206 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   }
 
   /* if last dispense volume ~= 1000, just changed the filter */
-  last_changed[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume] = millis();
+  states.touch(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume, millis());
 }
 
 /***************************************************************************//**
- * Sampler from generator-esque input to determine whether to poll and parse UART
+ * Open a shot profile when a dispense starts; a profile that did not settle
+ * before this dispense is closed out first.
  *
- * @param[out] bool 
+ * @param[out] null 
  *     
- * @param[in] int iterator 
+ * @param[in] unsigned long now
  ******************************************************************************/
- void JuraMachine::handlePoll(int iterator){
-
-  /* set polling rates */
-  int poll_rate_ic = POLL_DISABLED;   /* flow meter, brew group encoder, output valve encoder, errors */
-  int poll_rate_cs = POLL_DISABLED;   /* real-time access needed hardware functions and drive modes (grinder, pump, thermoblock) */
-  int poll_rate_hz = POLL_DISABLED;   /* non real-time access needed hardware functions and states */
-  int poll_rate_rt0 = POLL_DISABLED;
-  int poll_rate_rt1 = POLL_DISABLED;
-  int poll_rate_rt2 = POLL_DISABLED;
-  /* ... */
-  int poll_rate_rt4 = POLL_DISABLED;
-  int poll_rate_rt5 = POLL_DISABLED;
-  int poll_rate_rt7 = POLL_DISABLED;
-  int poll_rate_rt8 = POLL_DISABLED;
-  int poll_rate_rtA = POLL_DISABLED;
-  int poll_rate_rtD = POLL_DISABLED;
-
-  /* set polling rate based on current machine state */
-  switch (states[(int) JuraMachineStateIdentifier::OperationalState] ){
-    case (int) JuraMachineOperationalState::Starting:
-      /* need to get data from the machine first */
-      poll_rate_ic = POLL_DUTY_FULL;
-      poll_rate_cs = POLL_DUTY_FULL;
-      poll_rate_hz = POLL_DUTY_FULL;
-
-      /* memory */
-      poll_rate_rt0 = POLL_DUTY_FULL;
-      poll_rate_rt1 = POLL_DUTY_FULL;
-      poll_rate_rt2 = POLL_DUTY_FULL;
-      /*...*/
-      poll_rate_rt4 = POLL_DUTY_FULL;
-      poll_rate_rt5 = POLL_DUTY_FULL;
-      poll_rate_rtA = POLL_DUTY_FULL;
-      poll_rate_rtD = POLL_DUTY_FULL;
-
-      break;
+ void JuraMachine::startShotProfile(unsigned long now){
+  if (shotProfiles.isRecording()){
+    const JuraShotProfile * profile = shotProfiles.finishRecording(_shot_profile_dispense_type);
+    if (profile != nullptr){_bridge->publishShotProfile(*profile);}
+  }
+  _shot_profile_dispense_type = 2;
+  shotProfiles.startRecording(now);
+ }
 
-    case (int) JuraMachineOperationalState::Idle:
-      /* clear everytihng up; continue the polling  */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_33; /* capture grinder quickly */
-      poll_rate_hz = POLL_DUTY_33;
-
-      /* memory */
-      poll_rate_rt0 = POLL_DUTY_33;
-      poll_rate_rt1 = POLL_DUTY_33;
-      poll_rate_rt2 = POLL_DUTY_33;
-
-      poll_rate_rt4 = POLL_DUTY_20;
-      poll_rate_rt5 = POLL_DUTY_20;
-      poll_rate_rt7 = POLL_DUTY_20;
-      poll_rate_rt8 = POLL_DUTY_20;
-      poll_rate_rtA = POLL_DUTY_20;
-      poll_rate_rtD = POLL_DUTY_20;
-      break;
+/***************************************************************************//**
+ * Record a shot profile sample at the poll rate of the realtime sources; samples
+ * that match the previous sample are skipped by the recorder. Once the pump is
+ * off and the dispensed volume has settled, close and publish the profile. A
+ * dispense start signaled from any task opens its profile here, so the recorder
+ * is only ever used by the poll task.
+ *
+ * @param[out] null 
+ *     
+ * @param[in] null
+ ******************************************************************************/
+ void JuraMachine::handleShotProfile(){
+  unsigned long startAt = _shot_profile_start_at;
+  if (startAt != 0){
+    _shot_profile_start_at = 0;
+    startShotProfile(startAt);
+  }
 
-    case (int) JuraMachineOperationalState::Finishing:
-      /* clear everytihng up; continue the polling  */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_FULL;
-      poll_rate_hz = POLL_DUTY_20;
-
-      /* memory */
-      poll_rate_rt0 = POLL_DUTY_15;
-      poll_rate_rt1 = POLL_DUTY_10;
-      poll_rate_rt2 = POLL_DUTY_5;
-      poll_rate_rtD = POLL_DUTY_FULL;
-      break;
-    
-    case (int) JuraMachineOperationalState::Ready:
-      /* awaiting a grind or awaiting pump & thermoblock */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_FULL; /* capture grinder quickly */
-      poll_rate_hz = POLL_DUTY_20;
-
-      /* memory */
-      poll_rate_rt0 = POLL_DUTY_15;
-      poll_rate_rt1 = POLL_DUTY_10;
-      poll_rate_rt2 = POLL_DUTY_5;
-      /*...*/
-      poll_rate_rtA = POLL_DUTY_5;
-      poll_rate_rt7 = POLL_DUTY_5;
-      poll_rate_rt8 = POLL_DUTY_5;
-      poll_rate_rtD = POLL_DUTY_15;
+  if (!shotProfiles.isRecording()){return;}
+
+  unsigned long now = millis();
+  int values[SHOT_PROFILE_CHANNELS] = {
+    states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume],
+    flowRateSamples[0],
+    states[(int) JuraMachineStateIdentifier::ThermoblockTemperature],
+    states[(int) JuraMachineStateIdentifier::CeramicValvePosition],
+    states[(int) JuraMachineStateIdentifier::BrewGroupOutputStatus],
+    states[(int) JuraMachineStateIdentifier::PumpDutyCycle]
+  };
+  shotProfiles.addSample(now, values);
+
+  /* settled? */
+  if (states[(int) JuraMachineStateIdentifier::PumpActive] == false && 
+      now - states.lastChanged(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume) > SHOT_PROFILE_SETTLE_TIMEOUT_MS){
+    const JuraShotProfile * profile = shotProfiles.finishRecording(_shot_profile_dispense_type);
+    if (profile != nullptr){
+      ESP_LOGI(TAG,"Shot profile %i: %i samples, %i bytes", profile->sequence, profile->sampleCount, profile->length);
+      _bridge->publishShotProfile(*profile);
+    }
+  }
+}
 
-      break;
-    
-    case (int) JuraMachineOperationalState::GrindOperation:
-      /* awaiting a grind or awaiting pump & thermoblock */
-      poll_rate_cs = POLL_DUTY_FULL; /* refresh grinder asap */
-      break;
-    
-    case (int) JuraMachineOperationalState::BrewOperation:
-      /* awaiting a grind or awaiting pump & thermoblock */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_FULL; /* capture grinder quickly */
-      poll_rate_hz = POLL_DUTY_20;
+/***************************************************************************//**
+ * Set iterator modulo to throttle machine polling for a single source
+ *
+ * @param[out] null 
+ *     
+ * @param[in] JuraPollSource source
+ * @param[in] int period
+ ******************************************************************************/
+ void JuraMachine::setPollRate(JuraPollSource source, int period){
+  switch (source){
+    case JuraPollSource::IC:  _ic.setPollRate(period);  break;
+    case JuraPollSource::CS:  _cs.setPollRate(period);  break;
+    case JuraPollSource::HZ:  _hz.setPollRate(period);  break;
+    case JuraPollSource::RT0: _rt0.setPollRate(period); break;
+    case JuraPollSource::RT1: _rt1.setPollRate(period); break;
+    case JuraPollSource::RT2: _rt2.setPollRate(period); break;
+    case JuraPollSource::RT4: _rt4.setPollRate(period); break;
+    case JuraPollSource::RT5: _rt5.setPollRate(period); break;
+    case JuraPollSource::RT7: _rt7.setPollRate(period); break;
+    case JuraPollSource::RT8: _rt8.setPollRate(period); break;
+    case JuraPollSource::RTA: _rtA.setPollRate(period); break;
+    case JuraPollSource::RTD: _rtD.setPollRate(period); break;
+    case JuraPollSource::EepromScan: eepromScanner.setPollRate(EEPROM_SCANNER ? period : POLL_DISABLED); break;
+    case JuraPollSource::WorkingMemoryScan:  workingMemory.setScanRate(WORKING_MEMORY_SCANNER ? period : POLL_DISABLED); break;
+    case JuraPollSource::WorkingMemoryWatch: workingMemory.setWatchRate(WORKING_MEMORY_SCANNER ? period : POLL_DISABLED); break;
+    default: break;
+  }
+}
 
-      poll_rate_rt0 = POLL_DUTY_15; /* needed to catch cleaning state based on grounds */
-      break;
-    
-    case (int) JuraMachineOperationalState::BlockingError:
-      /* clear an error fast  */
-      poll_rate_ic = POLL_DUTY_FULL;
-      poll_rate_rt0 = POLL_DUTY_FULL;
-      poll_rate_rtD = POLL_DUTY_FULL;
-      break;
+/***************************************************************************//**
+ * Apply a poll plan; sources not listed in the plan are disabled
+ *
+ * @param[out] null 
+ *     
+ * @param[in] const JuraPollPlanEntry * entries
+ * @param[in] int size
+ ******************************************************************************/
+ void JuraMachine::applyPollPlan(const JuraPollPlanEntry * entries, int size){
+  for (int i = 0; i < (int) JuraPollSource::Count; i++){
+    setPollRate((JuraPollSource) i, POLL_DISABLED);
+  }
+  for (int i = 0; i < size; i++){
+    setPollRate(entries[i].source, entries[i].period);
+  }
+}
 
-    case (int) JuraMachineOperationalState::WaterOperation:
-      /* awaiting a grind or awaiting pump & thermoblock */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_FULL; /* capture grinder quickly */
-      poll_rate_hz = POLL_DUTY_20;
+/***************************************************************************//**
+ * Sampler from generator-esque input to determine whether to poll and parse UART
+ *
+ * @param[out] bool 
+ *     
+ * @param[in] int iterator 
+ ******************************************************************************/
+ void JuraMachine::handlePoll(int iterator){
+  JURA_MEMORY_PROFILE("poll");
 
-      poll_rate_rt0 = POLL_DUTY_15;
-      break;
-    
-    case (int) JuraMachineOperationalState::MilkOperation:
-      /* awaiting a grind or awaiting pump & thermoblock */
-      poll_rate_ic = POLL_DUTY_33;
-      poll_rate_cs = POLL_DUTY_FULL; /* capture grinder quickly */
-      poll_rate_hz = POLL_DUTY_20;
-      break;
-    default:
-      /*  */
-      poll_rate_ic = POLL_DUTY_50;   /* flow meter & errors */
-      poll_rate_cs = POLL_DUTY_FULL; 
-      poll_rate_hz = POLL_DUTY_33;
-
-      /* memory */
-      poll_rate_rt0 = POLL_DUTY_15;
-      poll_rate_rt1 = POLL_DUTY_10;
-      break;
-  }
-  
-  /* set iterator modulo to throttle machine polling; can change  */
-  _ic.setPollRate   (poll_rate_ic);
-  _cs.setPollRate   (poll_rate_cs);
-  _hz.setPollRate   (poll_rate_hz);
-  _rt0.setPollRate  (poll_rate_rt0);
-  _rt1.setPollRate  (poll_rate_rt1);
-  _rt2.setPollRate  (poll_rate_rt2);
-
-  _rt4.setPollRate  (poll_rate_rt4);
-  _rt5.setPollRate  (poll_rate_rt5);
-  _rt7.setPollRate  (poll_rate_rt7);
-  _rt8.setPollRate  (poll_rate_rt8);
-  _rtA.setPollRate  (poll_rate_rtA);
-  _rtD.setPollRate  (poll_rate_rtD);
-
-  /* special memory refresh? */
+  /* special memory refresh? reapply the operational state plan on the next poll */
   if (iterator == POLL_MEMORY){
     /* reset iterator to 1, disable poll reates for non-memory elements*/
     iterator = 1;
-    _ic.setPollRate   (POLL_DISABLED);
-    _cs.setPollRate   (POLL_DISABLED);
-    _hz.setPollRate   (POLL_DISABLED);
-    _rt0.setPollRate  (POLL_DUTY_FULL);
-    _rt1.setPollRate  (POLL_DUTY_FULL);
-    _rt2.setPollRate  (POLL_DISABLED);
-    _rt4.setPollRate  (POLL_DISABLED);
-    _rt5.setPollRate  (POLL_DISABLED);
-    _rt7.setPollRate  (POLL_DISABLED);
-    _rt8.setPollRate  (POLL_DISABLED);
-    _rtA.setPollRate  (POLL_DISABLED);
-    _rtD.setPollRate  (POLL_DISABLED);
+    applyPollPlan(JuraPollPlanMemory, POLL_PLAN_SIZE(JuraPollPlanMemory));
+    _poll_plan_state = POLL_MEMORY;
+
+  /* set polling rate based on current machine state, only on transition */
+  } else if (states[(int) JuraMachineStateIdentifier::OperationalState] != _poll_plan_state){
+    _poll_plan_state = states[(int) JuraMachineStateIdentifier::OperationalState];
+    const JuraPollPlan &plan = (_poll_plan_state >= 0 && _poll_plan_state < POLL_PLAN_SIZE(JuraPollPlans)) ? 
+      JuraPollPlans[_poll_plan_state] : 
+      JuraPollPlans[(int) JuraMachineOperationalState::Unknown];
+    applyPollPlan(plan.entries, plan.size);
+    eepromScanner.noteOperationalState(_poll_plan_state);
+    workingMemory.noteOperationalState(_poll_plan_state);
+
+    /* the machine's own screen for the new state replaces any DT: text */
+    _bridge->display.invalidate();
   }
 
   /* update dump of eeprom_word word 0, advance if a change is registered && if iterator matches instantiation */
   if (_rt0.didUpdate(iterator, _bridge->servicePort)){    
     /* -------------- ESPRESSO -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumEspresso], SUBSTR_INDEX_NUM_ESPRESSO_PREPARATIONS, 0, 50000)){ 
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumEspresso, SUBSTR_INDEX_NUM_ESPRESSO_PREPARATIONS, 0, 50000)){ 
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::NumEspresso, states[(int) JuraMachineStateIdentifier::NumEspresso])){
-        last_changed[(int) JuraMachineStateIdentifier::NumEspresso] = millis();
+        states.touch(JuraMachineStateIdentifier::NumEspresso, millis());
       }  
     }
 
     /* -------------- COFFEE -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumCoffee], SUBSTR_INDEX_NUM_COFFEE_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumCoffee, SUBSTR_INDEX_NUM_COFFEE_PREPARATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumCoffee, states[(int) JuraMachineStateIdentifier::NumCoffee])){
-        last_changed[(int) JuraMachineStateIdentifier::NumCoffee] = millis();
+        states.touch(JuraMachineStateIdentifier::NumCoffee, millis());
       }
     }
 
     /* -------------- CAPPUCCINO -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumCappuccino], SUBSTR_INDEX_NUM_CAPPUCCINO_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumCappuccino, SUBSTR_INDEX_NUM_CAPPUCCINO_PREPARATIONS, 0, 50000)){
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::NumCappuccino, states[(int) JuraMachineStateIdentifier::NumCappuccino])){
-        last_changed[(int) JuraMachineStateIdentifier::NumCappuccino] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumCappuccino, millis()); 
       }
     }
 
     /* -------------- MACCHIATO -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumMacchiato], SUBSTR_INDEX_NUM_MACCHIATO_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumMacchiato, SUBSTR_INDEX_NUM_MACCHIATO_PREPARATIONS, 0, 50000)){
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::NumMacchiato, states[(int) JuraMachineStateIdentifier::NumMacchiato])){
-        last_changed[(int) JuraMachineStateIdentifier::NumMacchiato] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumMacchiato, millis()); 
       }     
     }
 
     /* -------------- PREGROUND -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumPreground], SUBSTR_INDEX_NUM_PREGROUND_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumPreground, SUBSTR_INDEX_NUM_PREGROUND_PREPARATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumPreground, states[(int) JuraMachineStateIdentifier::NumPreground])){
-        last_changed[(int) JuraMachineStateIdentifier::NumPreground] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumPreground, millis()); 
       }
     }
 
     /* -------------- LOW PRESSURE PUMP -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumLowPressurePumpOperations], SUBSTR_INDEX_NUM_LOW_PRESSURE_PUMP_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumLowPressurePumpOperations, SUBSTR_INDEX_NUM_LOW_PRESSURE_PUMP_OPERATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumLowPressurePumpOperations, states[(int) JuraMachineStateIdentifier::NumLowPressurePumpOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumLowPressurePumpOperations] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumLowPressurePumpOperations, millis()); 
       }
     }
 
      /* -------------- MOTOR CYCLES -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumDriveMotorOperations], SUBSTR_INDEX_NUM_DRIVE_MOTOR_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumDriveMotorOperations, SUBSTR_INDEX_NUM_DRIVE_MOTOR_OPERATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumDriveMotorOperations, states[(int) JuraMachineStateIdentifier::NumDriveMotorOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumDriveMotorOperations] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumDriveMotorOperations, millis()); 
       }
     }
 
     /* -------------- SYSTEM CLEAN -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumBrewGroupCleanOperations], SUBSTR_INDEX_NUM_CLEAN_SYSTEM_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumBrewGroupCleanOperations, SUBSTR_INDEX_NUM_CLEAN_SYSTEM_OPERATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumBrewGroupCleanOperations, states[(int) JuraMachineStateIdentifier::NumBrewGroupCleanOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumBrewGroupCleanOperations] = millis(); 
+        states.touch(JuraMachineStateIdentifier::NumBrewGroupCleanOperations, millis()); 
       }
     }
 
     /* -------------- SPENT GROUNDS -------------- */
     int previous_spent_grounds = states[(int) JuraMachineStateIdentifier::NumSpentGrounds];
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumSpentGrounds], SUBSTR_INDEX_NUM_SPENT_GROUNDS, 0, 255)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumSpentGrounds, SUBSTR_INDEX_NUM_SPENT_GROUNDS, 0, 255)){
 
       /* append weight if new spent pucks are in knockbox/hopper */
       if (previous_spent_grounds >= 0 && states[(int) JuraMachineStateIdentifier::NumSpentGrounds] < 10){
@@ -2021,9 +2087,9 @@ void JuraMachine::handleBeanHopperCoverOpen(){
           int avg_weight_since_last_record = pucks_since_last_record * 8.5; /* 7g used for low strenght; 10g for high strength (https://www.coffeeness.de/en/jura-a1-review/) */
 
           /* update spent ground volume estimation */
-          states[(int) JuraMachineStateIdentifier::SpentBeansByWeight] += avg_weight_since_last_record;
+          states.commit(JuraMachineStateIdentifier::SpentBeansByWeight, states[(int) JuraMachineStateIdentifier::SpentBeansByWeight] + avg_weight_since_last_record);
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::SpentBeansByWeight, states[(int) JuraMachineStateIdentifier::SpentBeansByWeight])){
-            last_changed[(int) JuraMachineStateIdentifier::SpentBeansByWeight] = millis(); 
+            states.touch(JuraMachineStateIdentifier::SpentBeansByWeight, millis()); 
           }
 
           /* hopper is approximately 200g, so... */
@@ -2031,11 +2097,11 @@ void JuraMachine::handleBeanHopperCoverOpen(){
           hopper_level = hopper_level < 0 ? 0 : hopper_level; 
           
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperLevel, hopper_level)){
-            last_changed[(int) JuraMachineStateIdentifier::BeanHopperLevel] = millis(); 
+            states.touch(JuraMachineStateIdentifier::BeanHopperLevel, millis()); 
           }
 
           /* bean hopper problem state */
-          states[(int) JuraMachineStateIdentifier::BeanHopperEmpty] = (hopper_level == 0); 
+          states.commit(JuraMachineStateIdentifier::BeanHopperEmpty, (hopper_level == 0)); 
           _bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperEmpty, states[(int) JuraMachineStateIdentifier::BeanHopperEmpty]);
         }
       }
@@ -2045,12 +2111,12 @@ void JuraMachine::handleBeanHopperCoverOpen(){
       if (grounds_needs_empty != _grounds_needs_empty){
         grounds_needs_empty = _grounds_needs_empty;
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::GroundsNeedsEmpty, grounds_needs_empty)){
-          last_changed[(int) JuraMachineStateIdentifier::GroundsNeedsEmpty] = millis();
+          states.touch(JuraMachineStateIdentifier::GroundsNeedsEmpty, millis());
         }
 
       }else if ( ! _grounds_needs_empty) {
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::GroundsNeedsEmpty, false)){
-          last_changed[(int) JuraMachineStateIdentifier::GroundsNeedsEmpty] = millis();
+          states.touch(JuraMachineStateIdentifier::GroundsNeedsEmpty, millis());
         }
       }
 
@@ -2058,15 +2124,15 @@ void JuraMachine::handleBeanHopperCoverOpen(){
       bool _is_cleaning = states[(int) JuraMachineStateIdentifier::NumSpentGrounds] > 10;
       if (_is_cleaning != is_cleaning_brew_group){
         is_cleaning_brew_group = _is_cleaning;
-        states[(int) JuraMachineStateIdentifier::BrewProgramIsCleaning] = _is_cleaning;
+        states.commit(JuraMachineStateIdentifier::BrewProgramIsCleaning, _is_cleaning);
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewProgramIsCleaning, is_cleaning_brew_group)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewProgramIsCleaning] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewProgramIsCleaning, millis());
         }
       
       }else if (!_is_cleaning){
-        states[(int) JuraMachineStateIdentifier::BrewProgramIsCleaning] = _is_cleaning;
+        states.commit(JuraMachineStateIdentifier::BrewProgramIsCleaning, _is_cleaning);
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewProgramIsCleaning, false)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewProgramIsCleaning] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewProgramIsCleaning, millis());
         }
       }
       
@@ -2075,49 +2141,49 @@ void JuraMachine::handleBeanHopperCoverOpen(){
       spent_grounds_level = spent_grounds_level> 100 ? 100 : spent_grounds_level < 0 ? 0 : spent_grounds_level;
 
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::SpentGroundsLevel, spent_grounds_level)){
-        last_changed[(int) JuraMachineStateIdentifier::SpentGroundsLevel] = millis();
+        states.touch(JuraMachineStateIdentifier::SpentGroundsLevel, millis());
       }
 
       /* num spent grounds can increase beyond 100 during a cleaning operation; but should only report the number of grounds int the knockbox in reasonable range*/
       int num_spent_grounds = states[(int) JuraMachineStateIdentifier::NumSpentGrounds];
       num_spent_grounds = num_spent_grounds> 8 ? 8 : num_spent_grounds < 0 ? 0 : num_spent_grounds;
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumSpentGrounds,num_spent_grounds )){
-        last_changed[(int) JuraMachineStateIdentifier::NumSpentGrounds] = millis();
+        states.touch(JuraMachineStateIdentifier::NumSpentGrounds, millis());
       }
     }
 
     /* -------------- PREPARATIONS SINCE CLEAN -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt0, &this->states[(int) JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean], SUBSTR_INDEX_NUM_PREPARATIONS_SINCE_LAST_CLEAN, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt0, JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean, SUBSTR_INDEX_NUM_PREPARATIONS_SINCE_LAST_CLEAN, 0, 50000)){
       
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean, states[(int) JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean])){
-        last_changed[(int) JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean] = millis();
+        states.touch(JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean, millis());
       } 
 
       if (states[(int) JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean] >= BREW_GROUP_CLEAN_THRESHOLD){
         /* recommended now */
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommended, true)){
-          last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommended] = millis();
+          states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommended, millis());
         }
        if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, true)){
-        last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon] = millis();
+        states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, millis());
        }
 
       }else if (states[(int) JuraMachineStateIdentifier::NumPreparationsSinceLastBrewGroupClean] > BREW_GROUP_CLEAN_RECOMMEND_THRESHOLD){
         
         /* not recommended YET */
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommended, false)){
-          last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommended] = millis();
+          states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommended, millis());
         }
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, true)){
-          last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon] = millis();
+          states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, millis());
         }
 
       } else{
        if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommended, false)){
-         last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommended] = millis();
+         states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommended, millis());
        }
        if(_bridge->machineStateChanged(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, false)){
-         last_changed[(int) JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon] = millis();
+         states.touch(JuraMachineStateIdentifier::CleanBrewGroupRecommendedSoon, millis());
        }
       }
     }
@@ -2130,37 +2196,37 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt1.didUpdate(iterator, _bridge->servicePort)){
     
     /* -------------- HIGH PRESSURE PUMP -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt1, &this->states[(int) JuraMachineStateIdentifier::NumHighPressurePumpOperations], SUBSTR_INDEX_NUM_HIGH_PRESSURE_PUMP_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt1, JuraMachineStateIdentifier::NumHighPressurePumpOperations, SUBSTR_INDEX_NUM_HIGH_PRESSURE_PUMP_OPERATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumHighPressurePumpOperations, states[(int) JuraMachineStateIdentifier::NumHighPressurePumpOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumHighPressurePumpOperations] = millis();
+        states.touch(JuraMachineStateIdentifier::NumHighPressurePumpOperations, millis());
       }
     }
 
     /* -------------- MILK FOAM PREPARATIONS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt1, &this->states[(int) JuraMachineStateIdentifier::NumMilkFoamPreparations], SUBSTR_INDEX_NUM_MILK_FOAM_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt1, JuraMachineStateIdentifier::NumMilkFoamPreparations, SUBSTR_INDEX_NUM_MILK_FOAM_PREPARATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumMilkFoamPreparations, states[(int) JuraMachineStateIdentifier::NumMilkFoamPreparations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumMilkFoamPreparations] = millis();
+        states.touch(JuraMachineStateIdentifier::NumMilkFoamPreparations, millis());
       }
     }
 
     /* -------------- WATER PREPARATIONS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt1, &this->states[(int) JuraMachineStateIdentifier::NumWaterPreparations], SUBSTR_INDEX_NUM_WATER_PREPARATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt1, JuraMachineStateIdentifier::NumWaterPreparations, SUBSTR_INDEX_NUM_WATER_PREPARATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumWaterPreparations, states[(int) JuraMachineStateIdentifier::NumWaterPreparations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumWaterPreparations] = millis();
+        states.touch(JuraMachineStateIdentifier::NumWaterPreparations, millis());
       }
     }
 
     /* -------------- GRINDER OPERATIONS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt1, &this->states[(int) JuraMachineStateIdentifier::NumGrinderOperations], SUBSTR_INDEX_NUM_GRINDER_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt1, JuraMachineStateIdentifier::NumGrinderOperations, SUBSTR_INDEX_NUM_GRINDER_OPERATIONS, 0, 50000)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::NumGrinderOperations, states[(int) JuraMachineStateIdentifier::NumGrinderOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumGrinderOperations] = millis();
+        states.touch(JuraMachineStateIdentifier::NumGrinderOperations, millis());
       };
     }
 
     /* -------------- MILK CLEAN OPERATIONS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt1, &this->states[(int) JuraMachineStateIdentifier::NumCleanMilkSystemOperations], SUBSTR_INDEX_NUM_CLEAN_MILK_SYSTEM_OPERATIONS, 0, 50000)){
+    if (didUpdateJuraMemoryLineValue(&_rt1, JuraMachineStateIdentifier::NumCleanMilkSystemOperations, SUBSTR_INDEX_NUM_CLEAN_MILK_SYSTEM_OPERATIONS, 0, 50000)){
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::NumCleanMilkSystemOperations, states[(int) JuraMachineStateIdentifier::NumCleanMilkSystemOperations])){
-        last_changed[(int) JuraMachineStateIdentifier::NumCleanMilkSystemOperations] = millis();
+        states.touch(JuraMachineStateIdentifier::NumCleanMilkSystemOperations, millis());
         
       }
     }
@@ -2173,9 +2239,9 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt2.didUpdate(iterator, _bridge->servicePort)){
 
     /* -------------- HAS FILTER -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt2, &this->states[(int) JuraMachineStateIdentifier::HasFilter], SUBSTR_INDEX_HAS_FILTER, 0, 20)){
+    if (didUpdateJuraMemoryLineValue(&_rt2, JuraMachineStateIdentifier::HasFilter, SUBSTR_INDEX_HAS_FILTER, 0, 20)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::HasFilter, (((int) states[(int) JuraMachineStateIdentifier::HasFilter] & (int) 16) != 0))){
-        last_changed[(int) JuraMachineStateIdentifier::HasFilter] = millis();
+        states.touch(JuraMachineStateIdentifier::HasFilter, millis());
       };
     }
 
@@ -2189,7 +2255,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt4.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- NUMBER OF WATER FILTERS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt4, &this->states[(int) JuraMachineStateIdentifier::MachineSettingDispenseUnits], SUBSTR_INDEX_ML_OR_OZ, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rt4, JuraMachineStateIdentifier::MachineSettingDispenseUnits, SUBSTR_INDEX_ML_OR_OZ, 0, 65535)){
       //0b1 1101 0010 1111
       //0b1 1001 0010 1111
       //     ^ 
@@ -2204,7 +2270,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt5.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- OFF AFTER -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt5, &this->states[(int) JuraMachineStateIdentifier::MachineSettingOffAfter], SUBSTR_INDEX_OFF_AFTER, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rt5, JuraMachineStateIdentifier::MachineSettingOffAfter, SUBSTR_INDEX_OFF_AFTER, 0, 65535)){
       //0b 1100 0000 0001 0.25 hours  = 1
       //0b 1100 0010 0100 9 hours     = 36 * 15 = 540 minutes (9 hours)
       int power_off_minutes = ((states[(int) JuraMachineStateIdentifier::MachineSettingOffAfter] & 255) * 15);
@@ -2214,7 +2280,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- NUMBER OF WATER FILTERS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt5, &this->states[(int) JuraMachineStateIdentifier::MachineSettingNumFilters], SUBSTR_INDEX_NUM_FILTERS, 0, 500)){
+    if (didUpdateJuraMemoryLineValue(&_rt5, JuraMachineStateIdentifier::MachineSettingNumFilters, SUBSTR_INDEX_NUM_FILTERS, 0, 500)){
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingNumFilters, states[(int) JuraMachineStateIdentifier::MachineSettingNumFilters]);
     }
 
@@ -2225,7 +2291,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt7.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- WATER Button Configuration  -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt7, &this->states[(int) JuraMachineStateIdentifier::MachineSettingWaterSettings], SUBSTR_INDEX_WATER_DISPENSE_CONFIGURATION, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rt7, JuraMachineStateIdentifier::MachineSettingWaterSettings, SUBSTR_INDEX_WATER_DISPENSE_CONFIGURATION, 0, 65535)){
       int dispense_ml = (states[(int) JuraMachineStateIdentifier::MachineSettingWaterSettings] & 255) * 5;
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingWaterDispenseVolume, dispense_ml);
     }
@@ -2237,7 +2303,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rt8.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- Milk Button Configuration  -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rt8, &this->states[(int) JuraMachineStateIdentifier::MachineSettingMilkSettings], SUBSTR_INDEX_MILK_DISPENSE_CONFIGURATION, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rt8, JuraMachineStateIdentifier::MachineSettingMilkSettings, SUBSTR_INDEX_MILK_DISPENSE_CONFIGURATION, 0, 65535)){
       int dispense_seconds = states[(int) JuraMachineStateIdentifier::MachineSettingMilkSettings] & 255;
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingMilkDispenseTime, dispense_seconds);
     }
@@ -2249,13 +2315,13 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rtA.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- ESPRESSO SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingEspressoSettings], SUBSTR_INDEX_ESPRESSO_BREW_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingEspressoSettings, SUBSTR_INDEX_ESPRESSO_BREW_SETTINGS, 0, 65535)){
       int flavorMagnitude = (((states[(int) JuraMachineStateIdentifier::MachineSettingEspressoSettings] & 61440) >> 8) * 100 / 144);
       bool highTemperature = (states[(int) JuraMachineStateIdentifier::MachineSettingEspressoSettings] & 256) == 256;
       int dispenseVolume = (states[(int) JuraMachineStateIdentifier::MachineSettingEspressoSettings] & 255) * 5;
-      states[(int) JuraMachineStateIdentifier::MachineSettingEspressoFlavor] = flavorMagnitude;
-      states[(int) JuraMachineStateIdentifier::MachineSettingEspressoTemperature] = highTemperature;
-      states[(int) JuraMachineStateIdentifier::MachineSettingEspressoDispenseVolume] = dispenseVolume;
+      states.commit(JuraMachineStateIdentifier::MachineSettingEspressoFlavor, flavorMagnitude);
+      states.commit(JuraMachineStateIdentifier::MachineSettingEspressoTemperature, highTemperature);
+      states.commit(JuraMachineStateIdentifier::MachineSettingEspressoDispenseVolume, dispenseVolume);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingEspressoFlavor,states[(int) JuraMachineStateIdentifier::MachineSettingEspressoFlavor]);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::MachineSettingEspressoTemperature, highTemperature ? "HIGH" : "NORMAL", states[(int) JuraMachineStateIdentifier::MachineSettingEspressoTemperature]);
@@ -2263,13 +2329,13 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- COFFEE SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeSettings], SUBSTR_INDEX_COFFEE_BREW_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingCoffeeSettings, SUBSTR_INDEX_COFFEE_BREW_SETTINGS, 0, 65535)){
       int flavorMagnitude = (((states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeSettings] & 61440) >> 8) * 100 / 144);
       bool highTemperature = (states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeSettings] & 256) == 256;
       int dispenseVolume = (states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeSettings] & 255) * 5;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeFlavor] = flavorMagnitude;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeTemperature] = highTemperature;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeDispenseVolume] = dispenseVolume;
+      states.commit(JuraMachineStateIdentifier::MachineSettingCoffeeFlavor, flavorMagnitude);
+      states.commit(JuraMachineStateIdentifier::MachineSettingCoffeeTemperature, highTemperature);
+      states.commit(JuraMachineStateIdentifier::MachineSettingCoffeeDispenseVolume, dispenseVolume);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingCoffeeFlavor,states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeFlavor]);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::MachineSettingCoffeeTemperature, highTemperature ? "HIGH" : "NORMAL", states[(int) JuraMachineStateIdentifier::MachineSettingCoffeeTemperature]);
@@ -2277,13 +2343,13 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- CAPPUCCINO SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoSettings], SUBSTR_INDEX_CAPPUCCINO_BREW_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingCappuccinoSettings, SUBSTR_INDEX_CAPPUCCINO_BREW_SETTINGS, 0, 65535)){
       int flavorMagnitude = (((states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoSettings] & 61440) >> 8) * 100 / 144);
       bool highTemperature = (states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoSettings] & 256) == 256;
       int dispenseVolume = (states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoSettings] & 255) * 5;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoFlavor] = flavorMagnitude;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoTemperature] = highTemperature;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoDispenseVolume] = dispenseVolume;
+      states.commit(JuraMachineStateIdentifier::MachineSettingCappuccinoFlavor, flavorMagnitude);
+      states.commit(JuraMachineStateIdentifier::MachineSettingCappuccinoTemperature, highTemperature);
+      states.commit(JuraMachineStateIdentifier::MachineSettingCappuccinoDispenseVolume, dispenseVolume);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingCappuccinoFlavor,states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoFlavor]);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::MachineSettingCappuccinoTemperature, highTemperature ? "HIGH" : "NORMAL", states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoTemperature]);
@@ -2291,12 +2357,12 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- EXTENDED CAPPUCCINO SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoExtendedSettings], SUBSTR_INDEX_CAPPUCCINO_MILK_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingCappuccinoExtendedSettings, SUBSTR_INDEX_CAPPUCCINO_MILK_SETTINGS, 0, 65535)){
       int milkDelay = (((states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoExtendedSettings] & 65280) >> 8));
       int milkTime = (((states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoExtendedSettings] & 255)));
 
-      states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoMilkPause] = milkDelay;
-      states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoMilkTime] = milkTime;
+      states.commit(JuraMachineStateIdentifier::MachineSettingCappuccinoMilkPause, milkDelay);
+      states.commit(JuraMachineStateIdentifier::MachineSettingCappuccinoMilkTime, milkTime);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingCappuccinoMilkPause,states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoMilkPause]);
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingCappuccinoMilkTime,states[(int) JuraMachineStateIdentifier::MachineSettingCappuccinoMilkTime]);
@@ -2304,13 +2370,13 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- MACCHIATO SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoSettings], SUBSTR_INDEX_MACCHIATO_BREW_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingMacchiatoSettings, SUBSTR_INDEX_MACCHIATO_BREW_SETTINGS, 0, 65535)){
       int flavorMagnitude = (((states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoSettings] & 61440) >> 8) * 100 / 144);
       bool highTemperature = (states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoSettings] & 256) == 256;
       int dispenseVolume = (states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoSettings] & 255) * 5;
-      states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoFlavor] = flavorMagnitude;
-      states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoTemperature] = highTemperature;
-      states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoDispenseVolume] = dispenseVolume;
+      states.commit(JuraMachineStateIdentifier::MachineSettingMacchiatoFlavor, flavorMagnitude);
+      states.commit(JuraMachineStateIdentifier::MachineSettingMacchiatoTemperature, highTemperature);
+      states.commit(JuraMachineStateIdentifier::MachineSettingMacchiatoDispenseVolume, dispenseVolume);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingMacchiatoFlavor,states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoFlavor]);
       _bridge->machineStateStringChanged(JuraMachineStateIdentifier::MachineSettingMacchiatoTemperature, highTemperature ? "HIGH" : "NORMAL", states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoTemperature]);
@@ -2318,12 +2384,12 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- EXTENDED MACCHIATO SETTINGS -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtA, &this->states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoExtendedSettings], SUBSTR_INDEX_MACCHIATO_MILK_SETTINGS, 0, 65535)){
+    if (didUpdateJuraMemoryLineValue(&_rtA, JuraMachineStateIdentifier::MachineSettingMacchiatoExtendedSettings, SUBSTR_INDEX_MACCHIATO_MILK_SETTINGS, 0, 65535)){
       int milkDelay = (((states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoExtendedSettings] & 65280) >> 8));
       int milkTime = (((states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoExtendedSettings] & 255)));
 
-      states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoMilkPause] = milkDelay;
-      states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoMilkTime] = milkTime;
+      states.commit(JuraMachineStateIdentifier::MachineSettingMacchiatoMilkPause, milkDelay);
+      states.commit(JuraMachineStateIdentifier::MachineSettingMacchiatoMilkTime, milkTime);
 
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingMacchiatoMilkPause,states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoMilkPause]);
       _bridge->machineStateChanged(JuraMachineStateIdentifier::MachineSettingMacchiatoMilkTime,states[(int) JuraMachineStateIdentifier::MachineSettingMacchiatoMilkTime]);
@@ -2337,18 +2403,18 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_rtD.didUpdate(iterator, _bridge->servicePort)){  
     
     /* -------------- DRAINAGE TRAY VOLUME -------------- */
-    if (didUpdateJuraMemoryLineValue(&_rtD, &this->states[(int) JuraMachineStateIdentifier::DrainageTrayMeter], SUBSTR_INDEX_DRAINAGE_TRAY_VOLUME, 0, 2000)){
+    if (didUpdateJuraMemoryLineValue(&_rtD, JuraMachineStateIdentifier::DrainageTrayMeter, SUBSTR_INDEX_DRAINAGE_TRAY_VOLUME, 0, 2000)){
       _bridge->machineStateChanged(JuraMachineStateIdentifier::DrainageTrayMeter, states[(int) JuraMachineStateIdentifier::DrainageTrayMeter] * 0.5);
-      last_changed[(int) JuraMachineStateIdentifier::DrainageTrayMeter] = millis();
+      states.touch(JuraMachineStateIdentifier::DrainageTrayMeter, millis());
 
         /* update tray percentage too! */
       int capacity = 100 * states[(int) JuraMachineStateIdentifier::DrainageTrayMeter] / JURA_MACHINE_DRAINAGE_TRAY_CAPACITY_ML;
       capacity = capacity > 100 ? 100 : capacity < 0 ? 0 : capacity; 
 
-      states[(int) JuraMachineStateIdentifier::DrainageTrayLevel] = capacity;
+      states.commit(JuraMachineStateIdentifier::DrainageTrayLevel, capacity);
       _bridge->machineStateChanged(JuraMachineStateIdentifier::DrainageTrayLevel, capacity);
 
-      states[(int) JuraMachineStateIdentifier::DrainageTrayFull] =( capacity == 100);
+      states.commit(JuraMachineStateIdentifier::DrainageTrayFull, ( capacity == 100));
       _bridge->machineStateChanged(JuraMachineStateIdentifier::DrainageTrayFull, states[(int) JuraMachineStateIdentifier::DrainageTrayFull]);
     }
     
@@ -2359,54 +2425,54 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_ic.didUpdate(iterator, _bridge->servicePort)){
     
     /* -------------- BEAN HOPPER COVER -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen], SUBSTR_INDEX_BEAN_HOPPER_COVER_OPEN_IC, 1, JuraInputBoardBinaryResponseInterpretation::Inverted)){      
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::BeanHopperCoverOpen, SUBSTR_INDEX_BEAN_HOPPER_COVER_OPEN_IC, 1, JuraInputBoardBinaryResponseInterpretation::Inverted)){      
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperCoverOpen, states[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen])){
         handleBeanHopperCoverOpen();
-        last_changed[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen] = millis();
+        states.touch(JuraMachineStateIdentifier::BeanHopperCoverOpen, millis());
       };
     }
 
     /* -------------- WATER RESERVOIR NEEDS FILL -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill], SUBSTR_INDEX_WATER_RESERVOIR_NEEDS_FILL_IC, 1,JuraInputBoardBinaryResponseInterpretation::AsReported)){
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::WaterReservoirNeedsFill, SUBSTR_INDEX_WATER_RESERVOIR_NEEDS_FILL_IC, 1,JuraInputBoardBinaryResponseInterpretation::AsReported)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::WaterReservoirNeedsFill, states[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill])){
-        last_changed[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill] = millis();
+        states.touch(JuraMachineStateIdentifier::WaterReservoirNeedsFill, millis());
       }
     }
 
     /* -------------- BYPASS DOSER  -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen], SUBSTR_INDEX_BYPASS_DOSER_COVER_OPEN_IC, 1, JuraInputBoardBinaryResponseInterpretation::AsReported)){
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::BypassDoserCoverOpen, SUBSTR_INDEX_BYPASS_DOSER_COVER_OPEN_IC, 1, JuraInputBoardBinaryResponseInterpretation::AsReported)){
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::BypassDoserCoverOpen, states[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen])){
-        last_changed[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen] = millis();
+        states.touch(JuraMachineStateIdentifier::BypassDoserCoverOpen, millis());
 
         /* dose has be inserted */
         if (states[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen] == 1){
-          states[(int) JuraMachineStateIdentifier::HasDose] = true;
+          states.commit(JuraMachineStateIdentifier::HasDose, true);
           _bridge->machineStateChanged(JuraMachineStateIdentifier::HasDose ,true);
         }
       }
     }
 
     /* -------------- DRIP TRAY REMOVED -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::DrainageTrayRemoved], SUBSTR_INDEX_DRAINAGE_TRAY_REMOVED_IC, 1, JuraInputBoardBinaryResponseInterpretation::Inverted)){
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::DrainageTrayRemoved, SUBSTR_INDEX_DRAINAGE_TRAY_REMOVED_IC, 1, JuraInputBoardBinaryResponseInterpretation::Inverted)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::DrainageTrayRemoved, states[(int) JuraMachineStateIdentifier::DrainageTrayRemoved])){
-        last_changed[(int) JuraMachineStateIdentifier::DrainageTrayRemoved] = millis();
+        states.touch(JuraMachineStateIdentifier::DrainageTrayRemoved, millis());
       }
     }
 
     /* -------------- BREW GROUP ENCODER 4 - 5 -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::BrewGroupEncoderState], SUBSTR_INDEX_BREW_GROUP_ENCODER_STATE, 2, JuraInputBoardBinaryResponseInterpretation::AsReported)){
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::BrewGroupEncoderState, SUBSTR_INDEX_BREW_GROUP_ENCODER_STATE, 2, JuraInputBoardBinaryResponseInterpretation::AsReported)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewGroupEncoderState, states[(int) JuraMachineStateIdentifier::BrewGroupEncoderState])){
-        last_changed[(int) JuraMachineStateIdentifier::BrewGroupEncoderState] = millis();
+        states.touch(JuraMachineStateIdentifier::BrewGroupEncoderState, millis());
       }
     }
 
     /* -------------- OUTPUT VALVE SERVO ENCODER POSITION 14 - 15 -------------- */
-    if (didUpdateJuraInputControlBoardValue(&this->states[(int) JuraMachineStateIdentifier::OutputValveEncoderState], SUBSTR_INDEX_OUTPUT_VALVE_ENCODER_STATE, 2, JuraInputBoardBinaryResponseInterpretation::AsReported)){
+    if (didUpdateJuraInputControlBoardValue(JuraMachineStateIdentifier::OutputValveEncoderState, SUBSTR_INDEX_OUTPUT_VALVE_ENCODER_STATE, 2, JuraInputBoardBinaryResponseInterpretation::AsReported)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::OutputValveEncoderState, states[(int) JuraMachineStateIdentifier::OutputValveEncoderState])){
-          last_changed[(int) JuraMachineStateIdentifier::OutputValveEncoderState] = millis();
-          states[(int) JuraMachineStateIdentifier::OutputValveNominalPosition] = (states[(int) JuraMachineStateIdentifier::OutputValveEncoderState] == 2);
+          states.touch(JuraMachineStateIdentifier::OutputValveEncoderState, millis());
+          states.commit(JuraMachineStateIdentifier::OutputValveNominalPosition, (states[(int) JuraMachineStateIdentifier::OutputValveEncoderState] == 2));
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::OutputValveNominalPosition,  states[(int) JuraMachineStateIdentifier::OutputValveNominalPosition] )){
-            last_changed[(int) JuraMachineStateIdentifier::OutputValveNominalPosition] = millis();
+            states.touch(JuraMachineStateIdentifier::OutputValveNominalPosition, millis());
           }
       };
     }
@@ -2419,46 +2485,46 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_hz.didUpdate(iterator, _bridge->servicePort)){
     
     /* -------------- WATER RINSE RECOMMENDED -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended], SUBSTR_INDEX_RINSE_BREW_GROUP_RECOMMENDED, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::RinseBrewGroupRecommended, SUBSTR_INDEX_RINSE_BREW_GROUP_RECOMMENDED, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::RinseBrewGroupRecommended, states[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended])){
-        last_changed[(int) JuraMachineStateIdentifier::RinseBrewGroupRecommended] = millis();
+        states.touch(JuraMachineStateIdentifier::RinseBrewGroupRecommended, millis());
       }
     }
 
     /* -------------- THERMOBLOCK PREHEATED -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockPreheated], SUBSTR_INDEX_THERMOBLOCK_PREHEATED, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::ThermoblockPreheated, SUBSTR_INDEX_THERMOBLOCK_PREHEATED, 0, 1)){
      if( _bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockPreheated, states[(int) JuraMachineStateIdentifier::ThermoblockPreheated])){
-      last_changed[(int) JuraMachineStateIdentifier::ThermoblockPreheated] = millis();
+      states.touch(JuraMachineStateIdentifier::ThermoblockPreheated, millis());
      }
     }
 
     /* -------------- THERMOBLOCK NOMINAL -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockReady], SUBSTR_INDEX_THERMOBLOCK_READY, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::ThermoblockReady, SUBSTR_INDEX_THERMOBLOCK_READY, 0, 1)){
      if( _bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockReady, states[(int) JuraMachineStateIdentifier::ThermoblockReady])){
-      last_changed[(int) JuraMachineStateIdentifier::ThermoblockReady] = millis();
+      states.touch(JuraMachineStateIdentifier::ThermoblockReady, millis());
      }
     }
 
      /* -------------- LAST BREW_GROUP OPERATION -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation], SUBSTR_INDEX_LAST_BREW_OPERATION, 0, 25)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::BrewGroupLastOperation, SUBSTR_INDEX_LAST_BREW_OPERATION, 0, 25)){
       if (states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 0){
         if(_bridge->machineStateStringChanged(JuraMachineStateIdentifier::BrewGroupLastOperation, "NONE", 0)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewGroupLastOperation, millis());
         }
 
       }else if (states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 15 || states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 16){
         if(_bridge->machineStateStringChanged(JuraMachineStateIdentifier::BrewGroupLastOperation, "LOW PRESSURE BREW", 1)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewGroupLastOperation, millis());
         }; /* coffee */
       
       }else if ((states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 21) || (states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 20)){
         if(_bridge->machineStateStringChanged(JuraMachineStateIdentifier::BrewGroupLastOperation, "HIGH PRESSURE BREW", 2)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewGroupLastOperation, millis());
         } /* espresso drink */
       
       }else if ((states[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] == 22) ){
         if(_bridge->machineStateStringChanged(JuraMachineStateIdentifier::BrewGroupLastOperation, "RINSE", 3)){
-          last_changed[(int) JuraMachineStateIdentifier::BrewGroupLastOperation] = millis();
+          states.touch(JuraMachineStateIdentifier::BrewGroupLastOperation, millis());
         }
       
       }else{
@@ -2468,73 +2534,73 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     }
 
     /* -------------- OUTPUT STATUS  -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::BrewGroupOutputStatus], SUBSTR_INDEX_OUTPUT_VALVE_POSITION, 0, 50000)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::BrewGroupOutputStatus, SUBSTR_INDEX_OUTPUT_VALVE_POSITION, 0, 50000)){
       handleBrewGroupOutput();     
     }
 
     /* -------------- THERMOBLOCK TEMPERATURE C -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockTemperature], SUBSTR_INDEX_THERMOBLOCK_TEMPERATURE, 0, 2000)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::ThermoblockTemperature, SUBSTR_INDEX_THERMOBLOCK_TEMPERATURE, 0, 2000)){
       int _temp = states[(int) JuraMachineStateIdentifier::ThermoblockTemperature] / 10.0;
       handleThermoblockTemperature(_temp);
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockTemperature, _temp)){
-        last_changed[(int) JuraMachineStateIdentifier::ThermoblockTemperature] = millis();
+        states.touch(JuraMachineStateIdentifier::ThermoblockTemperature, millis());
       };
     }
 
     /* -------------- LAST DISPENSE ML -------------- */
     int prior_dispense = states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume];
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume], SUBSTR_INDEX_LAST_DISPENSE_PUMPED_WATER_VOLUME_ML, 0, 50000)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume, SUBSTR_INDEX_LAST_DISPENSE_PUMPED_WATER_VOLUME_ML, 0, 50000)){
       if (_bridge->machineStateChanged(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume] * DISPENSED_ML_CALIBRATION_COEFFICIENT_DEFAULT)){
         handleLastDispenseChange(prior_dispense);
       }
     }
 
     /* -------------- CERAMIC VALVE POSITION -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::CeramicValvePosition], SUBSTR_INDEX_CERAMIC_VALVE_POSITION, 0, 10)){
-      last_changed[(int) JuraMachineStateIdentifier::CeramicValvePosition] = millis();
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::CeramicValvePosition, SUBSTR_INDEX_CERAMIC_VALVE_POSITION, 0, 10)){
+      states.touch(JuraMachineStateIdentifier::CeramicValvePosition, millis());
       handleCeramicValve();
     }
 
     /* -------------- BEAN HOPPER COVER OPEN -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen], SUBSTR_INDEX_BEAN_HOPPER_COVER_OPEN_HZ, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::BeanHopperCoverOpen, SUBSTR_INDEX_BEAN_HOPPER_COVER_OPEN_HZ, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BeanHopperCoverOpen, states[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen])){
         handleBeanHopperCoverOpen();
-        last_changed[(int) JuraMachineStateIdentifier::BeanHopperCoverOpen] = millis();
+        states.touch(JuraMachineStateIdentifier::BeanHopperCoverOpen, millis());
       };
     }
 
     /* -------------- WATER RESERVOIR NEEDS FILL -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill], SUBSTR_INDEX_WATER_RESERVOIR_NEEDS_FILL_HZ, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::WaterReservoirNeedsFill, SUBSTR_INDEX_WATER_RESERVOIR_NEEDS_FILL_HZ, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::WaterReservoirNeedsFill, states[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill])){
-        last_changed[(int) JuraMachineStateIdentifier::WaterReservoirNeedsFill] = millis();
+        states.touch(JuraMachineStateIdentifier::WaterReservoirNeedsFill, millis());
       }
     }
 
     /* -------------- BYPASS DOSER COVER OPEN -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen], SUBSTR_INDEX_BYPASS_DOSER_COVER_OPEN_HZ, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::BypassDoserCoverOpen, SUBSTR_INDEX_BYPASS_DOSER_COVER_OPEN_HZ, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BypassDoserCoverOpen, states[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen])){
-        last_changed[(int) JuraMachineStateIdentifier::BypassDoserCoverOpen] = millis();
+        states.touch(JuraMachineStateIdentifier::BypassDoserCoverOpen, millis());
       }
     }
 
     /* -------------- DRAINAGE TRAY REMOVED -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::DrainageTrayRemoved], SUBSTR_INDEX_DRAINAGE_TRAY_REMOVED_HZ, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::DrainageTrayRemoved, SUBSTR_INDEX_DRAINAGE_TRAY_REMOVED_HZ, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::DrainageTrayRemoved, states[(int) JuraMachineStateIdentifier::DrainageTrayRemoved])){
-        last_changed[(int) JuraMachineStateIdentifier::DrainageTrayRemoved] = millis();
+        states.touch(JuraMachineStateIdentifier::DrainageTrayRemoved, millis());
       }
     }
 
     /* -------------- THREMOBLOCK IN MILK DISPENSE MODE -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockMilkDispenseMode], SUBSTR_INDEX_THERMOBLOCK_MILK_DISPENSE_MODE, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::ThermoblockMilkDispenseMode, SUBSTR_INDEX_THERMOBLOCK_MILK_DISPENSE_MODE, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockMilkDispenseMode, states[(int) JuraMachineStateIdentifier::ThermoblockMilkDispenseMode])){
-        last_changed[(int) JuraMachineStateIdentifier::ThermoblockMilkDispenseMode] = millis();
+        states.touch(JuraMachineStateIdentifier::ThermoblockMilkDispenseMode, millis());
       }
     }
 
     /* -------------- VENTURI PUMPING -------------- */
-    if (didUpdateJuraHeatedBeverageValue(&this->states[(int) JuraMachineStateIdentifier::VenturiPumping], SUBSTR_INDEX_VENTURI_PUMPING, 0, 1)){
+    if (didUpdateJuraHeatedBeverageValue(JuraMachineStateIdentifier::VenturiPumping, SUBSTR_INDEX_VENTURI_PUMPING, 0, 1)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::VenturiPumping, states[(int) JuraMachineStateIdentifier::VenturiPumping])){
-        last_changed[(int) JuraMachineStateIdentifier::VenturiPumping] = millis();
+        states.touch(JuraMachineStateIdentifier::VenturiPumping, millis());
       }
     }
 
@@ -2546,49 +2612,49 @@ void JuraMachine::handleBeanHopperCoverOpen(){
   if (_cs.didUpdate(iterator, _bridge->servicePort)){
  
     /* -------------- THERMOBLOCK TEMPERATURE -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockTemperature], SUBSTR_DEC_INDEX_THERMOBLOCK_TEMPERATURE, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::ThermoblockTemperature, SUBSTR_DEC_INDEX_THERMOBLOCK_TEMPERATURE, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
       int _temp = states[(int) JuraMachineStateIdentifier::ThermoblockTemperature] / 10.0;
       handleThermoblockTemperature(_temp);
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockTemperature, _temp)){
-        last_changed[(int) JuraMachineStateIdentifier::ThermoblockTemperature] = millis();
+        states.touch(JuraMachineStateIdentifier::ThermoblockTemperature, millis());
       }
     }
 
     /* -------------- BREW GROUP OUTPUT POSITION -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::BrewGroupOutputStatus], SUBSTR_DEC_INDEX_OUTPUT_STATUS, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::BrewGroupOutputStatus, SUBSTR_DEC_INDEX_OUTPUT_STATUS, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
       handleBrewGroupOutput();  
     }
 
     /* -------------- LAST DISPENSE ML -------------- */
     int prior_dispense = states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume];
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume], SUBSTR_DEC_INDEX_LAST_DISPENSE_PUMPED_WATER_VOLUME_ML, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume, SUBSTR_DEC_INDEX_LAST_DISPENSE_PUMPED_WATER_VOLUME_ML, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::LastDispensePumpedWaterVolume, states[(int) JuraMachineStateIdentifier::LastDispensePumpedWaterVolume]* DISPENSED_ML_CALIBRATION_COEFFICIENT_DEFAULT)){
         handleLastDispenseChange(prior_dispense);
       }  
     }
 
     /* -------------- PROGRAM STATE? -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::BrewProgramNumericState], SUBSTR_DEC_INDEX_CIRCUIT_READY_STATE, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::BrewProgramNumericState, SUBSTR_DEC_INDEX_CIRCUIT_READY_STATE, 1, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Decimal)){
       //_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewProgramIsReady, states[(int) JuraMachineStateIdentifier::BrewProgramNumericState] == 260);
     }
 
     /* -------------- CERAMIC VALVE POSITION -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::CeramicValvePosition], SUBSTR_BIN_INDEX_CERAMIC_VALVE_POSITION, 4, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Binary)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::CeramicValvePosition, SUBSTR_BIN_INDEX_CERAMIC_VALVE_POSITION, 4, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Binary)){
       handleCeramicValve();
     }
 
     /* -------------- THERMOBLOCK ACTIVE -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::ThermoblockDutyCycle], SUBSTR_BIN_INDEX_THERMOBLOCK_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::ThermoblockDutyCycle, SUBSTR_BIN_INDEX_THERMOBLOCK_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockDutyCycle, states[(int) JuraMachineStateIdentifier::ThermoblockDutyCycle] * 10)){
-        last_changed[(int) JuraMachineStateIdentifier::ThermoblockDutyCycle] = millis();
+        states.touch(JuraMachineStateIdentifier::ThermoblockDutyCycle, millis());
       }
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::ThermoblockActive, states[(int) JuraMachineStateIdentifier::ThermoblockDutyCycle] != 0)){
-        last_changed[(int) JuraMachineStateIdentifier::ThermoblockActive] = millis();;
+        states.touch(JuraMachineStateIdentifier::ThermoblockActive, millis());;
       }
     }
 
     /* -------------- PUMP ACTIVE -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::PumpDutyCycle], SUBSTR_BIN_INDEX_PUMP_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::PumpDutyCycle, SUBSTR_BIN_INDEX_PUMP_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
 
       /* because our sampling rate doesn't work well for PEP extraction, we only set the pump to off when the output and ceramic valves are not in a special mode */
       int pump_duty_cycle = states[(int) JuraMachineStateIdentifier::PumpDutyCycle];
@@ -2597,61 +2663,64 @@ void JuraMachine::handleBeanHopperCoverOpen(){
       if (pump_duty_cycle == 0 && (states[(int) JuraMachineStateIdentifier::VenturiPumping] == 0) ){
 
         if (states[(int) JuraMachineStateIdentifier::CeramicValvePosition] == 3 && states[(int) JuraMachineStateIdentifier::BrewGroupOutputStatus] == 1 ){
-          states[(int) JuraMachineStateIdentifier::PumpActive] = (pump_duty_cycle > 0);
+          states.commit(JuraMachineStateIdentifier::PumpActive, (pump_duty_cycle > 0));
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::PumpDutyCycle, pump_duty_cycle * 10)){
-            last_changed[(int) JuraMachineStateIdentifier::PumpDutyCycle] = millis();
+            states.touch(JuraMachineStateIdentifier::PumpDutyCycle, millis());
           }
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::PumpActive, pump_duty_cycle > 0)){
-            last_changed[(int) JuraMachineStateIdentifier::PumpActive] = millis();
+            states.touch(JuraMachineStateIdentifier::PumpActive, millis());
           }
         
         }else{
-          states[(int) JuraMachineStateIdentifier::PumpActive] = (pump_duty_cycle > 0);
+          states.commit(JuraMachineStateIdentifier::PumpActive, (pump_duty_cycle > 0));
           if(_bridge->machineStateChanged(JuraMachineStateIdentifier::PumpActive, pump_duty_cycle > 0)){
-            last_changed[(int) JuraMachineStateIdentifier::PumpActive] = millis();
+            states.touch(JuraMachineStateIdentifier::PumpActive, millis());
           }
         }
       }else{
-        states[(int) JuraMachineStateIdentifier::PumpActive] = true;
+        states.commit(JuraMachineStateIdentifier::PumpActive, true);
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::PumpDutyCycle, pump_duty_cycle * 10.0)){
-          last_changed[(int) JuraMachineStateIdentifier::PumpDutyCycle] = millis();
+          states.touch(JuraMachineStateIdentifier::PumpDutyCycle, millis());
         }
         if(_bridge->machineStateChanged(JuraMachineStateIdentifier::PumpActive, true)){
-          last_changed[(int) JuraMachineStateIdentifier::PumpActive] = millis();
+          states.touch(JuraMachineStateIdentifier::PumpActive, millis());
         }
       }
     }
 
     /* -------------- GRINDER ACTIVE -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::GrinderDutyCycle], SUBSTR_BIN_INDEX_GRINDER_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::GrinderDutyCycle, SUBSTR_BIN_INDEX_GRINDER_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::GrinderDutyCycle, states[(int) JuraMachineStateIdentifier::GrinderDutyCycle] * 10)){
-        last_changed[(int) JuraMachineStateIdentifier::GrinderDutyCycle] = millis();
+        states.touch(JuraMachineStateIdentifier::GrinderDutyCycle, millis());
       }
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::GrinderActive, states[(int) JuraMachineStateIdentifier::GrinderDutyCycle] != 0)){
-        last_changed[(int) JuraMachineStateIdentifier::GrinderActive] = millis();
+        states.touch(JuraMachineStateIdentifier::GrinderActive, millis());
         /* true grinder state change; what to do? */
         if (states[(int) JuraMachineStateIdentifier::GrinderActive] == true){
-          states[(int) JuraMachineStateIdentifier::HasDose] = true;
+          states.commit(JuraMachineStateIdentifier::HasDose, true);
           _bridge->machineStateChanged(JuraMachineStateIdentifier::HasDose,true);
         }
       };
-      states[(int) JuraMachineStateIdentifier::GrinderActive] = states[(int) JuraMachineStateIdentifier::GrinderDutyCycle] != 0;
+      states.commit(JuraMachineStateIdentifier::GrinderActive, states[(int) JuraMachineStateIdentifier::GrinderDutyCycle] != 0);
     }
 
     /* -------------- BREW GROUP DUTY CYCLE -------------- */
-    if (didUpdateJuraSystemCircuitValue(&this->states[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle], SUBSTR_BIN_INDEX_BREW_GROUP_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
+    if (didUpdateJuraSystemCircuitValue(JuraMachineStateIdentifier::BrewGroupDutyCycle, SUBSTR_BIN_INDEX_BREW_GROUP_DUTY_CYCLE, 12, JuraSystemCircuitryBinaryResponseInterpretation::AsReported, JuraSystemCircuitryResponseDataType::Hamming)){
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewGroupDutyCycle, states[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle] * 10)){
-        last_changed[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle] = millis();
+        states.touch(JuraMachineStateIdentifier::BrewGroupDutyCycle, millis());
       }
       if(_bridge->machineStateChanged(JuraMachineStateIdentifier::BrewGroupActive, states[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle] != 0)){
-        last_changed[(int) JuraMachineStateIdentifier::BrewGroupActive] = millis();
+        states.touch(JuraMachineStateIdentifier::BrewGroupActive, millis());
       }
-      states[(int) JuraMachineStateIdentifier::BrewGroupActive] = states[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle] != 0;
+      states.commit(JuraMachineStateIdentifier::BrewGroupActive, states[(int) JuraMachineStateIdentifier::BrewGroupDutyCycle] != 0);
     }
 
     /* unhandled changes for reporting */
     if (_cs.hasUnhandledUpdate() && PRINT_UNHANDLED){_cs.printUnhandledUpdate();}
   }
+
+  /* ---------------------- SHOT PROFILE  ---------------------- */
+  handleShotProfile();
   
   /* ---------------------- CALCULATED STATES FOLLOW  ---------------------- */
   if (handleErrorStateChange(iterator, POLL_DUTY_FULL)){
@@ -2689,7 +2758,7 @@ void JuraMachine::handleBeanHopperCoverOpen(){
         
         /* protect updating of the system is ready flag */
         xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
-        states[(int) JuraMachineStateIdentifier::SystemIsReady] = true; 
+        states.commit(JuraMachineStateIdentifier::SystemIsReady, true); 
         xSemaphoreGive(xMachineReadyStateVariableSemaphore);
 
         /* parse out ready state */
@@ -2761,10 +2830,33 @@ void JuraMachine::handleBeanHopperCoverOpen(){
     xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
 
     /* set ready state globally */
-    states[(int) JuraMachineStateIdentifier::SystemIsReady] = isReady;
+    states.commit(JuraMachineStateIdentifier::SystemIsReady, isReady);
 
     /* set binary system ready */
     _bridge->machineStateChanged(JuraMachineStateIdentifier::SystemIsReady, states[(int) JuraMachineStateIdentifier::SystemIsReady]) ;
     xSemaphoreGive(xMachineReadyStateVariableSemaphore);
   }
+
+  /* wake tasks waiting on machine events */
+  xSemaphoreTake( xMachineReadyStateVariableSemaphore, portMAX_DELAY );
+  signalMachineEvents();
+  xSemaphoreGive(xMachineReadyStateVariableSemaphore);
+
+  /* research scan; only due in plans that list it */
+  _eeprom_scan_completed |= eepromScanner.step(iterator, _bridge->servicePort);
+  _working_memory_changed |= workingMemory.step(iterator, _bridge->servicePort);
+
+  /* publish outside the semaphore */
+  if (_latency_completed){
+    _latency_completed = false;
+    _bridge->publishDrinkLatency(latency);
+  }
+  if (_eeprom_scan_completed){
+    _eeprom_scan_completed = false;
+    _bridge->publishEepromScan(eepromScanner);
+  }
+  if (_working_memory_changed){
+    _working_memory_changed = false;
+    _bridge->publishWorkingMemory(workingMemory);
+  }
 }
@@ -1,11 +1,12 @@
 #ifndef JURAMACHINE_H
 #define JURAMACHINE_H
 #include "JuraConfiguration.h"
-#include "JuraMemoryLine.h"
-#include "JuraWorkingMemory.h"
-#include "JuraInputControlBoard.h"
-#include "JuraHeatedBeverage.h"
-#include "JuraSystemCircuitry.h"
+#include "JuraResponseLayouts.h"
+#include "JuraShotProfile.h"
+#include "JuraLatency.h"
+#include "JuraEepromScanner.h"
+#include "JuraWorkingMemoryScanner.h"
+#include "JuraStateStore.h"
 
 /* string index (left to right) locations of useful values: DO NOT MODIFY!!! */
 
@@ -336,18 +337,38 @@
 /* state histiory */
 #define MAX_STATE_EVENT_HISTORY 20
 #define MAX_DISPENSE_SAMPLES 20
+#define POLL_PLAN_UNAPPLIED -2
+
+/* machine event group bits; levels stay set while true, edges stay set until a waiter clears them */
+#define MACHINE_EVENT_READY             (1 << 0)
+#define MACHINE_EVENT_NOT_READY         (1 << 1)
+#define MACHINE_EVENT_READY_ROSE        (1 << 2)
+#define MACHINE_EVENT_READY_FELL        (1 << 3)
+#define MACHINE_EVENT_PUMP_ON           (1 << 4)
+#define MACHINE_EVENT_PUMP_OFF          (1 << 5)
+#define MACHINE_EVENT_PUMP_STARTED      (1 << 6)
+#define MACHINE_EVENT_PUMP_STOPPED      (1 << 7)
+#define MACHINE_EVENT_BREW_GROUP_READY  (1 << 8)
+#define MACHINE_EVENT_DISPENSING        (1 << 9)
+#define MACHINE_EVENT_NOT_DISPENSING    (1 << 10)
+#define MACHINE_EVENT_DISPENSE_STARTED  (1 << 11)
+#define MACHINE_EVENT_DISPENSE_STOPPED  (1 << 12)
+#define MACHINE_EVENT_ERROR             (1 << 13)
+#define MACHINE_EVENT_NO_ERROR          (1 << 14)
+#define MACHINE_EVENT_ERROR_RAISED      (1 << 15)
+#define MACHINE_EVENT_ERROR_CLEARED     (1 << 16)
+#define MACHINE_EVENT_WAIT_FOREVER      -1
 
 /* forward declaration */
 class JuraBridge; 
 
 class JuraMachine {
 public:
-  JuraMachine(JuraBridge &, SemaphoreHandle_t &);
+  JuraMachine(JuraBridge &, SemaphoreHandle_t &, EventGroupHandle_t &);
   void handlePoll(int);
   
-  /* machine statess */
-  int states[199];
-  int last_changed[199]; 
+  /* machine states; value, change time and dirty bit per identifier */
+  JuraStateStore states;
   
   /* dispense limit*/
   void resetDispenseLimits();
@@ -357,6 +378,16 @@ public:
   /* addshot */
   void startAddShotPreparation();
 
+  /* the service port went offline; polling has stopped until it answers again */
+  void markDisconnected();
+
+  /* while held, no automatic rinse prompts are issued on idle (order queue running) */
+  void holdAutomaticMaintenance(bool hold) {_maintenance_held = hold;}
+
+  /* block until machine events are set, or timeout (ms); returns the bits set at return */
+  EventBits_t awaitMachineEvents(EventBits_t, bool, int);
+  void clearMachineEvents(EventBits_t);
+
   /* meta calculated states */
   int operationalStateHistory[MAX_STATE_EVENT_HISTORY];
   int dispenseHistory[MAX_STATE_EVENT_HISTORY];
@@ -372,6 +403,18 @@ public:
   int flowRateSamples[MAX_DISPENSE_SAMPLES];
   int timestampSamples[MAX_DISPENSE_SAMPLES];
 
+  /* full trace of each dispense, compressed */
+  JuraShotProfileRecorder shotProfiles;
+
+  /* milestones of every drink, command to ready */
+  JuraLatencyRecorder latency;
+
+  /* research; every RT: word while idle or ready */
+  JuraEepromScanner eepromScanner;
+
+  /* research; RM: working memory while idle or ready, watch points during dispenses */
+  JuraWorkingMemoryScanner workingMemory;
+
   /* non captured tracked states */
   int thermoblock_status = 0;
   int flow_meter_state = 0; 
@@ -391,6 +434,20 @@ private:
   JuraBridge * _bridge;
   SemaphoreHandle_t & xMachineReadyStateVariableSemaphore;
   SemaphoreHandle_t xDispenseLimitSemaphore; 
+  EventGroupHandle_t & xMachineEvents;
+  volatile bool _maintenance_held = false;
+
+  /* last signaled levels; -1 until first signal */
+  int _signaled_ready = -1;
+  int _signaled_pump = -1;
+  int _signaled_brew_group_ready = -1;
+  int _signaled_dispensing = -1;
+  int _signaled_error = -1;
+  bool _latency_completed = false;
+  bool _eeprom_scan_completed = false;
+  bool _working_memory_changed = false;
+  void signalMachineEvents();
+  void signalMachineEventLevel(int, int &, EventBits_t, EventBits_t, EventBits_t, EventBits_t, EventBits_t &, EventBits_t &);
 
   /* value/history characterization values */
   JuraMachineOperationalStateFlowRateType characterizeFlowRate(int);
@@ -421,8 +478,10 @@ private:
   JuraHeatedBeverage _hz;
   JuraSystemCircuitry _cs;
 
-  /*ram locations*/
-  JuraWorkingMemory _rm00;
+  /* poll plans; applied on operational state transitions */
+  int _poll_plan_state = POLL_PLAN_UNAPPLIED;
+  void setPollRate(JuraPollSource, int);
+  void applyPollPlan(const JuraPollPlanEntry *, int);
 
   /* ensuring values fall in ranges*/
   int filteredLong(int, int, int);
@@ -436,10 +495,10 @@ private:
   void determineReadyStateType();
 
   /* convenience function for handling common types (e.g., long in this case) */
-  bool didUpdateJuraMemoryLineValue         (JuraMemoryLine *, int *, int, int, int);
-  bool didUpdateJuraInputControlBoardValue  (int *, int, int, JuraInputBoardBinaryResponseInterpretation);
-  bool didUpdateJuraHeatedBeverageValue     (int*, int, int, int);
-  bool didUpdateJuraSystemCircuitValue      (int*, int, int, JuraSystemCircuitryBinaryResponseInterpretation, JuraSystemCircuitryResponseDataType);
+  bool didUpdateJuraMemoryLineValue         (JuraMemoryLine *, JuraMachineStateIdentifier, int, int, int);
+  bool didUpdateJuraInputControlBoardValue  (JuraMachineStateIdentifier, int, int, JuraInputBoardBinaryResponseInterpretation);
+  bool didUpdateJuraHeatedBeverageValue     (JuraMachineStateIdentifier, int, int, int);
+  bool didUpdateJuraSystemCircuitValue      (JuraMachineStateIdentifier, int, int, JuraSystemCircuitryBinaryResponseInterpretation, JuraSystemCircuitryResponseDataType);
 
   /* special repeated handlers*/
   void handleLastDispenseChange             (int);
@@ -447,6 +506,14 @@ private:
   void handleThermoblockTemperature         (int);
   void handleBrewGroupOutput                ();
   void handleCeramicValve                   ();
+  void handleShotProfile                    ();
+  void startShotProfile                     (unsigned long);
+
+  /* dispense type of the profile being recorded; matches LastDispenseType */
+  int _shot_profile_dispense_type = 2;
+
+  /* dispense start signaled, profile not yet opened by the poll task; 0 if none */
+  volatile unsigned long _shot_profile_start_at = 0;
 
 };
 
@@ -0,0 +1,131 @@
+#include "JuraMemoryMonitor.h"
+#include "esp_heap_caps.h"
+
+JuraMemoryPath JuraMemoryMonitor::_paths[JURA_MEMORY_PROFILE_PATHS_MAX];
+int JuraMemoryMonitor::_path_count = 0;
+portMUX_TYPE JuraMemoryMonitor::_path_lock = portMUX_INITIALIZER_UNLOCKED;
+
+JuraMemoryMonitor::JuraMemoryMonitor() {
+  _heap = {0, 0, 0, 0};
+}
+
+/* a task started from the topology; its configured stack is kept for reporting */
+void JuraMemoryMonitor::watch(JuraTask task, const char * name, int stack, TaskHandle_t handle){
+  portENTER_CRITICAL(&_lock);
+  if (_task_count < JURA_MEMORY_TASKS_MAX){
+    _tasks[_task_count++] = {task, name, stack, handle, (uint32_t) stack};
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Read the high water mark of every watched task and the internal heap.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraMemoryMonitor::sample(){
+  uint32_t headroom[JURA_MEMORY_TASKS_MAX];
+  int count = taskCount();
+  for (int i = 0; i < count; i++){
+    headroom[i] = uxTaskGetStackHighWaterMark(_tasks[i].handle);
+  }
+
+  JuraHeapMemory heap;
+  heap.free =     heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  heap.minimum =  heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  heap.largest =  heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  heap.fragmentation = heap.free > 0 ? 100 - (int) ((uint64_t) heap.largest * 100 / heap.free) : 0;
+
+  portENTER_CRITICAL(&_lock);
+  for (int i = 0; i < count; i++){_tasks[i].headroom = headroom[i];}
+  _heap = heap;
+  portEXIT_CRITICAL(&_lock);
+}
+
+int JuraMemoryMonitor::taskCount(){
+  portENTER_CRITICAL(&_lock);
+  int count = _task_count;
+  portEXIT_CRITICAL(&_lock);
+  return count;
+}
+
+bool JuraMemoryMonitor::task(int index, JuraTaskMemory &memory){
+  portENTER_CRITICAL(&_lock);
+  bool found = index >= 0 && index < _task_count;
+  if (found){memory = _tasks[index];}
+  portEXIT_CRITICAL(&_lock);
+  return found;
+}
+
+JuraHeapMemory JuraMemoryMonitor::heap(){
+  portENTER_CRITICAL(&_lock);
+  JuraHeapMemory heap = _heap;
+  portEXIT_CRITICAL(&_lock);
+  return heap;
+}
+
+/* least stack left on any task; the one to watch when budgets are cut */
+uint32_t JuraMemoryMonitor::minimumHeadroom(){
+  uint32_t minimum = 0xFFFFFFFF;
+  portENTER_CRITICAL(&_lock);
+  for (int i = 0; i < _task_count; i++){
+    if (_tasks[i].headroom < minimum){minimum = _tasks[i].headroom;}
+  }
+  portEXIT_CRITICAL(&_lock);
+  return _task_count > 0 ? minimum : 0;
+}
+
+/* low water marks of the calling task and the heap before the path runs */
+void JuraMemoryMonitor::enterPath(uint32_t &headroom, uint32_t &heap){
+  headroom = uxTaskGetStackHighWaterMark(NULL);
+  heap = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+}
+
+/***************************************************************************//**
+ * Attribute any new low water mark set since enterPath to the path. Marks only
+ * ever fall, so a path that does not lower one left it where it was.
+ *
+ * @param[out] null
+ *
+ * @param[in] const char *name
+ * @param[in] uint32_t headroom, heap at entry
+ ******************************************************************************/
+void JuraMemoryMonitor::leavePath(const char * name, uint32_t headroomBefore, uint32_t heapBefore){
+  uint32_t headroom = uxTaskGetStackHighWaterMark(NULL);
+  uint32_t heap = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  const char * taskName = pcTaskGetName(NULL);
+
+  portENTER_CRITICAL(&_path_lock);
+  int i = 0;
+  while (i < _path_count && _paths[i].name != name){i++;}
+  if (i == _path_count){
+    if (_path_count == JURA_MEMORY_PROFILE_PATHS_MAX){
+      portEXIT_CRITICAL(&_path_lock);
+      return;
+    }
+    _paths[_path_count++] = {name, taskName, 0xFFFFFFFF, 0xFFFFFFFF, 0};
+  }
+
+  JuraMemoryPath &path = _paths[i];
+  path.calls++;
+  if (headroom < headroomBefore && headroom < path.headroom){path.headroom = headroom; path.task = taskName;}
+  if (heap < heapBefore && heap < path.heapLow){path.heapLow = heap;}
+  portEXIT_CRITICAL(&_path_lock);
+}
+
+int JuraMemoryMonitor::pathCount(){
+  portENTER_CRITICAL(&_path_lock);
+  int count = _path_count;
+  portEXIT_CRITICAL(&_path_lock);
+  return count;
+}
+
+bool JuraMemoryMonitor::path(int index, JuraMemoryPath &path){
+  portENTER_CRITICAL(&_path_lock);
+  bool found = index >= 0 && index < _path_count;
+  if (found){path = _paths[index];}
+  portEXIT_CRITICAL(&_path_lock);
+  return found;
+}
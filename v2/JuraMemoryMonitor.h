@@ -0,0 +1,91 @@
+#ifndef JURAMEMORYMONITOR_H
+#define JURAMEMORYMONITOR_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* one task; headroom is stack never used since the task started (bytes) */
+struct JuraTaskMemory {
+  JuraTask task;
+  const char * name;
+  int stack;
+  TaskHandle_t handle;
+  uint32_t headroom;
+};
+
+/* internal ram, bytes; fragmentation is the share of free heap outside the largest block */
+struct JuraHeapMemory {
+  uint32_t free;
+  uint32_t minimum;
+  uint32_t largest;
+  int fragmentation;
+};
+
+/* profiling: low water marks a code path set while it ran */
+struct JuraMemoryPath {
+  const char * name;
+  const char * task;
+  uint32_t headroom;    /* task stack left at the deepest point the path reached; 0xFFFFFFFF if it never set the mark */
+  uint32_t heapLow;     /* lowest free heap the path drove the bridge to; 0xFFFFFFFF if never */
+  uint32_t calls;
+};
+
+/*
+
+  name:         JuraMemoryMonitor
+  type:         class
+  description:  samples the stack high water mark of every task started from
+                the task topology, and free heap, the minimum ever free, the
+                largest free block and fragmentation of internal ram.
+
+                with MEMORY_PROFILING, instrumented code paths record whether
+                they set a new stack or heap low water mark while running, so
+                the path that sizes each task's stack can be found.
+
+*/
+class JuraMemoryMonitor {
+public:
+  JuraMemoryMonitor();
+
+  void watch(JuraTask, const char *, int, TaskHandle_t);
+  void sample();
+
+  int taskCount();
+  bool task(int, JuraTaskMemory &);
+  JuraHeapMemory heap();
+  uint32_t minimumHeadroom();
+
+  /* profiling; paths are kept by name pointer, so pass literals */
+  static void enterPath(uint32_t &, uint32_t &);
+  static void leavePath(const char *, uint32_t, uint32_t);
+  static int pathCount();
+  static bool path(int, JuraMemoryPath &);
+
+private:
+  JuraTaskMemory _tasks[JURA_MEMORY_TASKS_MAX];
+  int _task_count = 0;
+  JuraHeapMemory _heap;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  static JuraMemoryPath _paths[JURA_MEMORY_PROFILE_PATHS_MAX];
+  static int _path_count;
+  static portMUX_TYPE _path_lock;
+};
+
+/* profiles the enclosing scope */
+class JuraMemoryProfileScope {
+public:
+  JuraMemoryProfileScope(const char * name) : _name(name) {JuraMemoryMonitor::enterPath(_headroom, _heap);}
+  ~JuraMemoryProfileScope() {JuraMemoryMonitor::leavePath(_name, _headroom, _heap);}
+private:
+  const char * _name;
+  uint32_t _headroom;
+  uint32_t _heap;
+};
+
+#if MEMORY_PROFILING
+#define JURA_MEMORY_PROFILE(path) JuraMemoryProfileScope _memoryProfileScope(path)
+#else
+#define JURA_MEMORY_PROFILE(path)
+#endif
+
+#endif
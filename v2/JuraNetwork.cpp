@@ -0,0 +1,179 @@
+#include "JuraNetwork.h"
+#include "Preferences.h"
+#include "PubSubClient.h"
+
+/* wi-fi event bits; set from the wi-fi event task */
+#define NETWORK_EVENT_WIFI_UP       (1 << 0)
+#define NETWORK_EVENT_WIFI_DOWN     (1 << 1)
+
+static EventGroupHandle_t xNetworkEvents;
+static volatile int lastDisconnectReason = 0;
+
+JuraNetworkManager::JuraNetworkManager(PubSubClient &mqtt, Preferences &prefsRef) : _mqtt(mqtt), preferences(prefsRef) {
+  memset(&_cache, 0, sizeof(_cache));
+  memset(&_status, 0, sizeof(_status));
+}
+
+/***************************************************************************//**
+ * Read the cached access point and hand reconnection to this class: the
+ * core's own reconnect and credential writes are turned off.
+ *
+ * @param[out] null
+ *
+ * @param[in] const char *ssid
+ * @param[in] const char *pass
+ ******************************************************************************/
+void JuraNetworkManager::begin(const char * ssid, const char * pass){
+  _ssid = ssid;
+  _pass = pass;
+  xNetworkEvents = xEventGroupCreate();
+
+  if (preferences.getBytesLength(PREF_NETWORK_CACHE_KEY) == sizeof(JuraNetworkCache)){
+    JuraNetworkCache cache;
+    preferences.getBytes(PREF_NETWORK_CACHE_KEY, &cache, sizeof(cache));
+    if (cache.version == JURA_NETWORK_CACHE_VERSION){_cache = cache;}
+  }
+
+  WiFi.persistent(false);
+  WiFi.mode(WIFI_STA);
+  WiFi.setAutoReconnect(false);
+  WiFi.onEvent(onWiFiEvent);
+}
+
+void JuraNetworkManager::onWiFiEvent(WiFiEvent_t event, WiFiEventInfo_t info){
+  if (xNetworkEvents == NULL){return;}
+  switch (event){
+    case ARDUINO_EVENT_WIFI_STA_GOT_IP:
+      xEventGroupClearBits(xNetworkEvents, NETWORK_EVENT_WIFI_DOWN);
+      xEventGroupSetBits(xNetworkEvents, NETWORK_EVENT_WIFI_UP);
+      break;
+    case ARDUINO_EVENT_WIFI_STA_DISCONNECTED:
+      lastDisconnectReason = info.wifi_sta_disconnected.reason;
+      /* fall through */
+    case ARDUINO_EVENT_WIFI_STA_LOST_IP:
+      xEventGroupClearBits(xNetworkEvents, NETWORK_EVENT_WIFI_UP);
+      xEventGroupSetBits(xNetworkEvents, NETWORK_EVENT_WIFI_DOWN);
+      break;
+    default:
+      break;
+  }
+}
+
+/* next delay of a link, doubled for the one after; +-25% jitter so a house full of devices does not retry in step */
+unsigned long JuraNetworkManager::backoff(unsigned long &current){
+  current = current == 0 ? JURA_NETWORK_BACKOFF_MIN_MS : (current * 2 > JURA_NETWORK_BACKOFF_MAX_MS ? JURA_NETWORK_BACKOFF_MAX_MS : current * 2);
+  return current - current / 4 + esp_random() % (current / 2 + 1);
+}
+
+bool JuraNetworkManager::wifiAttemptDue(){
+  return (long) (millis() - _wifi_next) >= 0;
+}
+
+bool JuraNetworkManager::brokerAttemptDue(){
+  return (long) (millis() - _broker_next) >= 0;
+}
+
+/***************************************************************************//**
+ * Associate, straight to the cached access point if there is one and it did
+ * not just fail, and wait for an ip. On success the access point is cached.
+ *
+ * @param[out] bool wi-fi connected
+ *
+ * @param[in] null
+ ******************************************************************************/
+bool JuraNetworkManager::connectWiFi(){
+  bool fast = _use_cache && _cache.channel != 0;
+  _status.wifiAttempts++;
+
+  xEventGroupClearBits(xNetworkEvents, NETWORK_EVENT_WIFI_UP | NETWORK_EVENT_WIFI_DOWN);
+  WiFi.disconnect();
+  if (fast){
+    WiFi.begin(_ssid, _pass, _cache.channel, _cache.bssid, true);
+  } else {
+    WiFi.begin(_ssid, _pass);
+  }
+
+  EventBits_t bits = xEventGroupWaitBits(xNetworkEvents, NETWORK_EVENT_WIFI_UP, pdFALSE, pdFALSE, pdMS_TO_TICKS(JURA_NETWORK_WIFI_TIMEOUT_MS));
+  if (!(bits & NETWORK_EVENT_WIFI_UP) || WiFi.status() != WL_CONNECTED){
+    /* the access point moved or is gone; scan next time, without waiting */
+    if (fast){
+      _use_cache = false;
+      _wifi_next = millis();
+    } else {
+      _wifi_next = millis() + backoff(_wifi_backoff);
+    }
+    ESP_LOGI(TAG,"--> Wi-Fi: attempt %u failed (%s), reason %d", _status.wifiAttempts, fast ? "cached ap" : "scan", lastDisconnectReason);
+    return false;
+  }
+
+  _wifi_backoff = 0;
+  _use_cache = true;
+  _status.fastReassociation = fast;
+  if (_down_at != 0 && _wifi_lost){_status.lastWiFiMs = millis() - _down_at;}
+  storeCache();
+  return true;
+}
+
+/***************************************************************************//**
+ * One broker connect with a last will.
+ *
+ * @param[out] bool broker connected
+ *
+ * @param[in] const char *client id
+ * @param[in] const char *user
+ * @param[in] const char *pass
+ * @param[in] const char *willTopic published "OFF", not retained, if the bridge drops
+ ******************************************************************************/
+bool JuraNetworkManager::connectBroker(const char * id, const char * user, const char * pass, const char * willTopic){
+  _status.brokerAttempts++;
+  if (!_mqtt.connect(id, user, pass, willTopic, 0, false, "OFF", true)){
+    _broker_next = millis() + backoff(_broker_backoff);
+    ESP_LOGI(TAG,"--> MQTT: attempt %u failed, state %d", _status.brokerAttempts, _mqtt.state());
+    return false;
+  }
+  _broker_backoff = 0;
+  return true;
+}
+
+void JuraNetworkManager::markDown(){
+  if (_down_at != 0){return;}
+  _down_at = millis();
+  if (_down_at == 0){_down_at = 1;}
+  _wifi_lost = WiFi.status() != WL_CONNECTED;
+  _status.lastReason = lastDisconnectReason;
+}
+
+void JuraNetworkManager::markUp(){
+  if (_down_at != 0 && _connected_once){
+    unsigned long recovery = millis() - _down_at;
+    _status.recoveries++;
+    _status.lastRecoveryMs = recovery;
+    if (recovery > _status.maxRecoveryMs){_status.maxRecoveryMs = recovery;}
+    ESP_LOGI(TAG,"--> Network: recovered in %lu ms", recovery);
+  }
+  _down_at = 0;
+  _connected_once = true;
+}
+
+void JuraNetworkManager::await(unsigned long ms){
+  xEventGroupWaitBits(xNetworkEvents, NETWORK_EVENT_WIFI_UP | NETWORK_EVENT_WIFI_DOWN, pdTRUE, pdFALSE, pdMS_TO_TICKS(ms));
+}
+
+void JuraNetworkManager::storeCache(){
+  uint8_t * bssid = WiFi.BSSID();
+  int channel = WiFi.channel();
+  if (bssid == NULL || channel <= 0){return;}
+  if (_cache.channel == channel && memcmp(_cache.bssid, bssid, sizeof(_cache.bssid)) == 0){return;}
+
+  _cache.version = JURA_NETWORK_CACHE_VERSION;
+  _cache.channel = channel;
+  memcpy(_cache.bssid, bssid, sizeof(_cache.bssid));
+  preferences.putBytes(PREF_NETWORK_CACHE_KEY, &_cache, sizeof(_cache));
+}
+
+JuraNetworkStatus JuraNetworkManager::status(){
+  JuraNetworkStatus status = _status;
+  status.channel = WiFi.channel();
+  status.rssi = WiFi.RSSI();
+  return status;
+}
@@ -0,0 +1,103 @@
+#ifndef JURANETWORK_H
+#define JURANETWORK_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+#include <WiFi.h>
+
+/* forward declarations */
+class Preferences;
+class PubSubClient;
+
+/* access point of the last association; stored in nvs as is */
+#define JURA_NETWORK_CACHE_VERSION  1
+struct JuraNetworkCache {
+  uint8_t version;
+  uint8_t channel;              /* 0: none */
+  uint8_t bssid[6];
+};
+
+/* snapshot for reporting */
+struct JuraNetworkStatus {
+  uint32_t recoveries;          /* broker connected again after a loss, since boot */
+  unsigned long lastRecoveryMs; /* loss to broker connected */
+  unsigned long maxRecoveryMs;
+  unsigned long lastWiFiMs;     /* loss to ip, if wi-fi was lost */
+  uint32_t wifiAttempts;        /* since boot */
+  uint32_t brokerAttempts;
+  bool fastReassociation;       /* the last association used the cached access point */
+  int channel;
+  int rssi;
+  int lastReason;               /* wi-fi disconnect reason of the last loss */
+};
+
+/*
+
+  name:         JuraNetworkManager
+  type:         class
+  description:  wi-fi and broker links for the communications task, driven by
+                wi-fi events. a loss wakes the task at once; an attempt waits
+                for the ip event rather than sleeping a fixed time.
+
+                the access point (bssid and channel) of the last association
+                is kept in nvs, so a reconnect skips the scan. if that fails the
+                next attempt scans. failed attempts back off exponentially from
+                JURA_NETWORK_BACKOFF_MIN_MS to JURA_NETWORK_BACKOFF_MAX_MS with
+                jitter, per link; the bridge is never restarted for a network
+                outage. time from a loss to the broker being connected again is
+                kept for reporting.
+
+*/
+class JuraNetworkManager {
+public:
+  JuraNetworkManager(PubSubClient &, Preferences &);
+
+  /* station mode and events; call after preferences are opened */
+  void begin(const char *, const char *);
+
+  /* an attempt on this link is due */
+  bool wifiAttemptDue();
+  bool brokerAttemptDue();
+
+  /* one attempt, waiting at most JURA_NETWORK_WIFI_TIMEOUT_MS for an ip */
+  bool connectWiFi();
+  bool connectBroker(const char *, const char *, const char *, const char *);
+
+  /* broker or wi-fi found down; the first call of an outage starts its clock */
+  void markDown();
+
+  /* broker connected; ends the outage */
+  void markUp();
+
+  /* sleep until the timeout, or a wi-fi link event */
+  void await(unsigned long);
+
+  JuraNetworkStatus status();
+
+private:
+  PubSubClient &_mqtt;
+  Preferences &preferences;
+  const char * _ssid = "";
+  const char * _pass = "";
+
+  JuraNetworkCache _cache;
+  bool _use_cache = true;
+
+  /* outage */
+  unsigned long _down_at = 0;   /* 0: up */
+  bool _wifi_lost = false;
+  bool _connected_once = false;
+
+  /* backoff per link */
+  unsigned long _wifi_backoff = 0;
+  unsigned long _wifi_next = 0;
+  unsigned long _broker_backoff = 0;
+  unsigned long _broker_next = 0;
+
+  JuraNetworkStatus _status;
+
+  static void onWiFiEvent(WiFiEvent_t, WiFiEventInfo_t);
+  static unsigned long backoff(unsigned long &);
+  void storeCache();
+};
+
+#endif
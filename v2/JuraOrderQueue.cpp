@@ -0,0 +1,293 @@
+#include "JuraOrderQueue.h"
+#include "JuraMemoryMonitor.h"
+
+JuraOrderQueue::JuraOrderQueue(JuraMachine &machine, JuraBridge &bridge, JuraRecipeEngine &recipes, JuraRecipeProgramStore &programs) : _machine(&machine), _bridge(&bridge), _recipes(&recipes), _programs(&programs) {
+
+  /* one count per pending order */
+  xOrderSemaphore = xSemaphoreCreateCounting(JURA_ORDER_QUEUE_MAX, 0);
+
+  for (int i = 0; i < JURA_ORDER_PRODUCT_SLOTS; i++){
+    _service_total_ms[i] = 0;
+    _service_count[i] = 0;
+  }
+}
+
+/***************************************************************************//**
+ * Functions that dispense a product and can therefore be ordered; None stands
+ * for the product selected on the machine.
+ *
+ * @param[out] bool
+ *
+ * @param[in] JuraFunctionIdentifier function
+ ******************************************************************************/
+bool JuraOrderQueue::isProduct(JuraFunctionIdentifier function){
+  switch (function){
+    case JuraFunctionIdentifier::MakeEspresso:
+    case JuraFunctionIdentifier::MakeCappuccino:
+    case JuraFunctionIdentifier::MakeCoffee:
+    case JuraFunctionIdentifier::MakeMacchiato:
+    case JuraFunctionIdentifier::MakeHotWater:
+    case JuraFunctionIdentifier::MakeMilkFoam:
+    case JuraFunctionIdentifier::None:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/***************************************************************************//**
+ * Order a packed recipe.
+ *
+ * @param[out] uint16_t order id, 0 if rejected
+ *
+ * @param[in] const JuraPackedRecipe &recipe
+ ******************************************************************************/
+uint16_t JuraOrderQueue::enqueue(const JuraPackedRecipe &recipe){
+  if (!isProduct((JuraFunctionIdentifier) recipe.function)){return 0;}
+
+  JuraOrder order;
+  order.recipe = recipe;
+  order.program = JURA_ORDER_NO_PROGRAM;
+  return append(order);
+}
+
+/***************************************************************************//**
+ * Order a stored user recipe program by slot.
+ *
+ * @param[out] uint16_t order id, 0 if rejected
+ *
+ * @param[in] uint8_t program
+ ******************************************************************************/
+uint16_t JuraOrderQueue::enqueueProgram(uint8_t program){
+  if (!_programs->exists(program)){return 0;}
+
+  JuraOrder order;
+  order.recipe = {(uint8_t) JuraFunctionIdentifier::None, 0, 0, 0, 0};
+  order.program = program;
+  return append(order);
+}
+
+/***************************************************************************//**
+ * Append an order; the worker is woken through the counting semaphore.
+ *
+ * @param[out] uint16_t order id, 0 if the queue is full
+ *
+ * @param[in] JuraOrder order (id is assigned here)
+ ******************************************************************************/
+uint16_t JuraOrderQueue::append(JuraOrder order){
+  portENTER_CRITICAL(&_lock);
+  if (_count == JURA_ORDER_QUEUE_MAX){
+    portEXIT_CRITICAL(&_lock);
+    return 0;
+  }
+  order.id = _next_id++;
+  if (_next_id == 0){_next_id = 1;}
+  _pending[(_head + _count) % JURA_ORDER_QUEUE_MAX] = order;
+  _count++;
+  portEXIT_CRITICAL(&_lock);
+
+  xSemaphoreGive(xOrderSemaphore);
+  publishStatus();
+  return order.id;
+}
+
+/***************************************************************************//**
+ * Block until an order is pending and move it into service. Idle maintenance is
+ * held from here until the queue drains.
+ *
+ * @param[out] bool true if an order was taken
+ *
+ * @param[out] JuraOrder &order
+ ******************************************************************************/
+bool JuraOrderQueue::take(JuraOrder &order){
+  if (xSemaphoreTake(xOrderSemaphore, portMAX_DELAY) != pdTRUE){return false;}
+
+  portENTER_CRITICAL(&_lock);
+  order = _pending[_head];
+  _head = (_head + 1) % JURA_ORDER_QUEUE_MAX;
+  _count--;
+  _current = order;
+  _serving = true;
+  _serving_since = millis();
+  portEXIT_CRITICAL(&_lock);
+
+  _machine->holdAutomaticMaintenance(true);
+  return true;
+}
+
+/***************************************************************************//**
+ * Make one order: wait for ready, set limits, start the product (or wait for the
+ * user to select one) and add shots, then wait for ready again. Service time runs from the product starting to the
+ * machine being ready for the next one; it is only recorded for orders without
+ * add shots, which are estimated as espressos of their own.
+ *
+ * @param[out] null
+ *
+ * @param[in] const JuraOrder &order
+ ******************************************************************************/
+void JuraOrderQueue::serve(const JuraOrder &order){
+  JURA_MEMORY_PROFILE("order");
+  JuraRecipeStep steps[JURA_RECIPE_MAX_STEPS];
+  int count = 0;
+  const JuraPackedRecipe &recipe = order.recipe;
+
+  /* user programs run as written; no service time is measured for them */
+  if (order.program != JURA_ORDER_NO_PROGRAM){
+    publishStatus();
+    bool completed = _programs->run(order.program);
+    ESP_LOGI(TAG,"--> Order %u (recipe %i) %s", order.id, order.program, completed ? "served" : "abandoned");
+    finish(false);
+    return;
+  }
+
+  bool selectedOnMachine = (JuraFunctionIdentifier) recipe.function == JuraFunctionIdentifier::None;
+  int add = recipe.add > 2 ? 2 : recipe.add;
+
+  publishStatus();
+
+  steps[count++] = {JuraRecipeStepType::AwaitReady, 0};
+  steps[count++] = {JuraRecipeStepType::ResetLimits, 0};
+  if (recipe.milk > 0)  {steps[count++] = {JuraRecipeStepType::MilkLimit, recipe.milk};}
+  if (recipe.brew > 0)  {steps[count++] = {JuraRecipeStepType::BrewLimit, recipe.brew};}
+  if (recipe.water > 0) {steps[count++] = {JuraRecipeStepType::WaterLimit, recipe.water};}
+
+  /* limits only: nothing to start or wait for; the limits stay set for the user's product */
+  bool limitsOnly = selectedOnMachine && add == 0;
+
+  if (!selectedOnMachine){
+    steps[count++] = {JuraRecipeStepType::Function, (int) recipe.function};
+    steps[count++] = {JuraRecipeStepType::AwaitDispenseStart, 0};
+  }else if (!limitsOnly){
+    _bridge->instructServicePortToDisplayString(" PRODUCT?");
+    steps[count++] = {JuraRecipeStepType::AwaitSelection, 0};
+  }
+
+  /* add shots; same sequence as the limits topic */
+  for (int shot = 0; shot < add && count + 5 <= JURA_RECIPE_MAX_STEPS; shot++){
+    steps[count++] = {JuraRecipeStepType::MarkAddShot, 0};
+    steps[count++] = {JuraRecipeStepType::AwaitReady, 0};
+    steps[count++] = {JuraRecipeStepType::BrewLimit, recipe.brew > 0 ? recipe.brew : 17};
+    steps[count++] = {JuraRecipeStepType::Function, (int) JuraFunctionIdentifier::MakeEspresso};
+    steps[count++] = {JuraRecipeStepType::AwaitDispenseStart, 0};
+  }
+
+  /* held until ready again, so the start time read below is this order's */
+  _recipes->acquire();
+  bool completed = _recipes->run(steps, count);
+  unsigned long started = _recipes->firstStart();
+
+  if (completed && !limitsOnly){
+    /* a start edge can precede ready falling; do not take the old ready level as completion */
+    _machine->awaitMachineEvents(MACHINE_EVENT_NOT_READY, true, JURA_RECIPE_DISPENSE_START_TIMEOUT_MS);
+    JuraRecipeStep ready = {JuraRecipeStepType::AwaitReady, 0};
+    completed = _recipes->runStep(ready);
+  }
+  _recipes->release();
+
+  if (completed && add == 0 && started != 0){
+    portENTER_CRITICAL(&_lock);
+    _service_total_ms[recipe.function] += millis() - started;
+    _service_count[recipe.function]++;
+    portEXIT_CRITICAL(&_lock);
+  }
+
+  ESP_LOGI(TAG,"--> Order %u %s", order.id, completed ? "served" : "abandoned");
+  finish(limitsOnly);
+}
+
+/***************************************************************************//**
+ * End service of the current order. Once the queue has drained, idle maintenance
+ * resumes, limits are cleared and the ready message is shown; limits-only orders
+ * leave their limits for the product the user is about to select.
+ *
+ * @param[out] null
+ *
+ * @param[in] bool limitsOnly
+ ******************************************************************************/
+void JuraOrderQueue::finish(bool limitsOnly){
+  portENTER_CRITICAL(&_lock);
+  _serving = false;
+  bool drained = _count == 0;
+  portEXIT_CRITICAL(&_lock);
+
+  /* between orders the machine goes straight to the next product */
+  if (drained){
+    _machine->holdAutomaticMaintenance(false);
+    if (!limitsOnly){
+      _machine->resetDispenseLimits();
+      _bridge->instructServicePortToSetReady();
+    }
+  }
+  publishStatus();
+}
+
+int JuraOrderQueue::depth(){
+  portENTER_CRITICAL(&_lock);
+  int depth = _count + (_serving ? 1 : 0);
+  portEXIT_CRITICAL(&_lock);
+  return depth;
+}
+
+/***************************************************************************//**
+ * Expected time for one order, from the machine being ready to ready again:
+ * the drink-to-drink gap plus the product's average service time, plus the same
+ * for an espresso per add shot. Unmeasured products use a default.
+ *
+ * @param[out] unsigned long ms
+ *
+ * @param[in] const JuraOrder &order
+ ******************************************************************************/
+unsigned long JuraOrderQueue::estimate(const JuraOrder &order){
+  unsigned long gap = _recipes->averageGap();
+  int product = order.recipe.function;
+  int espresso = (int) JuraFunctionIdentifier::MakeEspresso;
+
+  unsigned long productMs = _service_count[product] > 0 ? _service_total_ms[product] / _service_count[product] : JURA_ORDER_DEFAULT_SERVICE_MS;
+  unsigned long espressoMs = _service_count[espresso] > 0 ? _service_total_ms[espresso] / _service_count[espresso] : JURA_ORDER_DEFAULT_SERVICE_MS;
+
+  int add = order.recipe.add > 2 ? 2 : order.recipe.add;
+  return gap + productMs + add * (gap + espressoMs);
+}
+
+/***************************************************************************//**
+ * Snapshot of the queue. The order in service is expected done when its estimate
+ * has elapsed (never earlier than now); each pending order after the one ahead.
+ *
+ * @param[out] null
+ *
+ * @param[out] JuraOrderQueueStatus &status
+ ******************************************************************************/
+void JuraOrderQueue::status(JuraOrderQueueStatus &status){
+  unsigned long now = millis();
+
+  portENTER_CRITICAL(&_lock);
+  status.depth = _count + (_serving ? 1 : 0);
+  status.serving = _serving;
+  status.current = _current;
+
+  unsigned long eta = 0;
+  if (_serving){
+    unsigned long elapsed = now - _serving_since;
+    unsigned long expected = estimate(_current);
+    eta = elapsed < expected ? expected - elapsed : 0;
+  }
+  status.currentEta = eta;
+
+  for (int i = 0; i < _count; i++){
+    status.pending[i] = _pending[(_head + i) % JURA_ORDER_QUEUE_MAX];
+    eta += estimate(status.pending[i]);
+    status.pendingEta[i] = eta;
+  }
+
+  for (int i = 0; i < JURA_ORDER_PRODUCT_SLOTS; i++){
+    status.serviceCount[i] = _service_count[i];
+    status.serviceTime[i] = _service_count[i] > 0 ? _service_total_ms[i] / _service_count[i] : 0;
+  }
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraOrderQueue::publishStatus(){
+  JuraOrderQueueStatus snapshot;
+  status(snapshot);
+  _bridge->publishOrderQueueStatus(snapshot);
+}
@@ -0,0 +1,98 @@
+#ifndef JURAORDERQUEUE_H
+#define JURAORDERQUEUE_H
+#include "JuraConfiguration.h"
+#include "JuraMachine.h"
+#include "JuraBridge.h"
+#include "JuraRecipe.h"
+#include "JuraPackedRecipe.h"
+#include "JuraRecipeProgram.h"
+
+/* service times are kept per function identifier */
+#define JURA_ORDER_PRODUCT_SLOTS  ((int) JuraFunctionIdentifier::None + 1)
+
+/* one drink; a user recipe program when program is not JURA_ORDER_NO_PROGRAM */
+#define JURA_ORDER_NO_PROGRAM  -1
+struct JuraOrder {
+  uint16_t id;
+  JuraPackedRecipe recipe;
+  int8_t program;
+};
+
+/* snapshot for reporting; eta is ms from the snapshot until the order is expected complete */
+struct JuraOrderQueueStatus {
+  int depth;
+  bool serving;
+  JuraOrder current;
+  unsigned long currentEta;
+  JuraOrder pending[JURA_ORDER_QUEUE_MAX];
+  unsigned long pendingEta[JURA_ORDER_QUEUE_MAX];
+  unsigned long serviceTime[JURA_ORDER_PRODUCT_SLOTS];   /* average; 0 if never measured */
+  unsigned long serviceCount[JURA_ORDER_PRODUCT_SLOTS];
+};
+
+/*
+
+  name:         JuraOrderQueue
+  type:         class
+  description:  fifo of drink orders, served back-to-back by a single worker
+                task. each order waits for the machine ready events, sets its
+                limits, starts the product and any add shots through the recipe
+                engine, then waits for ready again; that last wait ends the
+                measured service time for the product. a recipe without a
+                function sets its limits and add shots for the product the
+                user selects on the machine.
+
+                while orders are pending, the bridge's own idle maintenance
+                (automatic rinse prompts) is held and the ready message is not
+                written between drinks. maintenance the machine requires keeps
+                it out of ready, so the next order simply waits for it.
+
+*/
+class JuraOrderQueue {
+public:
+  JuraOrderQueue(JuraMachine &, JuraBridge &, JuraRecipeEngine &, JuraRecipeProgramStore &);
+
+  /* returns the order id, or 0 if the queue is full or the function is not a product */
+  uint16_t enqueue(const JuraPackedRecipe &);
+  uint16_t enqueueProgram(uint8_t);
+
+  /* blocks until an order is pending; the order is then being served until serve returns */
+  bool take(JuraOrder &);
+  void serve(const JuraOrder &);
+
+  int depth();
+  void status(JuraOrderQueueStatus &);
+
+  static bool isProduct(JuraFunctionIdentifier);
+
+private:
+  JuraMachine * _machine;
+  JuraBridge * _bridge;
+  JuraRecipeEngine * _recipes;
+  JuraRecipeProgramStore * _programs;
+
+  /* ring of pending orders */
+  JuraOrder _pending[JURA_ORDER_QUEUE_MAX];
+  int _head = 0;
+  int _count = 0;
+  uint16_t _next_id = 1;
+
+  /* order in service */
+  JuraOrder _current;
+  bool _serving = false;
+  unsigned long _serving_since = 0;
+
+  /* measured service time per product */
+  unsigned long _service_total_ms[JURA_ORDER_PRODUCT_SLOTS];
+  unsigned long _service_count[JURA_ORDER_PRODUCT_SLOTS];
+
+  SemaphoreHandle_t xOrderSemaphore;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  uint16_t append(JuraOrder);
+  void finish(bool);
+  unsigned long estimate(const JuraOrder &);
+  void publishStatus();
+};
+
+#endif
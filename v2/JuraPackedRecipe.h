@@ -0,0 +1,112 @@
+#ifndef JURAPACKEDRECIPE_H
+#define JURAPACKEDRECIPE_H
+#include "JuraConfiguration.h"
+
+/* a drink: product (None: the product the user selects on the machine), limits in ml (0: machine default), add shots.
+   fixed layout; stored in nvs as is */
+struct JuraPackedRecipe {
+  uint8_t function;
+  uint8_t add;
+  uint16_t milk;
+  uint16_t brew;
+  uint16_t water;
+};
+static_assert(sizeof(JuraPackedRecipe) == 8, "JuraPackedRecipe layout is stored in nvs");
+
+/* not constexpr; a menu definition that calls it does not compile */
+inline void juraCustomMenuItemIsInvalid(){}
+
+/*
+
+  name:         JuraPackedRecipeCompiler
+  type:         namespace
+  description:  constexpr translation of a custom menu definition (display
+                name, function topic and limits payload) into a packed recipe.
+                the topic is resolved against the function entity table and
+                the payload, e.g. {'add':1,'brew':17}, is parsed for the keys
+                milk, brew, water and add. anything else fails the build.
+
+*/
+namespace JuraPackedRecipeCompiler {
+  constexpr bool isDigit(char c)      {return c >= '0' && c <= '9';}
+  constexpr bool isSeparator(char c)  {return c == ' ' || c == '{' || c == '}' || c == ',' || c == '\'' || c == '"';}
+
+  constexpr bool equal(const char *a, const char *b){
+    while (*a != '\0' && *a == *b){a++; b++;}
+    return *a == *b;
+  }
+
+  constexpr bool keyIs(const char *key, int length, const char *name){
+    for (int i = 0; i < length; i++){
+      if (name[i] != key[i]){return false;}
+    }
+    return name[length] == '\0';
+  }
+
+  /* limits topic and the exit item carry no function */
+  constexpr uint8_t functionForTopic(const char *topic){
+    if (topic[0] == '\0' || equal(topic, MQTT_ROOT MQTT_DISPENSE_CONFIG)){return (uint8_t) JuraFunctionIdentifier::None;}
+    for (const JuraMachineFunctionEntityConfiguration &entity : JuraMachineFunctionEntityConfigurations){
+      if (equal(topic, entity.command_topic)){return (uint8_t) entity.function;}
+    }
+    juraCustomMenuItemIsInvalid();
+    return (uint8_t) JuraFunctionIdentifier::None;
+  }
+
+  constexpr JuraPackedRecipe compile(const char *topic, const char *payload){
+    JuraPackedRecipe recipe = {functionForTopic(topic), 0, 0, 0, 0};
+    const char *p = payload;
+
+    for (;;){
+      while (isSeparator(*p)){p++;}
+      if (*p == '\0'){break;}
+
+      /* key, quotes already skipped */
+      const char *key = p;
+      while (*p != '\0' && *p != ':' && !isSeparator(*p)){p++;}
+      int length = p - key;
+      while (isSeparator(*p)){p++;}
+      if (*p != ':'){juraCustomMenuItemIsInvalid(); break;}
+      p++;
+
+      /* unsigned integer value */
+      while (*p == ' '){p++;}
+      if (!isDigit(*p)){juraCustomMenuItemIsInvalid(); break;}
+      unsigned long value = 0;
+      while (isDigit(*p)){value = value * 10 + (*p - '0'); p++;}
+      if (value > 0xFFFF){juraCustomMenuItemIsInvalid();}
+
+      if      (keyIs(key, length, "milk"))  {recipe.milk = (uint16_t) value;}
+      else if (keyIs(key, length, "brew"))  {recipe.brew = (uint16_t) value;}
+      else if (keyIs(key, length, "water")) {recipe.water = (uint16_t) value;}
+      else if (keyIs(key, length, "add"))   {if (value > 2){juraCustomMenuItemIsInvalid();} recipe.add = (uint8_t) value;}
+      else                                  {juraCustomMenuItemIsInvalid();}
+    }
+    return recipe;
+  }
+}
+
+/*
+
+  name:         JuraCustomMenuItem
+  type:         struct
+  description:  hardware menu entry; compiled from its definition strings, so
+                only the display name and the packed recipe are stored. user
+                items in nvs use the same layout.
+
+*/
+struct JuraCustomMenuItem {
+  char name[JURA_CUSTOM_MENU_NAME_SIZE] = {};
+  JuraPackedRecipe recipe = {(uint8_t) JuraFunctionIdentifier::None, 0, 0, 0, 0};
+
+  constexpr JuraCustomMenuItem() = default;
+
+  constexpr JuraCustomMenuItem(const char *displayName, const char *topic, const char *payload) : recipe(JuraPackedRecipeCompiler::compile(topic, payload)) {
+    int i = 0;
+    for (; displayName[i] != '\0' && i < JURA_CUSTOM_MENU_NAME_SIZE - 1; i++){name[i] = displayName[i];}
+    if (displayName[i] != '\0'){juraCustomMenuItemIsInvalid();}
+  }
+};
+static_assert(sizeof(JuraCustomMenuItem) == JURA_CUSTOM_MENU_NAME_SIZE + sizeof(JuraPackedRecipe), "JuraCustomMenuItem layout is stored in nvs");
+
+#endif
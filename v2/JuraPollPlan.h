@@ -0,0 +1,228 @@
+#ifndef JURAPOLLPLAN_H
+#define JURAPOLLPLAN_H
+#include "JuraEnums.h"
+
+/* set poll rates */
+#define POLL_MEMORY     -1
+#define POLL_DUTY_FULL  1
+#define POLL_DUTY_50    2
+#define POLL_DUTY_33    3
+#define POLL_DUTY_20    5
+#define POLL_DUTY_15    7
+#define POLL_DUTY_10    11
+#define POLL_DUTY_5     23
+#define POLL_DISABLED   101
+#define POLL_DUTY_SCAN  POLL_DUTY_5     /* eeprom research scanner; one line per due poll */
+#define POLL_DUTY_RM_SCAN   POLL_DUTY_10  /* working memory sweep; one batch per due poll */
+#define POLL_DUTY_RM_WATCH  POLL_DUTY_10  /* working memory watch points during dispenses; one word per due poll */
+
+#define POLL_PLAN_SIZE(plan) ((int) (sizeof(plan) / sizeof(plan[0])))
+
+/*
+
+  name:         JuraPollPlan*
+  type:         arrays
+  description:  per operational state poll periods; sources not listed are
+                disabled. every plan must list IC and CS explicitly, even if
+                disabled, so that omitting either is a deliberate choice.
+
+*/
+
+constexpr JuraPollPlanEntry JuraPollPlanStarting[] = {
+  /* need to get data from the machine first */
+  {JuraPollSource::IC,  POLL_DUTY_FULL},
+  {JuraPollSource::CS,  POLL_DUTY_FULL},
+  {JuraPollSource::HZ,  POLL_DUTY_FULL},
+
+  /* memory */
+  {JuraPollSource::RT0, POLL_DUTY_FULL},
+  {JuraPollSource::RT1, POLL_DUTY_FULL},
+  {JuraPollSource::RT2, POLL_DUTY_FULL},
+  {JuraPollSource::RT4, POLL_DUTY_FULL},
+  {JuraPollSource::RT5, POLL_DUTY_FULL},
+  {JuraPollSource::RTA, POLL_DUTY_FULL},
+  {JuraPollSource::RTD, POLL_DUTY_FULL},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanIdle[] = {
+  /* clear everytihng up; continue the polling  */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_33}, /* capture grinder quickly */
+  {JuraPollSource::HZ,  POLL_DUTY_33},
+
+  /* memory */
+  {JuraPollSource::RT0, POLL_DUTY_33},
+  {JuraPollSource::RT1, POLL_DUTY_33},
+  {JuraPollSource::RT2, POLL_DUTY_33},
+  {JuraPollSource::RT4, POLL_DUTY_20},
+  {JuraPollSource::RT5, POLL_DUTY_20},
+  {JuraPollSource::RT7, POLL_DUTY_20},
+  {JuraPollSource::RT8, POLL_DUTY_20},
+  {JuraPollSource::RTA, POLL_DUTY_20},
+  {JuraPollSource::RTD, POLL_DUTY_20},
+
+  /* research */
+  {JuraPollSource::EepromScan, POLL_DUTY_SCAN},
+  {JuraPollSource::WorkingMemoryScan, POLL_DUTY_RM_SCAN},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanFinishing[] = {
+  /* clear everytihng up; continue the polling  */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_FULL},
+  {JuraPollSource::HZ,  POLL_DUTY_20},
+
+  /* memory */
+  {JuraPollSource::RT0, POLL_DUTY_15},
+  {JuraPollSource::RT1, POLL_DUTY_10},
+  {JuraPollSource::RT2, POLL_DUTY_5},
+  {JuraPollSource::RTD, POLL_DUTY_FULL},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanReady[] = {
+  /* awaiting a grind or awaiting pump & thermoblock */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_FULL}, /* capture grinder quickly */
+  {JuraPollSource::HZ,  POLL_DUTY_20},
+
+  /* memory */
+  {JuraPollSource::RT0, POLL_DUTY_15},
+  {JuraPollSource::RT1, POLL_DUTY_10},
+  {JuraPollSource::RT2, POLL_DUTY_5},
+  {JuraPollSource::RTA, POLL_DUTY_5},
+  {JuraPollSource::RT7, POLL_DUTY_5},
+  {JuraPollSource::RT8, POLL_DUTY_5},
+  {JuraPollSource::RTD, POLL_DUTY_15},
+
+  /* research */
+  {JuraPollSource::EepromScan, POLL_DUTY_SCAN},
+  {JuraPollSource::WorkingMemoryScan, POLL_DUTY_RM_SCAN},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanGrindOperation[] = {
+  /* refresh grinder asap */
+  {JuraPollSource::IC,  POLL_DISABLED},
+  {JuraPollSource::CS,  POLL_DUTY_FULL},
+
+  /* research */
+  {JuraPollSource::WorkingMemoryWatch, POLL_DUTY_RM_WATCH},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanBrewOperation[] = {
+  /* awaiting a grind or awaiting pump & thermoblock */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_FULL}, /* capture grinder quickly */
+  {JuraPollSource::HZ,  POLL_DUTY_20},
+  {JuraPollSource::RT0, POLL_DUTY_15}, /* needed to catch cleaning state based on grounds */
+
+  /* research */
+  {JuraPollSource::WorkingMemoryWatch, POLL_DUTY_RM_WATCH},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanBlockingError[] = {
+  /* clear an error fast  */
+  {JuraPollSource::IC,  POLL_DUTY_FULL},
+  {JuraPollSource::CS,  POLL_DISABLED},
+  {JuraPollSource::RT0, POLL_DUTY_FULL},
+  {JuraPollSource::RTD, POLL_DUTY_FULL},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanWaterOperation[] = {
+  /* awaiting a grind or awaiting pump & thermoblock */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_FULL}, /* capture grinder quickly */
+  {JuraPollSource::HZ,  POLL_DUTY_20},
+  {JuraPollSource::RT0, POLL_DUTY_15},
+
+  /* research */
+  {JuraPollSource::WorkingMemoryWatch, POLL_DUTY_RM_WATCH},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanMilkOperation[] = {
+  /* awaiting a grind or awaiting pump & thermoblock */
+  {JuraPollSource::IC,  POLL_DUTY_33},
+  {JuraPollSource::CS,  POLL_DUTY_FULL}, /* capture grinder quickly */
+  {JuraPollSource::HZ,  POLL_DUTY_20},
+
+  /* research */
+  {JuraPollSource::WorkingMemoryWatch, POLL_DUTY_RM_WATCH},
+};
+
+constexpr JuraPollPlanEntry JuraPollPlanDefault[] = {
+  {JuraPollSource::IC,  POLL_DUTY_50}, /* flow meter & errors */
+  {JuraPollSource::CS,  POLL_DUTY_FULL},
+  {JuraPollSource::HZ,  POLL_DUTY_33},
+
+  /* memory */
+  {JuraPollSource::RT0, POLL_DUTY_15},
+  {JuraPollSource::RT1, POLL_DUTY_10},
+};
+
+/* special memory refresh; requested with POLL_MEMORY as the iterator */
+constexpr JuraPollPlanEntry JuraPollPlanMemory[] = {
+  {JuraPollSource::IC,  POLL_DISABLED},
+  {JuraPollSource::CS,  POLL_DISABLED},
+  {JuraPollSource::RT0, POLL_DUTY_FULL},
+  {JuraPollSource::RT1, POLL_DUTY_FULL},
+};
+
+#define POLL_PLAN(state, plan) {JuraMachineOperationalState::state, plan, POLL_PLAN_SIZE(plan)}
+
+/*
+
+  name:         JuraPollPlans
+  type:         array
+  description:  poll plan for each operational state, indexed by the state's
+                value; must be in enum order and cover every state
+
+*/
+constexpr JuraPollPlan JuraPollPlans[] = {
+  POLL_PLAN(Starting,         JuraPollPlanStarting),
+  POLL_PLAN(AddShotCommand,   JuraPollPlanDefault),
+  POLL_PLAN(Disconnected,     JuraPollPlanDefault),
+  POLL_PLAN(Idle,             JuraPollPlanIdle),
+  POLL_PLAN(Ready,            JuraPollPlanReady),
+  POLL_PLAN(Finishing,        JuraPollPlanFinishing),
+  POLL_PLAN(BlockingError,    JuraPollPlanBlockingError),
+  POLL_PLAN(GrindOperation,   JuraPollPlanGrindOperation),
+  POLL_PLAN(BrewOperation,    JuraPollPlanBrewOperation),
+  POLL_PLAN(WaterOperation,   JuraPollPlanWaterOperation),
+  POLL_PLAN(RinseOperation,   JuraPollPlanDefault),
+  POLL_PLAN(MilkOperation,    JuraPollPlanMilkOperation),
+  POLL_PLAN(HeatingOperation, JuraPollPlanDefault),
+  POLL_PLAN(Cleaning,         JuraPollPlanDefault),
+  POLL_PLAN(AwaitRotaryInput, JuraPollPlanDefault),
+  POLL_PLAN(ProgramPause,     JuraPollPlanDefault),
+  POLL_PLAN(Unknown,          JuraPollPlanDefault),
+};
+
+/* compile time validation */
+constexpr bool pollPlanCoversSource(const JuraPollPlanEntry * entries, int size, JuraPollSource source){
+  return size == 0 ? false : (entries[0].source == source || pollPlanCoversSource(entries + 1, size - 1, source));
+}
+
+constexpr bool pollPlanPeriodsAreValid(const JuraPollPlanEntry * entries, int size){
+  return size == 0 ? true :
+    (entries[0].period >= POLL_DUTY_FULL && entries[0].period <= POLL_DISABLED &&
+     entries[0].source != JuraPollSource::Count &&
+     pollPlanPeriodsAreValid(entries + 1, size - 1));
+}
+
+constexpr bool pollPlanIsValid(const JuraPollPlanEntry * entries, int size){
+  return pollPlanCoversSource(entries, size, JuraPollSource::IC) &&
+         pollPlanCoversSource(entries, size, JuraPollSource::CS) &&
+         pollPlanPeriodsAreValid(entries, size);
+}
+
+constexpr bool pollPlansAreValid(const JuraPollPlan * plans, int size, int index){
+  return index == size ? true :
+    ((int) plans[index].state == index &&
+     pollPlanIsValid(plans[index].entries, plans[index].size) &&
+     pollPlansAreValid(plans, size, index + 1));
+}
+
+static_assert(POLL_PLAN_SIZE(JuraPollPlans) == (int) JuraMachineOperationalState::Unknown + 1, "every operational state needs a poll plan");
+static_assert(pollPlansAreValid(JuraPollPlans, POLL_PLAN_SIZE(JuraPollPlans), 0), "poll plans must be in state order, cover IC and CS, and use valid periods");
+static_assert(pollPlanIsValid(JuraPollPlanMemory, POLL_PLAN_SIZE(JuraPollPlanMemory)), "memory poll plan must cover IC and CS");
+
+#endif
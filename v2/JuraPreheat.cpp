@@ -0,0 +1,231 @@
+#include "JuraPreheat.h"
+#include "Preferences.h"
+
+JuraPreheatPlanner::JuraPreheatPlanner(JuraMachine &machine, JuraBridge &bridge, JuraOrderQueue &orders, Preferences &prefsRef) : _machine(&machine), _bridge(&bridge), _orders(&orders), preferences(prefsRef) {
+  memset(&_history, 0, sizeof(_history));
+  _history.version = JURA_PREHEAT_HISTORY_VERSION;
+}
+
+/***************************************************************************//**
+ * Read the learned pattern from nvs; a blob of another size or version is
+ * discarded and learning starts over.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraPreheatPlanner::begin(){
+  if (preferences.getBytesLength(PREF_PREHEAT_KEY) != sizeof(JuraPreheatHistory)){return;}
+
+  JuraPreheatHistory history;
+  preferences.getBytes(PREF_PREHEAT_KEY, &history, sizeof(history));
+  if (history.version != JURA_PREHEAT_HISTORY_VERSION){
+    ESP_LOGI(TAG,"--> Preheat history in nvs is version %u; ignored", history.version);
+    return;
+  }
+
+  portENTER_CRITICAL(&_lock);
+  _history = history;
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Follow one selection on the machine from ready falling to ready again, or,
+ * if the machine stays ready for the check interval, check for a preheat.
+ * Levels only; the edge bits belong to the recipe engine. A selection is the
+ * fall from a ready level seen here, with the machine online: time off, in
+ * standby, disconnected or in a prompt is never taken for a selection.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraPreheatPlanner::watch(){
+  EventBits_t bits = _machine->awaitMachineEvents(MACHINE_EVENT_READY, true, JURA_PREHEAT_CHECK_INTERVAL_MS);
+  if (!(bits & MACHINE_EVENT_READY)){return;}
+
+  bits = _machine->awaitMachineEvents(MACHINE_EVENT_NOT_READY, true, JURA_PREHEAT_CHECK_INTERVAL_MS);
+  if (!(bits & MACHINE_EVENT_NOT_READY)){
+    considerPreheat();
+    return;
+  }
+
+  /* ready cleared by the link going down */
+  if (_bridge->servicePort.connection.state() != JuraConnectionState::Online){return;}
+
+  /* temperature of the last poll before the selection */
+  unsigned long selectedAt = millis();
+  int temperature = _machine->states[(int) JuraMachineStateIdentifier::ThermoblockTemperature];
+
+  bool flush = _flushing;
+  bool first = !flush && idleFor(_last_selection_at, selectedAt, JURA_PREHEAT_IDLE_GAP_MIN * 60000UL);
+  bool preheated = first && _preheated_at != 0 && selectedAt - _preheated_at <= JURA_PREHEAT_EFFECT_MIN * 60000UL;
+  if (!flush){_last_selection_at = selectedAt;}
+
+  /* time to first drink: selection to the pump or dispense starting, heating included */
+  bits = _machine->awaitMachineEvents(MACHINE_EVENT_PUMP_ON | MACHINE_EVENT_DISPENSING, false, JURA_RECIPE_SELECTION_TIMEOUT_MS);
+  bool started = bits & (MACHINE_EVENT_PUMP_ON | MACHINE_EVENT_DISPENSING);
+  unsigned long latency = millis() - selectedAt;
+
+  _machine->awaitMachineEvents(MACHINE_EVENT_READY, true, JURA_RECIPE_READY_TIMEOUT_MS);
+
+  if (flush){
+    _flushing = false;
+    _preheated_at = millis();
+    ESP_LOGI(TAG,"--> Preheat flush complete");
+    publishStatus();
+    return;
+  }
+
+  if (first && started){
+    recordFirstDrink(latency, temperature, preheated);
+  }
+}
+
+/***************************************************************************//**
+ * Order a flush if the bin JURA_PREHEAT_LEAD_MIN ahead is expected to hold the
+ * first drink, the machine has been idle for the idle gap (and not preheated in
+ * it), nothing is ordered and the thermoblock is cold or low.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraPreheatPlanner::considerPreheat(){
+  unsigned long now = millis();
+
+  /* an ordered flush that never left ready was abandoned */
+  if (_flushing){
+    if (_orders->depth() == 0){_flushing = false;}
+    return;
+  }
+
+  int minute;
+  if (!clock(minute)){return;}
+  if (!idleFor(_last_selection_at, now, JURA_PREHEAT_IDLE_GAP_MIN * 60000UL)){return;}
+  if (!idleFor(_preheated_at, now, JURA_PREHEAT_IDLE_GAP_MIN * 60000UL)){return;}
+
+  int bin = binOf((minute + JURA_PREHEAT_LEAD_MIN) % 1440);
+  portENTER_CRITICAL(&_lock);
+  bool expected = isExpected(bin);
+  portEXIT_CRITICAL(&_lock);
+  if (!expected){return;}
+
+  if (_orders->depth() > 0){return;}
+  if (!(_machine->awaitMachineEvents(MACHINE_EVENT_READY, true, 0) & MACHINE_EVENT_READY)){return;}
+  if (_machine->thermoblock_status != 0 && _machine->thermoblock_status != 1){return;}
+
+  int temperature = _machine->states[(int) JuraMachineStateIdentifier::ThermoblockTemperature];
+  _warning_before_preheat = temperature <= UNDEREXTRACTION_THRESHOLD;
+  _flushing = true;
+  _preheated_at = now;
+
+  JuraPackedRecipe flush = {(uint8_t) JuraFunctionIdentifier::MakeHotWater, 0, 0, 0, JURA_PREHEAT_FLUSH_ML};
+  if (_orders->enqueue(flush) == 0){
+    _flushing = false;
+    return;
+  }
+
+  portENTER_CRITICAL(&_lock);
+  _history.preheats++;
+  portEXIT_CRITICAL(&_lock);
+
+  ESP_LOGI(TAG,"--> Preheat for bin %i at %i C", bin, temperature);
+  save();
+}
+
+/***************************************************************************//**
+ * Learn a first drink: every bin decays by 1/16, rounded up so a bin that is no
+ * longer visited reaches zero, and the drink's bin gains JURA_PREHEAT_BIN_WEIGHT,
+ * so the histogram follows a changing routine within a few weeks. Latency is
+ * kept whether or not the clock is set.
+ *
+ * @param[out] null
+ *
+ * @param[in] unsigned long latency ms
+ * @param[in] int temperature at selection
+ * @param[in] bool preheated
+ ******************************************************************************/
+void JuraPreheatPlanner::recordFirstDrink(unsigned long latency, int temperature, bool preheated){
+  int minute;
+  bool clockSet = clock(minute);
+
+  portENTER_CRITICAL(&_lock);
+  if (clockSet){
+    for (int i = 0; i < JURA_PREHEAT_BINS; i++){_history.bins[i] -= (_history.bins[i] + 15) / 16;}
+    _history.bins[binOf(minute)] += JURA_PREHEAT_BIN_WEIGHT;
+    if (_history.firstDrinks < 0xFFFF){_history.firstDrinks++;}
+  }
+
+  if (preheated){
+    _history.preheatedCount++;
+    _history.preheatedLatencyMs += latency;
+    if (_warning_before_preheat && temperature > UNDEREXTRACTION_THRESHOLD){_history.warningsAvoided++;}
+  }else{
+    _history.coldCount++;
+    _history.coldLatencyMs += latency;
+  }
+  portEXIT_CRITICAL(&_lock);
+
+  ESP_LOGI(TAG,"--> First drink (%s): %lu ms to start at %i C", preheated ? "preheated" : "cold", latency, temperature);
+  save();
+  publishStatus();
+}
+
+/* true if since is unset or at least span before now */
+bool JuraPreheatPlanner::idleFor(unsigned long since, unsigned long now, unsigned long span){
+  return since == 0 || now - since >= span;
+}
+
+/* a bin is expected once enough first drinks are learned and it holds its share of them; call locked */
+bool JuraPreheatPlanner::isExpected(int bin){
+  if (_history.firstDrinks < JURA_PREHEAT_MIN_FIRST_DRINKS){return false;}
+
+  unsigned long total = 0;
+  for (int i = 0; i < JURA_PREHEAT_BINS; i++){total += _history.bins[i];}
+  return total > 0 && (unsigned long) _history.bins[bin] * 100 >= JURA_PREHEAT_MIN_SHARE_PCT * total;
+}
+
+/* first expected bin from the given minute to midnight; -1 if none */
+int JuraPreheatPlanner::nextBin(int minute){
+  for (int bin = binOf(minute); bin < JURA_PREHEAT_BINS; bin++){
+    if (isExpected(bin)){return bin;}
+  }
+  return -1;
+}
+
+int JuraPreheatPlanner::binOf(int minute){
+  return (minute / (1440 / JURA_PREHEAT_BINS)) % JURA_PREHEAT_BINS;
+}
+
+/* local minute of day; false until ntp has set the clock */
+bool JuraPreheatPlanner::clock(int &minute){
+  struct tm now;
+  if (!getLocalTime(&now, 0)){return false;}
+  minute = now.tm_hour * 60 + now.tm_min;
+  return true;
+}
+
+void JuraPreheatPlanner::save(){
+  JuraPreheatHistory history;
+  portENTER_CRITICAL(&_lock);
+  history = _history;
+  portEXIT_CRITICAL(&_lock);
+  preferences.putBytes(PREF_PREHEAT_KEY, &history, sizeof(history));
+}
+
+void JuraPreheatPlanner::status(JuraPreheatStatus &status){
+  int minute;
+  status.clockSet = clock(minute);
+
+  portENTER_CRITICAL(&_lock);
+  status.history = _history;
+  status.nextBin = status.clockSet ? nextBin(minute) : -1;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraPreheatPlanner::publishStatus(){
+  JuraPreheatStatus snapshot;
+  status(snapshot);
+  _bridge->publishPreheatStatus(snapshot);
+}
@@ -0,0 +1,94 @@
+#ifndef JURAPREHEAT_H
+#define JURAPREHEAT_H
+#include "JuraConfiguration.h"
+#include "JuraMachine.h"
+#include "JuraBridge.h"
+#include "JuraOrderQueue.h"
+
+/* forward declarations */
+class Preferences;
+
+/* learned pattern and results; stored in nvs as is */
+#define JURA_PREHEAT_HISTORY_VERSION  2
+
+/* one first drink, in fixed point; a bin visited every time settles near 16x this */
+#define JURA_PREHEAT_BIN_WEIGHT       256
+struct JuraPreheatHistory {
+  uint8_t version;
+  uint8_t reserved;
+  uint16_t firstDrinks;                     /* observed, saturating */
+  uint16_t bins[JURA_PREHEAT_BINS];         /* decaying weight of first drinks per time of day */
+  uint32_t preheats;
+  uint32_t warningsAvoided;                 /* preheated first drinks that would have started under the underextraction threshold */
+  uint32_t coldCount;                       /* first drinks without a preheat ahead of them */
+  uint32_t coldLatencyMs;                   /* total, selection to dispense start */
+  uint32_t preheatedCount;
+  uint32_t preheatedLatencyMs;
+};
+
+/* snapshot for reporting */
+struct JuraPreheatStatus {
+  JuraPreheatHistory history;
+  bool clockSet;
+  int nextBin;                              /* bin of the next expected first drink today; -1 if none */
+};
+
+/*
+
+  name:         JuraPreheatPlanner
+  type:         class
+  description:  learns when the first drink of a session is made (a selection
+                after JURA_PREHEAT_IDLE_GAP_MIN without one) as a decaying
+                time of day histogram, and orders a small hot water flush
+                JURA_PREHEAT_LEAD_MIN ahead of a bin that holds enough of them,
+                if the machine is idle, ready and the thermoblock is cold or low.
+
+                the flush goes through the order queue like any other drink, so
+                it never interleaves with a user's order. the bridge's own
+                flush is neither a first drink nor ends an idle period.
+
+                latency from selection to the pump starting is kept for first
+                drinks with and without a preheat ahead of them, so the saving
+                can be read directly; a preheated first drink whose thermoblock
+                was under the underextraction threshold before the flush counts
+                as a warning avoided.
+
+*/
+class JuraPreheatPlanner {
+public:
+  JuraPreheatPlanner(JuraMachine &, JuraBridge &, JuraOrderQueue &, Preferences &);
+
+  /* read history from nvs; call after preferences are opened. the clock is set by ntp once wi-fi is up */
+  void begin();
+
+  /* one pass: a selection from start to ready, or a preheat check after the check interval */
+  void watch();
+
+  void status(JuraPreheatStatus &);
+  void publishStatus();
+
+private:
+  JuraMachine * _machine;
+  JuraBridge * _bridge;
+  JuraOrderQueue * _orders;
+  Preferences &preferences;
+
+  JuraPreheatHistory _history;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  unsigned long _last_selection_at = 0;     /* 0: none since boot */
+  unsigned long _preheated_at = 0;          /* flush completed; 0: none */
+  bool _flushing = false;                   /* flush ordered, machine not yet back to ready */
+  bool _warning_before_preheat = false;
+
+  void considerPreheat();
+  void recordFirstDrink(unsigned long, int, bool);
+  bool idleFor(unsigned long, unsigned long, unsigned long);
+  bool isExpected(int);
+  int nextBin(int);
+  static int binOf(int);
+  static bool clock(int &);
+  void save();
+};
+
+#endif
@@ -0,0 +1,241 @@
+#include "JuraRecipe.h"
+
+JuraRecipeEngine::JuraRecipeEngine(JuraMachine &machine, JuraBridge &bridge) : _machine(&machine), _bridge(&bridge) {
+  xRecipeSemaphore = xSemaphoreCreateRecursiveMutex();
+}
+
+/***************************************************************************//**
+ * Take the engine for the calling task. Recursive, so a task holding it for a
+ * whole order can still call run().
+ ******************************************************************************/
+void JuraRecipeEngine::acquire(){
+  xSemaphoreTakeRecursive(xRecipeSemaphore, portMAX_DELAY);
+}
+
+void JuraRecipeEngine::release(){
+  xSemaphoreGiveRecursive(xRecipeSemaphore);
+}
+
+bool JuraRecipeEngine::tryAcquire(){
+  return xSemaphoreTakeRecursive(xRecipeSemaphore, 0) == pdTRUE;
+}
+
+/***************************************************************************//**
+ * Run recipe steps in order; stops at the first step that times out.
+ *
+ * @param[out] bool true if every step completed
+ *
+ * @param[in] const JuraRecipeStep *steps
+ * @param[in] int count
+ ******************************************************************************/
+bool JuraRecipeEngine::run(const JuraRecipeStep *steps, int count){
+  acquire();
+  begin();
+  for (int step = 0; step < count; step++){
+    if (!runStep(steps[step])){
+      ESP_LOGI(TAG,"--> Recipe: step %i of %i timed out (type %i)", step + 1, count, (int) steps[step].type);
+      release();
+      return false;
+    }
+  }
+  release();
+  return true;
+}
+
+/***************************************************************************//**
+ * Start a new recipe: forget the ready and start times of the last one. The
+ * caller holds the engine.
+ ******************************************************************************/
+void JuraRecipeEngine::begin(){
+  portENTER_CRITICAL(&_lock);
+  _ready_at = 0;
+  _first_start_at = 0;
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Gap statistics are written by the task running a recipe and read by others
+ * for queue estimates.
+ ******************************************************************************/
+unsigned long JuraRecipeEngine::lastGap(){
+  portENTER_CRITICAL(&_lock);
+  unsigned long gap = _last_gap_ms;
+  portEXIT_CRITICAL(&_lock);
+  return gap;
+}
+
+unsigned long JuraRecipeEngine::averageGap(){
+  portENTER_CRITICAL(&_lock);
+  unsigned long gap = _gap_count > 0 ? _total_gap_ms / _gap_count : 0;
+  portEXIT_CRITICAL(&_lock);
+  return gap;
+}
+
+unsigned long JuraRecipeEngine::firstStart(){
+  portENTER_CRITICAL(&_lock);
+  unsigned long started = _first_start_at;
+  portEXIT_CRITICAL(&_lock);
+  return started;
+}
+
+/***************************************************************************//**
+ * Execute a single step. Await steps block the calling task on the machine
+ * event group; all others complete immediately.
+ *
+ * @param[out] bool false on timeout
+ *
+ * @param[in] const JuraRecipeStep &step
+ ******************************************************************************/
+bool JuraRecipeEngine::runStep(const JuraRecipeStep &step){
+  EventBits_t bits;
+
+  switch (step.type){
+    case JuraRecipeStepType::MarkAddShot:
+      _machine->startAddShotPreparation();
+      return true;
+
+    case JuraRecipeStepType::AwaitReady:
+      bits = _machine->awaitMachineEvents(MACHINE_EVENT_READY | MACHINE_EVENT_BREW_GROUP_READY, true, JURA_RECIPE_READY_TIMEOUT_MS);
+      if ((bits & (MACHINE_EVENT_READY | MACHINE_EVENT_BREW_GROUP_READY)) != (MACHINE_EVENT_READY | MACHINE_EVENT_BREW_GROUP_READY)){return false;}
+      portENTER_CRITICAL(&_lock);
+      _ready_at = millis();
+      portEXIT_CRITICAL(&_lock);
+      return true;
+
+    case JuraRecipeStepType::ResetLimits:
+      _machine->resetDispenseLimits();
+      return true;
+
+    case JuraRecipeStepType::BrewLimit:
+      _machine->setDispenseLimit(step.argument, JuraMachineDispenseLimitType::Brew);
+      return true;
+
+    case JuraRecipeStepType::MilkLimit:
+      _machine->setDispenseLimit(step.argument, JuraMachineDispenseLimitType::Milk);
+      return true;
+
+    case JuraRecipeStepType::WaterLimit:
+      _machine->setDispenseLimit(step.argument, JuraMachineDispenseLimitType::Water);
+      return true;
+
+    case JuraRecipeStepType::Function:
+      /* only edges after this command count as the product starting */
+      _machine->clearMachineEvents(MACHINE_EVENT_READY_FELL | MACHINE_EVENT_PUMP_STARTED | MACHINE_EVENT_DISPENSE_STARTED);
+      _bridge->instructServicePortWithJuraFunctionIdentifier((JuraFunctionIdentifier) step.argument);
+      _machine->latency.commandSent((JuraFunctionIdentifier) step.argument, millis());
+      return true;
+
+    case JuraRecipeStepType::AwaitDispenseStart:
+      bits = _machine->awaitMachineEvents(MACHINE_EVENT_READY_FELL | MACHINE_EVENT_PUMP_STARTED | MACHINE_EVENT_DISPENSE_STARTED, false, JURA_RECIPE_DISPENSE_START_TIMEOUT_MS);
+      if (!(bits & (MACHINE_EVENT_READY_FELL | MACHINE_EVENT_PUMP_STARTED | MACHINE_EVENT_DISPENSE_STARTED))){return false;}
+      {
+        unsigned long now = millis();
+        bool measured = false;
+
+        /* drink to drink gap */
+        portENTER_CRITICAL(&_lock);
+        if (_first_start_at == 0){_first_start_at = now;}
+        if (_ready_at != 0){
+          _last_gap_ms = now - _ready_at;
+          _total_gap_ms += _last_gap_ms;
+          _gap_count++;
+          _ready_at = 0;
+          measured = true;
+        }
+        portEXIT_CRITICAL(&_lock);
+
+        if (measured){ESP_LOGI(TAG,"--> Recipe: product started %lu ms after ready (average %lu ms)", lastGap(), averageGap());}
+      }
+      return true;
+
+    case JuraRecipeStepType::AwaitSelection:
+      bits = _machine->awaitMachineEvents(MACHINE_EVENT_NOT_READY, true, JURA_RECIPE_SELECTION_TIMEOUT_MS);
+      return (bits & MACHINE_EVENT_NOT_READY) != 0;
+
+    case JuraRecipeStepType::MenuEnter:
+      return runMenuEntry(step);
+
+    case JuraRecipeStepType::MenuFunction:
+      return runMenuStep(step);
+  }
+  return false;
+}
+
+/***************************************************************************//**
+ * Read the eeprom word that changes with every rotary or center button press
+ * while the machine is in a menu.
+ *
+ * @param[out] String word, or empty if the machine did not respond
+ ******************************************************************************/
+String JuraRecipeEngine::menuSignature(){
+  return _bridge->servicePort.transferEncodeCommand(JuraServicePortCommand::RE1F, JuraUartLane::User);
+}
+
+/***************************************************************************//**
+ * The menu signature to compare a press against; reread if the machine did not
+ * answer, since an empty baseline would confirm any later reading.
+ *
+ * @param[out] String word, or empty if the machine never answered
+ ******************************************************************************/
+String JuraRecipeEngine::menuBaseline(){
+  String baseline = menuSignature();
+  for (int read = 0; baseline.length() == 0 && read < JURA_MENU_STEP_RETRIES; read++){
+    vTaskDelay(pdMS_TO_TICKS(JURA_MENU_STEP_POLL_MS));
+    baseline = menuSignature();
+  }
+  return baseline;
+}
+
+/***************************************************************************//**
+ * Open a menu. The opening press is not known to change the menu signature, so
+ * it is confirmed by its acknowledgement, given time to settle, and followed by
+ * a signature read so the first menu press has a baseline taken inside the menu.
+ *
+ * @param[out] bool false if the press was never acknowledged or the signature
+ * could not be read
+ *
+ * @param[in] const JuraRecipeStep &step
+ ******************************************************************************/
+bool JuraRecipeEngine::runMenuEntry(const JuraRecipeStep &step){
+  bool acknowledged = false;
+  for (int attempt = 0; attempt <= JURA_MENU_STEP_RETRIES && !acknowledged; attempt++){
+    acknowledged = _bridge->instructServicePortWithJuraFunctionIdentifier((JuraFunctionIdentifier) step.argument);
+  }
+  if (!acknowledged){return false;}
+
+  vTaskDelay(pdMS_TO_TICKS(JURA_MENU_ENTRY_SETTLE_MS));
+  return menuBaseline().length() > 0;
+}
+
+/***************************************************************************//**
+ * Press a menu button and wait until the machine registers it. Only a press
+ * that was never acknowledged is resent; an acknowledged press that does not
+ * change the menu signature within JURA_MENU_STEP_TIMEOUT_MS aborts, since a
+ * late registration of a resent press would move the menu twice.
+ *
+ * @param[out] bool false if there was no baseline or the press could not be
+ * confirmed
+ *
+ * @param[in] const JuraRecipeStep &step
+ ******************************************************************************/
+bool JuraRecipeEngine::runMenuStep(const JuraRecipeStep &step){
+  String before = menuBaseline();
+  if (before.length() == 0){
+    ESP_LOGI(TAG,"--> Recipe: no menu signature before press %i", step.argument);
+    return false;
+  }
+
+  for (int attempt = 0; attempt <= JURA_MENU_STEP_RETRIES; attempt++){
+    if (!_bridge->instructServicePortWithJuraFunctionIdentifier((JuraFunctionIdentifier) step.argument)){continue;}
+
+    unsigned long start = millis();
+    while (millis() - start < JURA_MENU_STEP_TIMEOUT_MS){
+      String current = menuSignature();
+      if (current.length() > 0 && current != before){return true;}
+      vTaskDelay(pdMS_TO_TICKS(JURA_MENU_STEP_POLL_MS));
+    }
+    ESP_LOGI(TAG,"--> Recipe: menu press %i acknowledged but not registered", step.argument);
+    return false;
+  }
+  return false;
+}
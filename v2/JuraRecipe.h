@@ -0,0 +1,93 @@
+#ifndef JURARECIPE_H
+#define JURARECIPE_H
+#include "JuraConfiguration.h"
+#include "JuraMachine.h"
+#include "JuraBridge.h"
+
+/* recipe step; argument is a limit (ml) or a JuraFunctionIdentifier */
+enum class JuraRecipeStepType {
+  MarkAddShot,          /* hold the machine out of ready until the poller sees it ready again */
+  AwaitReady,           /* machine ready and brew group ready */
+  ResetLimits,          /* clear all dispense limits */
+  BrewLimit,            /* brew dispense limit for the next product */
+  MilkLimit,            /* milk dispense limit for the next product */
+  WaterLimit,           /* water dispense limit for the next product */
+  Function,             /* issue a product or button function */
+  AwaitDispenseStart,   /* machine left ready, pump or dispense started after the last function */
+  AwaitSelection,       /* machine left ready for a product the user selected on the machine */
+  MenuEnter,            /* press that opens a menu; acknowledged, then settled until the menu signature reads */
+  MenuFunction,         /* menu button press, confirmed from the menu signature word */
+};
+
+struct JuraRecipeStep {
+  JuraRecipeStepType type;
+  int argument;
+};
+
+/*
+
+  name:         JuraRecipeEngine
+  type:         class
+  description:  runs a sequence of recipe steps. each await step blocks on the
+                machine event group with a timeout and continues the moment the
+                events are set; a timeout aborts the recipe.
+
+                menu presses are confirmed one at a time against a menu
+                signature read before the press: resent only if the machine
+                did not acknowledge them, and navigation stops if an
+                acknowledged press is not registered in the signature.
+
+                the drink-to-drink gap, from the machine reporting ready to
+                the next product starting, is measured for every product.
+
+                one engine is shared by the order worker and the message
+                worker; a run holds the engine from its first step to its
+                last, so presses from one task never land inside another
+                task's recipe.
+
+*/
+class JuraRecipeEngine {
+public:
+  JuraRecipeEngine(JuraMachine &, JuraBridge &);
+
+  /* returns false if a step timed out; holds the engine for the whole run */
+  bool run(const JuraRecipeStep *, int);
+
+  /* exclusive use of the engine across several runs or steps; nests */
+  void acquire();
+  void release();
+
+  /* for tasks that must not wait behind an order; false if another task holds the engine */
+  bool tryAcquire();
+
+  /* step by step, for interpreters: acquire, begin once, then one step at a time */
+  void begin();
+  bool runStep(const JuraRecipeStep &);
+
+  unsigned long lastGap();
+  unsigned long averageGap();
+
+  /* when the first product of the last run started; 0 if none did */
+  unsigned long firstStart();
+
+private:
+  JuraMachine * _machine;
+  JuraBridge * _bridge;
+
+  /* gap measurement */
+  unsigned long _ready_at = 0;
+  unsigned long _first_start_at = 0;
+  unsigned long _last_gap_ms = 0;
+  unsigned long _total_gap_ms = 0;
+  unsigned long _gap_count = 0;
+
+  SemaphoreHandle_t xRecipeSemaphore;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  bool runMenuEntry(const JuraRecipeStep &);
+  bool runMenuStep(const JuraRecipeStep &);
+  String menuSignature();
+  String menuBaseline();
+};
+
+#endif
@@ -0,0 +1,306 @@
+#include "JuraRecipeProgram.h"
+#include "Preferences.h"
+
+JuraRecipeProgramStore::JuraRecipeProgramStore(Preferences &prefsRef, JuraBridge &bridge, JuraRecipeEngine &recipes) : preferences(prefsRef), _bridge(&bridge), _recipes(&recipes) {
+  for (int i = 0; i < JURA_RECIPE_PROGRAMS_MAX; i++){_present[i] = false;}
+}
+
+void JuraRecipeProgramStore::key(uint8_t id, char *buffer){
+  sprintf(buffer, PREF_RECIPE_PROGRAM_KEY "%u", id);
+}
+
+/***************************************************************************//**
+ * Length of the instruction at the start of code, including operands.
+ *
+ * @param[out] int bytes, or 0 if the opcode is unknown or runs past the end
+ *
+ * @param[in] const uint8_t *code
+ * @param[in] int remaining bytes from code to the end of the program
+ ******************************************************************************/
+int JuraRecipeProgramStore::instructionLength(const uint8_t *code, int remaining){
+  int length = 0;
+  switch ((JuraRecipeOpcode) code[0]){
+    case JuraRecipeOpcode::Press:       length = 2; break;
+    case JuraRecipeOpcode::Limit:       length = 4; break;
+    case JuraRecipeOpcode::ResetLimits: length = 1; break;
+    case JuraRecipeOpcode::Wait:        length = 2; break;
+    case JuraRecipeOpcode::AddShot:     length = 3; break;
+    case JuraRecipeOpcode::Display:     length = remaining > 1 ? 2 + code[1] : 2; break;
+    default:                            return 0;
+  }
+  return length <= remaining ? length : 0;
+}
+
+/***************************************************************************//**
+ * Check a program instruction by instruction: known opcodes, operands in range
+ * and no instruction running past the end.
+ *
+ * @param[out] bool
+ *
+ * @param[in] const JuraRecipeProgram &program
+ ******************************************************************************/
+bool JuraRecipeProgramStore::verify(const JuraRecipeProgram &program){
+  if (program.version != JURA_RECIPE_PROGRAM_VERSION || program.length > JURA_RECIPE_PROGRAM_MAX_BYTES){return false;}
+  if (program.name[JURA_CUSTOM_MENU_NAME_SIZE - 1] != '\0'){return false;}
+
+  int pc = 0;
+  while (pc < program.length){
+    const uint8_t *instruction = program.code + pc;
+    int length = instructionLength(instruction, program.length - pc);
+    if (length == 0){return false;}
+
+    switch ((JuraRecipeOpcode) instruction[0]){
+      case JuraRecipeOpcode::Press:
+        if (instruction[1] >= (uint8_t) JuraFunctionIdentifier::None){return false;}
+        break;
+      case JuraRecipeOpcode::Limit:
+        if (instruction[1] > (uint8_t) JuraRecipeLimitOperand::Water){return false;}
+        break;
+      case JuraRecipeOpcode::Wait:
+        if (instruction[1] > (uint8_t) JuraRecipeWaitOperand::Selection){return false;}
+        break;
+      case JuraRecipeOpcode::Display:
+        if (instruction[1] > JURA_CUSTOM_MENU_NAME_SIZE - 1){return false;}
+        break;
+      default:
+        break;
+    }
+    pc += length;
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * Compile a recipe from json. Steps, in order:
+ *   {"op":"press","function":"make_coffee"}
+ *   {"op":"limit","milk":60,"brew":17,"water":120}   any of the three
+ *   {"op":"reset"}
+ *   {"op":"wait","event":"ready" | "dispense" | "selection"}
+ *   {"op":"add","brew":17}
+ *   {"op":"display","text":"LUNGO"}
+ *
+ * @param[out] const char * null on success, otherwise why the recipe was rejected
+ *
+ * @param[in]  JsonObject recipe
+ * @param[out] JuraRecipeProgram &program
+ ******************************************************************************/
+const char * JuraRecipeProgramStore::compile(JsonObject recipe, JuraRecipeProgram &program){
+  memset(&program, 0, sizeof(program));
+  program.version = JURA_RECIPE_PROGRAM_VERSION;
+  strncpy(program.name, recipe["name"] | "  RECIPE", JURA_CUSTOM_MENU_NAME_SIZE - 1);
+
+  uint8_t *code = program.code;
+  int pc = 0;
+
+  for (JsonObject step : recipe["steps"].as<JsonArray>()){
+    const char *op = step["op"] | "";
+    auto fits = [&pc](int bytes){return pc + bytes <= JURA_RECIPE_PROGRAM_MAX_BYTES;};
+
+    if (strcmp(op, "press") == 0){
+      JuraFunctionIdentifier function = JuraBridge::functionForKey(step["function"] | "");
+      if (function == JuraFunctionIdentifier::None){return "unknown function";}
+      if (!fits(2)){return "too long";}
+      code[pc++] = (uint8_t) JuraRecipeOpcode::Press;
+      code[pc++] = (uint8_t) function;
+
+    }else if (strcmp(op, "limit") == 0){
+      const char *names[] = {"milk", "brew", "water"};
+      for (int type = 0; type < 3; type++){
+        if (!step.containsKey(names[type])){continue;}
+        if (!fits(4)){return "too long";}
+        int ml = constrain((int) (step[names[type]] | 0), 0, 0xFFFF);
+        code[pc++] = (uint8_t) JuraRecipeOpcode::Limit;
+        code[pc++] = (uint8_t) type;
+        code[pc++] = ml & 0xFF;
+        code[pc++] = ml >> 8;
+      }
+
+    }else if (strcmp(op, "reset") == 0){
+      if (!fits(1)){return "too long";}
+      code[pc++] = (uint8_t) JuraRecipeOpcode::ResetLimits;
+
+    }else if (strcmp(op, "wait") == 0){
+      const char *event = step["event"] | "";
+      JuraRecipeWaitOperand operand;
+      if      (strcmp(event, "ready") == 0)     {operand = JuraRecipeWaitOperand::Ready;}
+      else if (strcmp(event, "dispense") == 0)  {operand = JuraRecipeWaitOperand::DispenseStart;}
+      else if (strcmp(event, "selection") == 0) {operand = JuraRecipeWaitOperand::Selection;}
+      else                                      {return "unknown event";}
+      if (!fits(2)){return "too long";}
+      code[pc++] = (uint8_t) JuraRecipeOpcode::Wait;
+      code[pc++] = (uint8_t) operand;
+
+    }else if (strcmp(op, "add") == 0){
+      int ml = constrain((int) (step["brew"] | 17), 0, 0xFFFF);
+      if (!fits(3)){return "too long";}
+      code[pc++] = (uint8_t) JuraRecipeOpcode::AddShot;
+      code[pc++] = ml & 0xFF;
+      code[pc++] = ml >> 8;
+
+    }else if (strcmp(op, "display") == 0){
+      const char *text = step["text"] | "";
+      int length = strlen(text);
+      if (length > JURA_CUSTOM_MENU_NAME_SIZE - 1){return "display text too long";}
+      if (!fits(2 + length)){return "too long";}
+      code[pc++] = (uint8_t) JuraRecipeOpcode::Display;
+      code[pc++] = (uint8_t) length;
+      memcpy(code + pc, text, length);
+      pc += length;
+
+    }else{
+      return "unknown op";
+    }
+  }
+
+  if (pc == 0){return "no steps";}
+  program.length = pc;
+  return verify(program) ? nullptr : "invalid";
+}
+
+/***************************************************************************//**
+ * Read every slot from nvs; a program that fails verification is ignored.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraRecipeProgramStore::load(){
+  char slotKey[16];
+  for (uint8_t id = 0; id < JURA_RECIPE_PROGRAMS_MAX; id++){
+    key(id, slotKey);
+    size_t length = preferences.getBytesLength(slotKey);
+    if (length < JURA_RECIPE_PROGRAM_HEADER_SIZE || length > sizeof(JuraRecipeProgram)){continue;}
+
+    JuraRecipeProgram program;
+    memset(&program, 0, sizeof(program));
+    preferences.getBytes(slotKey, &program, length);
+    if (!verify(program)){
+      ESP_LOGI(TAG,"--> Recipe %u in nvs is invalid; ignored", id);
+      continue;
+    }
+
+    portENTER_CRITICAL(&_lock);
+    _programs[id] = program;
+    _present[id] = true;
+    portEXIT_CRITICAL(&_lock);
+  }
+}
+
+/***************************************************************************//**
+ * Keep a compiled program in a slot; written to nvs up to the end of its code.
+ *
+ * @param[out] bool false if the slot is out of range or the program is invalid
+ *
+ * @param[in] uint8_t id
+ * @param[in] const JuraRecipeProgram &program
+ ******************************************************************************/
+bool JuraRecipeProgramStore::store(uint8_t id, const JuraRecipeProgram &program){
+  if (id >= JURA_RECIPE_PROGRAMS_MAX || !verify(program)){return false;}
+
+  portENTER_CRITICAL(&_lock);
+  _programs[id] = program;
+  _present[id] = true;
+  portEXIT_CRITICAL(&_lock);
+
+  char slotKey[16];
+  key(id, slotKey);
+  preferences.putBytes(slotKey, &program, JURA_RECIPE_PROGRAM_HEADER_SIZE + program.length);
+  return true;
+}
+
+void JuraRecipeProgramStore::remove(uint8_t id){
+  if (id >= JURA_RECIPE_PROGRAMS_MAX){return;}
+
+  portENTER_CRITICAL(&_lock);
+  _present[id] = false;
+  portEXIT_CRITICAL(&_lock);
+
+  char slotKey[16];
+  key(id, slotKey);
+  preferences.remove(slotKey);
+}
+
+bool JuraRecipeProgramStore::exists(uint8_t id){
+  return id < JURA_RECIPE_PROGRAMS_MAX && _present[id];
+}
+
+bool JuraRecipeProgramStore::copy(uint8_t id, JuraRecipeProgram &program){
+  if (id >= JURA_RECIPE_PROGRAMS_MAX){return false;}
+  portENTER_CRITICAL(&_lock);
+  bool present = _present[id];
+  if (present){program = _programs[id];}
+  portEXIT_CRITICAL(&_lock);
+  return present;
+}
+
+/***************************************************************************//**
+ * Interpret a program. Each instruction becomes one or more recipe engine steps;
+ * the first step that times out ends the run.
+ *
+ * @param[out] bool true if every instruction completed
+ *
+ * @param[in] uint8_t id
+ ******************************************************************************/
+bool JuraRecipeProgramStore::run(uint8_t id){
+  JuraRecipeProgram program;
+  if (!copy(id, program)){return false;}
+
+  /* the whole program is one recipe; no other task's presses in between */
+  _recipes->acquire();
+  _recipes->begin();
+
+  int pc = 0;
+  while (pc < program.length){
+    const uint8_t *instruction = program.code + pc;
+    JuraRecipeStep steps[5];
+    int count = 0;
+
+    switch ((JuraRecipeOpcode) instruction[0]){
+      case JuraRecipeOpcode::Press:
+        steps[count++] = {JuraRecipeStepType::Function, instruction[1]};
+        break;
+
+      case JuraRecipeOpcode::Limit: {
+        const JuraRecipeStepType types[] = {JuraRecipeStepType::MilkLimit, JuraRecipeStepType::BrewLimit, JuraRecipeStepType::WaterLimit};
+        steps[count++] = {types[instruction[1]], instruction[2] | (instruction[3] << 8)};
+        break;
+      }
+
+      case JuraRecipeOpcode::ResetLimits:
+        steps[count++] = {JuraRecipeStepType::ResetLimits, 0};
+        break;
+
+      case JuraRecipeOpcode::Wait: {
+        const JuraRecipeStepType types[] = {JuraRecipeStepType::AwaitReady, JuraRecipeStepType::AwaitDispenseStart, JuraRecipeStepType::AwaitSelection};
+        steps[count++] = {types[instruction[1]], 0};
+        break;
+      }
+
+      case JuraRecipeOpcode::AddShot:
+        steps[count++] = {JuraRecipeStepType::MarkAddShot, 0};
+        steps[count++] = {JuraRecipeStepType::AwaitReady, 0};
+        steps[count++] = {JuraRecipeStepType::BrewLimit, instruction[1] | (instruction[2] << 8)};
+        steps[count++] = {JuraRecipeStepType::Function, (int) JuraFunctionIdentifier::MakeEspresso};
+        steps[count++] = {JuraRecipeStepType::AwaitDispenseStart, 0};
+        break;
+
+      case JuraRecipeOpcode::Display: {
+        char text[JURA_CUSTOM_MENU_NAME_SIZE] = {};
+        memcpy(text, instruction + 2, instruction[1]);
+        _bridge->instructServicePortToDisplayString(text);
+        break;
+      }
+    }
+
+    for (int step = 0; step < count; step++){
+      if (!_recipes->runStep(steps[step])){
+        ESP_LOGI(TAG,"--> Recipe %u: stopped at byte %i (opcode %u)", id, pc, instruction[0]);
+        _recipes->release();
+        return false;
+      }
+    }
+    pc += instructionLength(instruction, program.length - pc);
+  }
+  _recipes->release();
+  return true;
+}
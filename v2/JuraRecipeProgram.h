@@ -0,0 +1,83 @@
+#ifndef JURARECIPEPROGRAM_H
+#define JURARECIPEPROGRAM_H
+#include "JuraConfiguration.h"
+#include "JuraBridge.h"
+#include "JuraRecipe.h"
+#include <ArduinoJson.h>
+
+/* forward declarations */
+class Preferences;
+
+/* instruction set; operands follow the opcode byte, 16 bit values little endian */
+enum class JuraRecipeOpcode : uint8_t {
+  Press = 1,            /* function identifier */
+  Limit,                /* limit type (JuraRecipeLimitOperand), ml lo, ml hi */
+  ResetLimits,          /* none */
+  Wait,                 /* event (JuraRecipeWaitOperand) */
+  AddShot,              /* brew ml lo, ml hi */
+  Display,              /* length, characters (not terminated) */
+};
+
+enum class JuraRecipeLimitOperand : uint8_t {Milk = 0, Brew, Water};
+enum class JuraRecipeWaitOperand  : uint8_t {Ready = 0, DispenseStart, Selection};
+
+/* one compiled recipe; stored in nvs up to the end of its code */
+struct JuraRecipeProgram {
+  uint8_t version;
+  uint8_t length;
+  char name[JURA_CUSTOM_MENU_NAME_SIZE];
+  uint8_t code[JURA_RECIPE_PROGRAM_MAX_BYTES];
+};
+#define JURA_RECIPE_PROGRAM_HEADER_SIZE  (sizeof(JuraRecipeProgram) - JURA_RECIPE_PROGRAM_MAX_BYTES)
+
+/*
+
+  name:         JuraRecipeProgramStore
+  type:         class
+  description:  user recipes, uploaded once as json, compiled on the device to
+                bytecode and kept in nvs; one key per slot. programs are
+                verified on compile and again on load, so the interpreter only
+                ever sees well-formed code.
+
+                the interpreter maps every instruction onto recipe engine steps;
+                each await step has its own timeout and a program is at most
+                JURA_RECIPE_PROGRAM_MAX_BYTES long, so a run is bounded.
+
+*/
+class JuraRecipeProgramStore {
+public:
+  JuraRecipeProgramStore(Preferences &, JuraBridge &, JuraRecipeEngine &);
+
+  /* read every slot from nvs; call after preferences are opened */
+  void load();
+
+  /* compile json {"name":..., "steps":[...]} into a program; returns null or an error message */
+  static const char * compile(JsonObject, JuraRecipeProgram &);
+
+  bool store(uint8_t, const JuraRecipeProgram &);
+  void remove(uint8_t);
+
+  bool exists(uint8_t);
+  bool copy(uint8_t, JuraRecipeProgram &);
+
+private:
+  /* programs run only as orders (JuraOrderQueue::enqueueProgram), on the order worker */
+  friend class JuraOrderQueue;
+
+  /* runs a program; false if it does not exist or a step timed out */
+  bool run(uint8_t);
+
+  Preferences &preferences;
+  JuraBridge * _bridge;
+  JuraRecipeEngine * _recipes;
+
+  JuraRecipeProgram _programs[JURA_RECIPE_PROGRAMS_MAX];
+  bool _present[JURA_RECIPE_PROGRAMS_MAX];
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  static bool verify(const JuraRecipeProgram &);
+  static int instructionLength(const uint8_t *, int);
+  void key(uint8_t, char *);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef JURARESPONSELAYOUTS_H
+#define JURARESPONSELAYOUTS_H
+#include "JuraResponseSource.h"
+
+/* how should we interpret the input board data type */
+enum class JuraInputBoardBinaryResponseInterpretation         {Inverted, AsReported};
+enum class JuraSystemCircuitryBinaryResponseInterpretation    {Inverted, AsReported};
+enum class JuraSystemCircuitryResponseDataType                {Binary, Decimal, Hamming};
+
+/*
+
+  name:         JuraMemoryLineLayout
+  type:         struct
+  description:  RT: eeprom line; sixteen 4-character hex words
+
+*/
+struct JuraMemoryLineLayout : JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "RT";}
+  static constexpr int  responseLength()          {return 64;}
+  static constexpr int  fieldCount()              {return 16;}
+  static constexpr int  fieldOffset(int i)        {return i * 4;}
+  static constexpr int  fieldWidth(int i)         {return 4;}
+  static constexpr unsigned long fieldExpiry()    {return JURA_MACHINE_EEPROM_TIMEOUT;}
+};
+
+/*
+
+  name:         JuraInputControlBoardLayout
+  type:         struct
+  description:  IC: input board; four hex characters read as 16 bits
+
+    0000 0000 0000 0000
+    ^||| |||| |||| ||||  Drainage Tray 0
+     ^|| |||| |||| ||||  Bypass Doser 1
+      ^| |||| |||| ||||  Water Tank 2
+       ^ |||| |||| ||||  Bean Hopper 3
+         ^^|| |||| ||||  Brewgroup Revolution Counter 4 - 5
+           ^| |||| ||||  Flow Meter Revolution Counter 6
+                     ^^  Output Valve Servo Position 14 - 15
+            ? ???? ??     Unknown
+
+*/
+struct JuraInputControlBoardLayout : JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "IC";}
+  static constexpr int  responseLength()          {return 4;}
+  static constexpr int  fieldCount()              {return 4;}
+  static constexpr int  bitsPerField()            {return 4;}
+  static constexpr unsigned long bitExpiry()      {return JURA_MACHINE_INPUT_BOARD_TIMEOUT;}
+  static constexpr bool isResearchBit(int b)      {return b > 6 && b < 14;} /* modify this range based on further research */
+};
+
+/*
+
+  name:         JuraHeatedBeverageLayout
+  type:         struct
+  description:  HZ: heated beverage; mixed single bits and 4-character hex words
+
+    [0-10]   single characters (binary values)
+    [11-15]  hex words at 12, 17, 22, 27, 32
+    [16]     single character at 37 (valve)
+    [17-21]  single characters at 39 - 43
+
+*/
+struct JuraHeatedBeverageLayout : JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "HZ";}
+  static constexpr int  responseLength()          {return 44;}
+  static constexpr int  fieldCount()              {return 22;}
+  static constexpr int  fieldOffset(int i)        {return i < 11 ? i : i < 16 ? 12 + (i - 11) * 5 : i == 16 ? 37 : 39 + (i - 17);}
+  static constexpr int  fieldWidth(int i)         {return (i >= 11 && i < 16) ? 4 : 1;}
+  static constexpr unsigned long fieldExpiry()    {return JURA_MACHINE_HEATED_BEVERAGE_TIMEOUT;}
+};
+
+/*
+
+  name:         JuraSystemCircuitryLayout
+  type:         struct
+  description:  CS: system circuitry; twelve 4-character hex words read as
+                decimal values and as 192 bits; response is sometimes longer
+
+*/
+struct JuraSystemCircuitryLayout : JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "CS";}
+  static constexpr int  responseLength()          {return 44;}
+  static constexpr bool exactLength()             {return false;}
+  static constexpr int  fieldCount()              {return 12;}
+  static constexpr int  fieldOffset(int i)        {return i * 4;}
+  static constexpr int  fieldWidth(int i)         {return 4;}
+  static constexpr int  bitsPerField()            {return 16;}
+  static constexpr unsigned long bitExpiry()      {return JURA_MACHINE_SYSTEM_CIRCUITRY_TIMEOUT;}
+};
+
+/*
+
+  name:         JuraWorkingMemoryLayout
+  type:         struct
+  description:  RM: working memory; RM:xx reads the word at byte address xx
+                as four hex characters. meaning under investigation; read by
+                JuraWorkingMemoryScanner
+
+*/
+struct JuraWorkingMemoryLayout : JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "RM";}
+  static constexpr int  responseLength()          {return 4;}
+  static constexpr int  fieldCount()              {return 4;}
+  static constexpr int  bitsPerField()            {return 4;}
+  static constexpr unsigned long bitExpiry()      {return JURA_MACHINE_INPUT_BOARD_TIMEOUT;}
+};
+
+/* response sources */
+typedef JuraResponseSource<JuraMemoryLineLayout>         JuraMemoryLine;
+typedef JuraResponseSource<JuraInputControlBoardLayout>  JuraInputControlBoard;
+typedef JuraResponseSource<JuraHeatedBeverageLayout>     JuraHeatedBeverage;
+typedef JuraResponseSource<JuraSystemCircuitryLayout>    JuraSystemCircuitry;
+typedef JuraResponseSource<JuraWorkingMemoryLayout>      JuraWorkingMemory;
+
+#endif
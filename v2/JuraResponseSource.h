@@ -0,0 +1,249 @@
+#ifndef JURARESPONSESOURCE_H
+#define JURARESPONSESOURCE_H
+#include "JuraConfiguration.h"
+#include "JuraServicePort.h"
+#include <utility>
+
+/*
+
+  name:         JuraResponseLayoutDefaults
+  type:         struct
+  description:  compile time description of a service port response; layouts
+                derive from this and hide only the members that differ.
+
+                fields are fixed-position hex substrings of the response;
+                bitsPerField > 0 adds a binary view over the fields, MSB first,
+                with global bit index = field * bitsPerField + bit.
+
+*/
+struct JuraResponseLayoutDefaults {
+  static constexpr const char * name()            {return "??";}
+  static constexpr int  responseLength()          {return 0;}
+  static constexpr bool exactLength()             {return true;}   /* false: responseLength is a minimum */
+  static constexpr int  fieldCount()              {return 0;}
+  static constexpr int  fieldOffset(int i)        {return i;}
+  static constexpr int  fieldWidth(int i)         {return 1;}
+  static constexpr int  bitsPerField()            {return 0;}
+  static constexpr unsigned long fieldExpiry()    {return 0;}      /* ms before an unchanged field is flagged again; 0 never */
+  static constexpr unsigned long bitExpiry()      {return 0;}      /* ms before unchanged bits are flagged again; 0 never */
+  static constexpr uint16_t ignoreMask(int i)     {return 0;}      /* bits never reported as updated */
+  static constexpr bool isResearchBit(int b)      {return true;}   /* bits reported by printUnhandledUpdate */
+};
+
+/*
+
+  name:         JuraResponseSource
+  type:         class template
+  description:  polls a single service port command and decodes the response
+                per Layout. decode and change detection are generated per field
+                at compile time; values are stored once as 16-bit words, with
+                binary change flags kept as a mask per word.
+
+*/
+template <class Layout>
+class JuraResponseSource {
+public:
+  static constexpr int FIELD_COUNT    = Layout::fieldCount();
+  static constexpr int BITS_PER_FIELD = Layout::bitsPerField();
+  static constexpr int BIT_COUNT      = FIELD_COUNT * BITS_PER_FIELD;
+  static constexpr int BIT_STRIDE     = BITS_PER_FIELD > 0 ? BITS_PER_FIELD : 1;
+
+  static_assert(FIELD_COUNT > 0 && FIELD_COUNT <= 32, "field change flags are kept in a 32-bit mask");
+  static_assert(BITS_PER_FIELD >= 0 && BITS_PER_FIELD <= 16, "fields are stored as 16-bit words");
+
+  JuraResponseSource() {
+    for (int i = 0; i < FIELD_COUNT; i++){
+      _bit_ignore[i] = Layout::ignoreMask(i);
+    }
+  }
+
+  /* sets the poll rate; didUpdate will return 0 if poll iterator is false */
+  void  setPollRate           (int modulus)                     {_poll_rate = modulus;}
+  void  setCommand            (JuraServicePortCommand command)  {_default_command = command;}
+
+  /* ignore bits at runtime, in addition to the layout's ignore mask */
+  void  setBinIndexIgnore     (int index, int bits = 1){
+    if (!validBitRange(index, bits)){return;}
+    for (int i = index; i < index + bits; i++){
+      _bit_ignore[i / BIT_STRIDE] |= bitMask(i);
+    }
+  }
+
+  /* caller to service port with instance-configured command; if no change from previous result, return false */
+  bool  didUpdate             (int iterator, JuraServicePort &servicePort){
+    if (_poll_rate == 0) {return false;}
+    if (iterator % _poll_rate != 0){return false;}
+
+    String response = servicePort.transferEncodeCommand(_default_command);
+
+    /* invalid response */
+    int length = (int) response.length();
+    if (Layout::exactLength() ? (length != Layout::responseLength()) : (length < Layout::responseLength())){
+      return false;
+    }
+
+    return decodeFields(response.c_str(), length, millis(), std::make_index_sequence<FIELD_COUNT>());
+  }
+
+  /* decimal interpretation; one value per field */
+  bool  hasUpdateForDecimalValueOfServicePortResponseSubstringIndex (int index){
+    if (index < 0 || index >= FIELD_COUNT){return false;}
+    return (_field_new_available >> index) & 1;
+  }
+
+  int   returnDecimalValueOfServicePortResponseSubstringIndex       (int index){
+    if (index < 0 || index >= FIELD_COUNT){return 0;}
+    _field_new_available &= ~(1UL << index);
+    _bit_new_available[index] = 0;
+    return _value[index];
+  }
+
+  unsigned long lastChangeForDecimalValueOfServicePortResponseSubstringIndex (int index){
+    if (index < 0 || index >= FIELD_COUNT){return 0;}
+    return _last_changed_ms[index];
+  }
+
+  /* binary interpretation; bit range read MSB first */
+  bool  hasUpdateForValueOfServicePortResponseSubstringIndex        (int index, int bits = 1){
+    if (!validBitRange(index, bits)){return false;}
+    bool _isChanging = false;
+    for (int i = index; i < index + bits; i++){
+      if (_bit_ignore[i / BIT_STRIDE] & bitMask(i)){return false;}
+      if (_bit_new_available[i / BIT_STRIDE] & bitMask(i)){_isChanging = true;}
+    }
+    return _isChanging;
+  }
+
+  int   returnValueOfServicePortResponseSubstringIndex              (int index, int bits = 1){
+    if (!validBitRange(index, bits)){return 0;}
+    int decimal = 0;
+    for (int i = index; i < index + bits; i++){
+      _bit_new_available[i / BIT_STRIDE] &= ~bitMask(i);
+      decimal = (decimal << 1) | bitValue(i);
+    }
+    return decimal;
+  }
+
+  int   returnHammingValueOfServicePortResponseSubstringIndex       (int index, int bits = 1){
+    if (!validBitRange(index, bits)){return 0;}
+    int hamming = 0;
+    for (int i = index; i < index + bits; i++){
+      _bit_new_available[i / BIT_STRIDE] &= ~bitMask(i);
+      hamming += bitValue(i);
+    }
+    return hamming;
+  }
+
+  /* investigations into unhandled updates */
+  bool  hasUnhandledUpdate    (){
+    for (int i = 0; i < FIELD_COUNT; i++){
+      if constexpr (BITS_PER_FIELD > 0){
+        if (_bit_new_available[i] & ~_bit_ignore[i]){return true;}
+      } else if (((_field_new_available >> i) & 1) && _value_prev[i] != 0){
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void  printUnhandledUpdate  (){
+    for (int i = 0; i < FIELD_COUNT; i++){
+      if constexpr (BITS_PER_FIELD > 0){
+        for (int b = i * BITS_PER_FIELD; b < (i + 1) * BITS_PER_FIELD; b++){
+          uint16_t mask = bitMask(b);
+          if ((_bit_new_available[i] & mask) && !(_bit_ignore[i] & mask) && Layout::isResearchBit(b) && ((_value_prev[i] ^ _value[i]) & mask)){
+            ESP_LOGI(TAG,"UKN: [cmd:%s] [0x i:%d] [0b i:%d] = %d -> %d (0d = %i)", Layout::name(), i, b, (_value_prev[i] & mask) != 0, (_value[i] & mask) != 0, _value[i]);
+            _bit_new_available[i] &= ~mask;
+          }
+        }
+      } else if (((_field_new_available >> i) & 1) && _value_prev[i] != 0 && _value_prev[i] != _value[i]){
+        ESP_LOGI(TAG,"UKN: [cmd:%s:%d] [i:%d] = %d -> %d", Layout::name(), (int) _default_command, i, _value_prev[i], _value[i]);
+        _field_new_available &= ~(1UL << i);
+      }
+    }
+  }
+
+private:
+  JuraServicePortCommand _default_command = JuraServicePortCommand::None;
+  int _poll_rate = 0;
+
+  /* one word per field; prev holds the value before the most recent change */
+  uint16_t _value [FIELD_COUNT] =                 {};
+  uint16_t _value_prev [FIELD_COUNT] =            {};
+
+  /* change detection */
+  uint32_t _field_new_available =                 0;
+  uint16_t _bit_new_available [FIELD_COUNT] =     {};
+  uint16_t _bit_ignore [FIELD_COUNT];
+
+  /* timestamps; flagged is the last change or forced refresh */
+  unsigned long _last_changed_ms [FIELD_COUNT] =  {};
+  unsigned long _last_flagged_ms [FIELD_COUNT] =  {};
+
+  static constexpr uint16_t fieldMask(){
+    return BITS_PER_FIELD >= 16 ? 0xFFFF : (uint16_t) ((1U << BITS_PER_FIELD) - 1);
+  }
+
+  static uint16_t bitMask(int index){
+    return (uint16_t) (1U << (BITS_PER_FIELD - 1 - (index % BIT_STRIDE)));
+  }
+
+  int bitValue(int index){
+    return (_value[index / BIT_STRIDE] & bitMask(index)) != 0;
+  }
+
+  static bool validBitRange(int index, int bits){
+    return BITS_PER_FIELD > 0 && index >= 0 && bits > 0 && index + bits <= BIT_COUNT;
+  }
+
+  /* hex digits at a fixed position; stops at the first non-hex character, as strtol would */
+  template <int Offset, int Width>
+  static uint16_t parseHexField(const char * response, int length){
+    uint16_t value = 0;
+    for (int k = 0; k < Width && Offset + k < length; k++){
+      char c = response[Offset + k];
+      int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+      if (digit < 0){break;}
+      value = (value << 4) | digit;
+    }
+    return value;
+  }
+
+  /* one instantiation per field; offsets and widths are constants */
+  template <int I>
+  bool decodeField(const char * response, int length, unsigned long now){
+    static_assert(Layout::fieldWidth(I) >= 1 && Layout::fieldWidth(I) <= 4, "fields are at most four hex characters");
+
+    uint16_t value = parseHexField<Layout::fieldOffset(I), Layout::fieldWidth(I)>(response, length);
+
+    /* changed: flag the field and only the bits that differ */
+    if (value != _value[I]){
+      _bit_new_available[I] |= (value ^ _value[I]) & fieldMask();
+      _field_new_available |= (1UL << I);
+      _value_prev[I] = _value[I];
+      _value[I] = value;
+      _last_changed_ms[I] = now;
+      _last_flagged_ms[I] = now;
+      return true;
+    }
+
+    /* force updates on timeout */
+    bool fieldExpired = Layout::fieldExpiry() > 0 && (now - _last_flagged_ms[I]) > Layout::fieldExpiry();
+    bool bitExpired = BITS_PER_FIELD > 0 && Layout::bitExpiry() > 0 && (now - _last_flagged_ms[I]) > Layout::bitExpiry();
+    if (fieldExpired || bitExpired){
+      if (fieldExpired){_field_new_available |= (1UL << I);}
+      if (bitExpired){_bit_new_available[I] = fieldMask();}
+      _last_flagged_ms[I] = now;
+      return true;
+    }
+    return false;
+  }
+
+  /* unrolled over every field in the layout */
+  template <size_t... I>
+  bool decodeFields(const char * response, int length, unsigned long now, std::index_sequence<I...>){
+    return (decodeField<(int) I>(response, length, now) | ...);
+  }
+};
+
+#endif
@@ -1,146 +1,96 @@
 #include "JuraServicePort.h"
 
 /* init from JuraConfiguration.h variables */
-JuraServicePort::JuraServicePort(SemaphoreHandle_t &xUARTSemaphoreRef) :  _xUARTSemaphore(xUARTSemaphoreRef), juraSerial(DEV_BOARD_UART_ID) {
+JuraServicePort::JuraServicePort() :  juraSerial(DEV_BOARD_UART_ID) {
   juraSerial.begin(9600, SERIAL_8N1, DEV_BOARD_UART_RX_PIN, DEV_BOARD_UART_TX_PIN);
   juraSerial.setRxTimeout(DEV_BOARD_UART_TIMEOUT);
 }
 
-/* known commands generated from static strings for memory management */
-String JuraServicePort::transferEncodeCommand(JuraServicePortCommand command) {
-  switch (command){
-    /* historical data */
-    case JuraServicePortCommand::RT0:
-      return this->transferEncode(STATIC_CMD_RT0);
-      break;
-    case JuraServicePortCommand::RT1:
-      return this->transferEncode(STATIC_CMD_RT1);
-      break;
-    case JuraServicePortCommand::RT2:
-      return this->transferEncode(STATIC_CMD_RT2);
-      break;
-    case JuraServicePortCommand::RT3:
-      return this->transferEncode(STATIC_CMD_RT3);
-      break;
-    case JuraServicePortCommand::RT4:
-      return this->transferEncode(STATIC_CMD_RT4);
-      break;
-    case JuraServicePortCommand::RT5:
-      return this->transferEncode(STATIC_CMD_RT5);
-      break;
-    case JuraServicePortCommand::RT6:
-      return this->transferEncode(STATIC_CMD_RT6);
-      break;
-    case JuraServicePortCommand::RT7:
-      return this->transferEncode(STATIC_CMD_RT7);
-      break;
-    case JuraServicePortCommand::RT8:
-      return this->transferEncode(STATIC_CMD_RT8);
-      break;
-    case JuraServicePortCommand::RT9:
-      return this->transferEncode(STATIC_CMD_RT9);
-      break;
-    case JuraServicePortCommand::RTA:
-      return this->transferEncode(STATIC_CMD_RTA);
-      break;
-    case JuraServicePortCommand::RTB:
-      return this->transferEncode(STATIC_CMD_RTB);
-      break;
-    case JuraServicePortCommand::RTC:
-      return this->transferEncode(STATIC_CMD_RTC);
-      break;
-    case JuraServicePortCommand::RTD:
-      return this->transferEncode(STATIC_CMD_RTD);
-      break;
-    case JuraServicePortCommand::RTE:
-      return this->transferEncode(STATIC_CMD_RTE);
-      break;
-    case JuraServicePortCommand::RTF:
-      return this->transferEncode(STATIC_CMD_RTF);
-      break;
-    /* real-time data */
-    case JuraServicePortCommand::IC:
-      return this->transferEncode(STATIC_CMD_IC);
-      break;
-    case JuraServicePortCommand::HZ:
-      return this->transferEncode(STATIC_CMD_HZ);
-      break;
-    case JuraServicePortCommand::CS:
-      return this->transferEncode(STATIC_CMD_CS);
-      break;
-
-    /* machine commands */
-    case JuraServicePortCommand::FA_01:
-      return this->transferEncode(STATIC_CMD_FA_01);
-      break;
-    case JuraServicePortCommand::FA_02:
-      return this->transferEncode(STATIC_CMD_FA_02);
-      break;
-    case JuraServicePortCommand::FA_03:
-      return this->transferEncode(STATIC_CMD_FA_03);
-      break;
-    case JuraServicePortCommand::FA_04:
-      return this->transferEncode(STATIC_CMD_FA_04);
-      break;
-    case JuraServicePortCommand::FA_05:
-      return this->transferEncode(STATIC_CMD_FA_05);
-      break;
-    case JuraServicePortCommand::FA_06:
-      return this->transferEncode(STATIC_CMD_FA_06);
-      break;
-    case JuraServicePortCommand::FA_07:
-      return this->transferEncode(STATIC_CMD_FA_07);
-      break;
-    case JuraServicePortCommand::FA_08:
-      return this->transferEncode(STATIC_CMD_FA_08);
-      break;
-    case JuraServicePortCommand::FA_09:
-      return this->transferEncode(STATIC_CMD_FA_09);
-      break;
-    case JuraServicePortCommand::FA_0A:
-      return this->transferEncode(STATIC_CMD_FA_0A);
-      break;
-    case JuraServicePortCommand::FA_0B:
-      return this->transferEncode(STATIC_CMD_FA_0B);
-      break;
-    case JuraServicePortCommand::FA_0C:
-      return this->transferEncode(STATIC_CMD_FA_0C);
-      break;
-
-    default: 
-      break;
+/* known commands are pre-encoded at compile time; the wire bytes are sent straight from flash */
+String JuraServicePort::transferEncodeCommand(JuraServicePortCommand command, JuraUartLane lane) {
+  int index = (int) command;
+  int address = index - (int) JuraServicePortCommand::RM00;
+  if (address >= 0 && address < JURA_WORKING_MEMORY_WORDS){
+    const JuraWireCommand &wire = JuraWireMemory.entries[address];
+    return this->transfer(wire.bytes, wire.length, _char_gap_us, true, lane);
   }
-  return "";
+  if (index <= 0 || index >= JuraWireCommandCount){return "";}
+  const JuraWireCommand &wire = JuraWireCommands[index];
+  return this->transfer(wire.bytes, wire.length, _char_gap_us, true, lane);
 }
 
-String JuraServicePort::transferEncode(String outbytes) {
-
-  /* take the shared semaphore for UART; if sampling should be paused then block this request  */
-  xSemaphoreTake( _xUARTSemaphore, portMAX_DELAY );
+String JuraServicePort::transferEncodeCommandAtGap(JuraServicePortCommand command, unsigned long gap) {
+  int index = (int) command;
+  if (index <= 0 || index >= JuraWireCommandCount){return "";}
+  const JuraWireCommand &wire = JuraWireCommands[index];
+  return this->transfer(wire.bytes, wire.length, gap, false, JuraUartLane::Background);
+}
 
-  String inbytes;
-  inbytes.reserve(100);
-  int w = 0;
+/* offline: a cheap read-only command, at the backoff interval; the transfer updates the connection */
+bool JuraServicePort::probeIfDue() {
+  if (!connection.beginProbe(millis())){return false;}
+  return this->transferEncodeCommand(JuraServicePortCommand::IC).length() > 0;
+}
 
-  // Timeout for available read
-  while (juraSerial.available()) {
-    juraSerial.read();
-  }
-  
-  outbytes += "\r\n";
+/* free-form commands (display text) are encoded per call; text beyond JURA_WIRE_DYNAMIC_MAX is dropped */
+String JuraServicePort::transferEncode(String outbytes, JuraUartLane lane) {
+  uint8_t wire[(JURA_WIRE_DYNAMIC_MAX + 2) * JURA_WIRE_BYTES_PER_CHAR];
+  size_t length = 0;
+  int n = outbytes.length() < JURA_WIRE_DYNAMIC_MAX ? outbytes.length() : JURA_WIRE_DYNAMIC_MAX;
+  outbytes = outbytes.substring(0, n) + "\r\n";
   for (int i = 0; i < outbytes.length(); i++) {
     for (int s = 0; s < 8; s += 2) {
-      char rawbyte = 255;
-      bitWrite(rawbyte, 2, bitRead(outbytes.charAt(i), s + 0));
-      bitWrite(rawbyte, 5, bitRead(outbytes.charAt(i), s + 1));
-      juraSerial.write(rawbyte);
+      wire[length++] = encodeWireBits(outbytes.charAt(i), s);
     }
-     vTaskDelay(8 / portTICK_PERIOD_MS);
+  }
+  return this->transfer(wire, length, _char_gap_us, true, lane);
+}
+
+/***************************************************************************//**
+ * Write an encoded command, one character at a time, and read the reply. The
+ * wait for a reply shortens as the connection degrades; untracked transfers
+ * (calibration trials) never wait longer than a degraded link. A reply wait
+ * cut short for a higher lane is not counted as unanswered, and the command is
+ * reported as delivered: it went out in full, and resending a press that may
+ * have registered would press it twice. Lines that do not answer this command
+ * (the tail of a cut reply) are skipped.
+ *
+ * @param[out] String response without status prefix; empty on timeout
+ *
+ * @param[in] const uint8_t *wire encoded bytes, crlf included
+ * @param[in] size_t length
+ * @param[in] unsigned long gap after each character, us
+ * @param[in] bool tracked counts toward connection health and gap fallback
+ * @param[in] JuraUartLane lane
+ ******************************************************************************/
+String JuraServicePort::transfer(const uint8_t * wire, size_t length, unsigned long gap, bool tracked, JuraUartLane lane) {
+
+  /* wait for the port behind higher lanes */
+  arbiter.acquire(lane);
+
+  String inbytes;
+  inbytes.reserve(100);
+  unsigned long timeout = tracked ? connection.responseTimeout() : JURA_CONNECTION_DEGRADED_TIMEOUT_MS;
+
+  /* clear the line; the rest of an abandoned reply must not be read as ours */
+  drain();
+
+  for (size_t i = 0; i < length; i += JURA_WIRE_BYTES_PER_CHAR) {
+    juraSerial.write(wire + i, JURA_WIRE_BYTES_PER_CHAR);
+    characterGap(gap);
   }
 
   int s = 0;
   char inbyte;
-  while (!inbytes.endsWith("\r\n")) {
+  unsigned long started = millis();
+  while (!inbytes.endsWith("\r\n") || !replyMatches(wire, inbytes)) {
+
+    /* a whole line for another command */
+    if (inbytes.endsWith("\r\n")){
+      ESP_LOGD(TAG,"--> Service port: skipped stale reply");
+      inbytes = "";
+    }
+
     if (juraSerial.available()) {
       byte rawbyte = juraSerial.read();
       bitWrite(inbyte, s + 0, bitRead(rawbyte, 2));
@@ -152,25 +102,145 @@ String JuraServicePort::transferEncode(String outbytes) {
     } else {
        vTaskDelay( 10 / portTICK_PERIOD_MS);
     }
-    if (w++ > 500) {
-      isConnected = false;
-      xSemaphoreGive( _xUARTSemaphore);
+    unsigned long waited = millis() - started;
+    bool preempted = (lane == JuraUartLane::Background || (lane == JuraUartLane::User && waited > JURA_UART_PREEMPT_GRACE_MS)) && arbiter.contended(lane);
+    if (waited > timeout || preempted) {
+      _stale = true;
+      _stale_phase = s;
+      if (preempted){
+        arbiter.notePreempted(lane);
+        if (tracked){isConnected = true;}
+      } else if (tracked){
+        isConnected = false;
+        trackCharacterGap(false);
+        connection.record(false, millis());
+      }
+      arbiter.release();
       return "";
     }
   }
 
-  /* give back the semaphore here */
-  xSemaphoreGive( _xUARTSemaphore);
+  /* hand the port on here */
+  if (tracked){
+    trackCharacterGap(true);
+    connection.record(true, millis());
+  }
+  arbiter.release();
 
   /* Return full rx response without status prefix (e.g., "IC:...") */
+  if (tracked){isConnected = inbytes.length() > 0;}
   if (inbytes.length() > 3) {
-    isConnected = true;
     return inbytes.substring(3, inbytes.length() - 2);
   } else if (inbytes.length() > 0 ) {
-    isConnected = true;
     return inbytes.substring(0, inbytes.length() - 2);
   }else {
-    isConnected = false;
     return "";
   }
 }
+
+/***************************************************************************//**
+ * Empty the receive buffer before a command. After an abandoned reply, keep
+ * reading in that reply's bit phase until its crlf, or until the line has been
+ * quiet for JURA_UART_DRAIN_QUIET_MS, so the next reply starts aligned. Caller
+ * holds the port.
+ *
+ * @param[out] null
+ ******************************************************************************/
+void JuraServicePort::drain() {
+  if (!_stale){
+    while (juraSerial.available()) {
+      juraSerial.read();
+    }
+    return;
+  }
+  _stale = false;
+
+  int s = _stale_phase;
+  char inbyte = 0;
+  char last = 0;
+  unsigned long started = millis();
+  unsigned long heard = started;
+  while (millis() - heard < JURA_UART_DRAIN_QUIET_MS && millis() - started < JURA_UART_DRAIN_MAX_MS) {
+    if (!juraSerial.available()) {
+      vTaskDelay(1);
+      continue;
+    }
+    byte rawbyte = juraSerial.read();
+    heard = millis();
+    bitWrite(inbyte, s + 0, bitRead(rawbyte, 2));
+    bitWrite(inbyte, s + 1, bitRead(rawbyte, 5));
+    if ((s += 2) >= 8) {
+      s = 0;
+      if (last == '\r' && inbyte == '\n'){break;}
+      last = inbyte;
+    }
+  }
+  while (juraSerial.available()) {
+    juraSerial.read();
+  }
+}
+
+/***************************************************************************//**
+ * A reply answers a command if it echoes the command's two letter prefix in
+ * lower case ("rt:" for "RT:0000") or is the plain acknowledgement "ok:" that
+ * button and display commands get.
+ *
+ * @param[out] bool
+ *
+ * @param[in] const uint8_t *wire encoded command
+ * @param[in] const String &reply crlf included
+ ******************************************************************************/
+bool JuraServicePort::replyMatches(const uint8_t * wire, const String &reply) {
+  if (reply.length() < 3 || reply.charAt(2) != ':'){return true;}
+  if (reply.startsWith("ok:")){return true;}
+
+  for (int c = 0; c < 2; c++) {
+    char command = 0;
+    for (int s = 0; s < 8; s += 2) {
+      const uint8_t rawbyte = wire[c * JURA_WIRE_BYTES_PER_CHAR + s / 2];
+      bitWrite(command, s + 0, bitRead(rawbyte, 2));
+      bitWrite(command, s + 1, bitRead(rawbyte, 5));
+    }
+    if (tolower(command) != reply.charAt(c)){return false;}
+  }
+  return true;
+}
+
+/* whole milliseconds yield; the remainder is too short to be worth a tick */
+void JuraServicePort::characterGap(unsigned long gap) {
+  if (gap >= 1000){vTaskDelay(pdMS_TO_TICKS(gap / 1000));}
+  if (gap % 1000){delayMicroseconds(gap % 1000);}
+}
+
+/***************************************************************************//**
+ * Count unanswered transfers at a calibrated gap while the machine is online;
+ * a machine turning off costs one failure before the connection degrades. Too
+ * many in a window restore the default gap. Caller holds the port.
+ *
+ * @param[out] null
+ *
+ * @param[in] bool answered
+ ******************************************************************************/
+void JuraServicePort::trackCharacterGap(bool answered) {
+  if (_char_gap_us >= DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL){return;}
+
+  if (!answered && connection.state() == JuraConnectionState::Online){_gap_failures++;}
+  if (_gap_failures >= JURA_UART_FALLBACK_FAILURES){
+    ESP_LOGI(TAG,"--> UART: %d unanswered in %d transfers at %lu us; default gap restored", _gap_failures, _gap_transfers, _char_gap_us);
+    _char_gap_us = DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL;
+    _gap_fell_back = true;
+    _gap_transfers = 0;
+    _gap_failures = 0;
+    return;
+  }
+  if (++_gap_transfers >= JURA_UART_FALLBACK_WINDOW){
+    _gap_transfers = 0;
+    _gap_failures = 0;
+  }
+}
+
+bool JuraServicePort::takeCharacterGapFallback() {
+  bool fellBack = _gap_fell_back;
+  _gap_fell_back = false;
+  return fellBack;
+}
@@ -2,64 +2,149 @@
 #define JURASERVICEPORT_H
 #include <Arduino.h>
 #include "JuraConfiguration.h"
+#include "JuraConnection.h"
+#include "JuraUartArbiter.h"
+
+/* a static command as sent on the wire: obfuscated, crlf included */
+struct JuraWireCommand {
+  JuraServicePortCommand command;
+  uint8_t bytes[JURA_WIRE_COMMAND_MAX * JURA_WIRE_BYTES_PER_CHAR];
+  uint8_t length;
+};
+
+/* two data bits per wire byte, in bits 2 and 5; all other bits high */
+constexpr uint8_t encodeWireBits(char c, int s){
+  return (0xFF & ~0x24) | (((c >> s) & 1) << 2) | (((c >> (s + 1)) & 1) << 5);
+}
+
+/* encodes at compile time; a command longer than JURA_WIRE_COMMAND_MAX fails to build */
+constexpr JuraWireCommand encodeWireCommand(JuraServicePortCommand command, const char * text){
+  JuraWireCommand wire {command, {}, 0};
+  char line[JURA_WIRE_COMMAND_MAX] {};
+  int n = 0;
+  while (text[n] != '\0'){line[n] = text[n]; n++;}
+  line[n++] = '\r';
+  line[n++] = '\n';
+  for (int i = 0; i < n; i++){
+    for (int s = 0; s < 8; s += 2){wire.bytes[wire.length++] = encodeWireBits(line[i], s);}
+  }
+  return wire;
+}
+
+/* prefer static commands so no unknown commands are sent to the machine; indexed by command, in enum order */
+static constexpr JuraWireCommand JuraWireCommands[] = {
+  {JuraServicePortCommand::None, {}, 0},
+
+  /* EEPROM */
+  encodeWireCommand(JuraServicePortCommand::RT0, "RT:0000"),
+  encodeWireCommand(JuraServicePortCommand::RT1, "RT:0010"),
+  encodeWireCommand(JuraServicePortCommand::RT2, "RT:0020"),
+  encodeWireCommand(JuraServicePortCommand::RT3, "RT:0030"),
+  encodeWireCommand(JuraServicePortCommand::RT4, "RT:0040"),
+  encodeWireCommand(JuraServicePortCommand::RT5, "RT:0050"),
+  encodeWireCommand(JuraServicePortCommand::RT6, "RT:0060"),
+  encodeWireCommand(JuraServicePortCommand::RT7, "RT:0070"),
+  encodeWireCommand(JuraServicePortCommand::RT8, "RT:0080"),
+  encodeWireCommand(JuraServicePortCommand::RT9, "RT:0090"),
+  encodeWireCommand(JuraServicePortCommand::RTA, "RT:00A0"),
+  encodeWireCommand(JuraServicePortCommand::RTB, "RT:00B0"),
+  encodeWireCommand(JuraServicePortCommand::RTC, "RT:00C0"),
+  encodeWireCommand(JuraServicePortCommand::RTD, "RT:00D0"),
+  encodeWireCommand(JuraServicePortCommand::RTE, "RT:00E0"),
+  encodeWireCommand(JuraServicePortCommand::RTF, "RT:00F0"),
+
+  encodeWireCommand(JuraServicePortCommand::HZ, "HZ:"),
+  encodeWireCommand(JuraServicePortCommand::CS, "CS:"),
+  encodeWireCommand(JuraServicePortCommand::IC, "IC:"),
+
+  encodeWireCommand(JuraServicePortCommand::FA_01, "FA:01"),
+  encodeWireCommand(JuraServicePortCommand::FA_02, "FA:02"),
+  encodeWireCommand(JuraServicePortCommand::FA_03, "FA:03"),
+  encodeWireCommand(JuraServicePortCommand::FA_04, "FA:04"),
+  encodeWireCommand(JuraServicePortCommand::FA_05, "FA:05"),
+  encodeWireCommand(JuraServicePortCommand::FA_06, "FA:06"),
+  encodeWireCommand(JuraServicePortCommand::FA_07, "FA:07"),
+  encodeWireCommand(JuraServicePortCommand::FA_08, "FA:08"),
+  encodeWireCommand(JuraServicePortCommand::FA_09, "FA:09"),
+  encodeWireCommand(JuraServicePortCommand::FA_0A, "FA:0A"),
+  encodeWireCommand(JuraServicePortCommand::FA_0B, "FA:0B"),
+  encodeWireCommand(JuraServicePortCommand::FA_0C, "FA:0C"),
+
+  /* single eeprom words */
+  encodeWireCommand(JuraServicePortCommand::RE1F, "RE:1F"),
+};
+static constexpr int JuraWireCommandCount = sizeof(JuraWireCommands) / sizeof(JuraWireCommands[0]);
+
+constexpr bool wireCommandsInOrder(){
+  for (int i = 0; i < JuraWireCommandCount; i++){
+    if ((int) JuraWireCommands[i].command != i){return false;}
+  }
+  return true;
+}
+static_assert(wireCommandsInOrder(), "JuraWireCommands must follow JuraServicePortCommand order");
+
+/* RM: working memory; one command per byte address, generated */
+struct JuraWireMemoryCommands {
+  JuraWireCommand entries[JURA_WORKING_MEMORY_WORDS];
+};
+
+constexpr JuraWireMemoryCommands encodeWireMemoryCommands(){
+  JuraWireMemoryCommands table {};
+  for (int a = 0; a < JURA_WORKING_MEMORY_WORDS; a++){
+    const char text[] = {'R', 'M', ':', "0123456789ABCDEF"[a >> 4], "0123456789ABCDEF"[a & 0xF], '\0'};
+    table.entries[a] = encodeWireCommand((JuraServicePortCommand) ((int) JuraServicePortCommand::RM00 + a), text);
+  }
+  return table;
+}
+
+static constexpr JuraWireMemoryCommands JuraWireMemory = encodeWireMemoryCommands();
+static_assert((int) JuraServicePortCommand::RMDF - (int) JuraServicePortCommand::RM00 + 1 == JURA_WORKING_MEMORY_WORDS, "one RM command per working memory word");
 
 class JuraServicePort {
 public:
-  JuraServicePort(SemaphoreHandle_t &);
+  JuraServicePort();
   bool isConnected;
-  
+
+  /* one transfer at a time, highest lane first */
+  JuraUartArbiter arbiter;
+
+  /* link health; polling stops while offline */
+  JuraConnectionMonitor connection;
+  bool probeIfDue();
+
 
   /* from cmd2jura */
-  String transferEncode(String);
-  String transferEncodeCommand(JuraServicePortCommand);
+  String transferEncode(String, JuraUartLane = JuraUartLane::User);
+  String transferEncodeCommand(JuraServicePortCommand, JuraUartLane = JuraUartLane::Background);
+
+  /* pause after each character (us); calibrated at runtime, DEV_BOARD_UART_CHAR_DELAY_MS until then */
+  void setCharacterGap(unsigned long gap) {_char_gap_us = gap;}
+  unsigned long characterGap() {return _char_gap_us;}
+
+  /* calibration trial; not counted toward connection health or fallback */
+  String transferEncodeCommandAtGap(JuraServicePortCommand, unsigned long);
+
+  /* true once after unanswered transfers at a calibrated gap restored the default */
+  bool takeCharacterGapFallback();
 
 private:
   HardwareSerial juraSerial;
-  SemaphoreHandle_t &_xUARTSemaphore;
 
-  /* ----- constants ----- */
+  /* character gap and its error rate while online */
+  volatile unsigned long _char_gap_us = DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL;
+  int _gap_transfers = 0;
+  int _gap_failures = 0;
+  volatile bool _gap_fell_back = false;
 
-  inline static const String STATIC_CMD_TL = "TL:";
-  inline static const String STATIC_CMD_TY = "TY:";
+  /* a reply was abandoned mid-wait; its tail may still arrive, decoded from this bit phase */
+  bool _stale = false;
+  int _stale_phase = 0;
 
-  /* EEPROM */
-  inline static const String STATIC_CMD_RT0  =  "RT:0000";
-  inline static const String STATIC_CMD_RT1  =  "RT:0010";
-  inline static const String STATIC_CMD_RT2  =  "RT:0020";
-  inline static const String STATIC_CMD_RT3  =  "RT:0030";
-  inline static const String STATIC_CMD_RT4  =  "RT:0040";
-  inline static const String STATIC_CMD_RT5  =  "RT:0050";
-  inline static const String STATIC_CMD_RT6  =  "RT:0060";
-  inline static const String STATIC_CMD_RT7  =  "RT:0070";
-  inline static const String STATIC_CMD_RT8  =  "RT:0080";
-  inline static const String STATIC_CMD_RT9  =  "RT:0090";
-  inline static const String STATIC_CMD_RTA  =  "RT:00A0";
-  inline static const String STATIC_CMD_RTB  =  "RT:00B0";
-  inline static const String STATIC_CMD_RTC  =  "RT:00C0";
-  inline static const String STATIC_CMD_RTD  =  "RT:00D0";
-  inline static const String STATIC_CMD_RTE  =  "RT:00E0";
-  inline static const String STATIC_CMD_RTF  =  "RT:00F0";
-
-
-  inline static const String STATIC_CMD_IC  =  "IC:";
-  inline static const String STATIC_CMD_HZ  =  "HZ:";
-  inline static const String STATIC_CMD_CS  =  "CS:";
-
-  /* prefer static commands so no unknown commands are sent to the machine */
-  inline static const String STATIC_CMD_FA_01	=	"FA:01";
-  inline static const String STATIC_CMD_FA_02	=	"FA:02";
-  inline static const String STATIC_CMD_FA_03	=	"FA:03";
-  inline static const String STATIC_CMD_FA_04	=	"FA:04";
-  inline static const String STATIC_CMD_FA_05	=	"FA:05";
-  inline static const String STATIC_CMD_FA_06	=	"FA:06";
-  inline static const String STATIC_CMD_FA_07	=	"FA:07";
-  inline static const String STATIC_CMD_FA_08	=	"FA:08";
-  inline static const String STATIC_CMD_FA_09	=	"FA:09";
-  inline static const String STATIC_CMD_FA_0A	=	"FA:0A";
-  inline static const String STATIC_CMD_FA_0B	=	"FA:0B";
-  inline static const String STATIC_CMD_FA_0C	=	"FA:0C";
-
-  /* memory locations */
+  String transfer(const uint8_t *, size_t, unsigned long, bool, JuraUartLane);
+  void drain();
+  static bool replyMatches(const uint8_t *, const String &);
+  void characterGap(unsigned long);
+  void trackCharacterGap(bool);
 };
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,133 @@
+#include "JuraShotProfile.h"
+#include "esp_heap_caps.h"
+
+JuraShotProfileRecorder::JuraShotProfileRecorder() {
+  _storage = nullptr;
+  _head = 0;
+  _count = 0;
+  _sequence = 0;
+  _recording = false;
+  _last_sample_ms = 0;
+  for (int i = 0; i < SHOT_PROFILE_HISTORY_SIZE; i++){
+    _profiles[i] = {0, 0, false, 0, 0, 0, 0, nullptr};
+  }
+}
+
+/* ring is allocated on first use, since psram is not initialized when globals are constructed */
+bool JuraShotProfileRecorder::allocateStorage(){
+  if (_storage != nullptr){return true;}
+
+  size_t size = SHOT_PROFILE_HISTORY_SIZE * SHOT_PROFILE_MAX_BYTES;
+  _storage = (uint8_t *) heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+  if (_storage == nullptr){
+    /* no psram on this board; fall back to internal heap */
+    _storage = (uint8_t *) malloc(size);
+  }
+
+  if (_storage == nullptr){
+    ESP_LOGI(TAG, "Shot profile storage unavailable (%i bytes)", size);
+    return false;
+  }
+
+  for (int i = 0; i < SHOT_PROFILE_HISTORY_SIZE; i++){
+    _profiles[i].data = _storage + (i * SHOT_PROFILE_MAX_BYTES);
+  }
+  return true;
+}
+
+/* open a new profile in the slot at the head of the ring */
+bool JuraShotProfileRecorder::startRecording(unsigned long timestamp){
+  if (!allocateStorage()){return false;}
+
+  JuraShotProfile &profile = _profiles[_head];
+  profile.sequence = ++_sequence;
+  profile.dispenseType = 0;
+  profile.truncated = false;
+  profile.startedAt = timestamp;
+  profile.duration = 0;
+  profile.sampleCount = 0;
+  profile.length = 0;
+
+  /* first sample is encoded relative to zero, i.e., absolute */
+  _last_sample_ms = timestamp;
+  for (int i = 0; i < SHOT_PROFILE_CHANNELS; i++){
+    _last_values[i] = 0;
+  }
+
+  _recording = true;
+  return true;
+}
+
+bool JuraShotProfileRecorder::isRecording(){
+  return _recording;
+}
+
+/* append the time delta and each channel delta; unchanged samples are skipped since dt preserves the timeline */
+bool JuraShotProfileRecorder::addSample(unsigned long timestamp, const int values[SHOT_PROFILE_CHANNELS]){
+  if (!_recording){return false;}
+
+  JuraShotProfile &profile = _profiles[_head];
+  if (profile.truncated){return false;}
+
+  bool hasChanged = profile.sampleCount == 0;
+  for (int i = 0; i < SHOT_PROFILE_CHANNELS && !hasChanged; i++){
+    hasChanged = values[i] != _last_values[i];
+  }
+  if (!hasChanged){return false;}
+
+  /* stop recording if the worst case sample would overflow this slot */
+  if (profile.length + SHOT_PROFILE_MAX_SAMPLE_BYTES > SHOT_PROFILE_MAX_BYTES || profile.sampleCount == UINT16_MAX){
+    profile.truncated = true;
+    return false;
+  }
+
+  appendVarint(profile, (uint32_t) (timestamp - _last_sample_ms));
+  for (int i = 0; i < SHOT_PROFILE_CHANNELS; i++){
+    appendVarint(profile, zigzag(values[i] - _last_values[i]));
+    _last_values[i] = values[i];
+  }
+
+  _last_sample_ms = timestamp;
+  profile.duration = timestamp - profile.startedAt;
+  profile.sampleCount++;
+  return true;
+}
+
+/* close the profile in progress and advance the ring */
+const JuraShotProfile * JuraShotProfileRecorder::finishRecording(int dispenseType){
+  if (!_recording){return nullptr;}
+  _recording = false;
+
+  JuraShotProfile &profile = _profiles[_head];
+  if (profile.sampleCount == 0){return nullptr;}
+
+  profile.dispenseType = dispenseType;
+  _head = (_head + 1) % SHOT_PROFILE_HISTORY_SIZE;
+  _count = _count < SHOT_PROFILE_HISTORY_SIZE ? _count + 1 : SHOT_PROFILE_HISTORY_SIZE;
+  return &profile;
+}
+
+/* most recent first */
+const JuraShotProfile * JuraShotProfileRecorder::profileAtIndex(int index){
+  if (index < 0 || index >= _count){return nullptr;}
+  int slot = (_head - 1 - index + (2 * SHOT_PROFILE_HISTORY_SIZE)) % SHOT_PROFILE_HISTORY_SIZE;
+  return &_profiles[slot];
+}
+
+int JuraShotProfileRecorder::count(){
+  return _count;
+}
+
+/* unsigned leb128 */
+void JuraShotProfileRecorder::appendVarint(JuraShotProfile &profile, uint32_t value){
+  while (value >= 0x80){
+    profile.data[profile.length++] = (uint8_t) (value | 0x80);
+    value >>= 7;
+  }
+  profile.data[profile.length++] = (uint8_t) value;
+}
+
+/* map signed deltas to unsigned so small negative values stay small */
+uint32_t JuraShotProfileRecorder::zigzag(int32_t value){
+  return ((uint32_t) value << 1) ^ (uint32_t) (value >> 31);
+}
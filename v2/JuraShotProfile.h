@@ -0,0 +1,65 @@
+#ifndef JURASHOTPROFILE_H
+#define JURASHOTPROFILE_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* channels recorded for every sample, in encoded order, following the sample's time delta */
+#define SHOT_PROFILE_CHANNELS         6   /* volume (raw), flow (ml/min), temperature (0.1 C), ceramic valve, output status, pump duty */
+#define SHOT_PROFILE_CHANNEL_NAMES    "dt,vol,flow,temp,cv,out,pump"
+#define SHOT_PROFILE_ENCODING         "zz-varint-delta"
+
+/* worst case bytes for a single sample: one varint of 5 bytes for time and each channel */
+#define SHOT_PROFILE_MAX_SAMPLE_BYTES ((SHOT_PROFILE_CHANNELS + 1) * 5)
+
+/* a completed (or in-progress) profile; data points into the recorder's ring storage */
+struct JuraShotProfile {
+  uint16_t sequence;
+  int dispenseType;
+  bool truncated;
+  unsigned long startedAt;
+  unsigned long duration;
+  uint16_t sampleCount;
+  uint16_t length;
+  uint8_t * data;
+};
+
+class JuraShotProfileRecorder {
+public:
+  JuraShotProfileRecorder();
+
+  /* open a new profile in the next ring slot; any profile in progress is discarded */
+  bool  startRecording        (unsigned long);
+
+  /* append a sample if any channel changed since the last sample; returns false if not recorded */
+  bool  addSample             (unsigned long, const int[SHOT_PROFILE_CHANNELS]);
+
+  /* close the profile in progress; returns null if nothing was recorded */
+  const JuraShotProfile * finishRecording (int);
+
+  bool  isRecording           ();
+
+  /* ring access; index 0 is the most recently completed profile */
+  const JuraShotProfile * profileAtIndex (int);
+  int   count                 ();
+
+private:
+  /* lazily allocated ring storage; psram when available */
+  uint8_t * _storage;
+  bool allocateStorage        ();
+
+  JuraShotProfile _profiles[SHOT_PROFILE_HISTORY_SIZE];
+  int _head;
+  int _count;
+  uint16_t _sequence;
+
+  /* in-progress state */
+  bool _recording;
+  unsigned long _last_sample_ms;
+  int _last_values[SHOT_PROFILE_CHANNELS];
+
+  /* encoding */
+  void  appendVarint          (JuraShotProfile &, uint32_t);
+  static uint32_t zigzag      (int32_t);
+};
+
+#endif
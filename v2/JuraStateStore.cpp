@@ -0,0 +1,211 @@
+#include "JuraStateStore.h"
+
+JuraStateStore::JuraStateStore() {
+  _epoch = 0;
+  _sequence = 0;
+  _newest = STATE_STORE_NONE;
+  for (int i = 0; i < STATE_STORE_SIZE; i++){
+    _newer[i] = STATE_STORE_NONE;
+    _older[i] = STATE_STORE_NONE;
+    _value[i] = 0;
+    _changed_at[i] = 0;
+    _epoch_of[i] = 0;
+  }
+  for (int w = 0; w < STATE_STORE_WORDS; w++){
+    _dirty[w] = 0;
+    _word_epoch[w] = 0;
+  }
+}
+
+/***************************************************************************//**
+ * Reader side of the seqlock. Waits out a write in progress on the other core; a
+ * write on this core cannot be interrupted, so an odd sequence is never seen here.
+ *
+ * @param[out] uint32_t sequence to pass to retryRead
+ ******************************************************************************/
+uint32_t JuraStateStore::beginRead() const {
+  uint32_t sequence;
+  while ((sequence = _sequence) & 1){}
+  __sync_synchronize();
+  return sequence;
+}
+
+bool JuraStateStore::retryRead(uint32_t sequence) const {
+  __sync_synchronize();
+  return _sequence != sequence;
+}
+
+/***************************************************************************//**
+ * Moves an entry to the front of the change-ordered list; caller holds the lock.
+ * Entries never stamped are not in the list and have no neighbours.
+ *
+ * @param[in] int index
+ ******************************************************************************/
+void JuraStateStore::moveToNewest(int index){
+  if (_newest == index){return;}
+
+  /* unlink */
+  if (_newer[index] != STATE_STORE_NONE){_older[_newer[index]] = _older[index];}
+  if (_older[index] != STATE_STORE_NONE){_newer[_older[index]] = _newer[index];}
+
+  /* push front */
+  _newer[index] = STATE_STORE_NONE;
+  _older[index] = _newest;
+  if (_newest != STATE_STORE_NONE){_newer[_newest] = index;}
+  _newest = index;
+}
+
+/***************************************************************************//**
+ * Advances the epoch and stamps an entry with it; caller holds the lock.
+ *
+ * @param[in] int index
+ * @param[in] unsigned long now
+ ******************************************************************************/
+void JuraStateStore::stamp(int index, unsigned long now){
+  _epoch++;
+  _changed_at[index] = now;
+  _epoch_of[index] = _epoch;
+  _word_epoch[index / 32] = _epoch;
+  moveToNewest(index);
+}
+
+unsigned long JuraStateStore::lastChanged(JuraMachineStateIdentifier state) const {
+  return _changed_at[(int) state];
+}
+
+JuraStateSample JuraStateStore::read(JuraMachineStateIdentifier state) const {
+  int index = (int) state;
+  JuraStateSample sample;
+  uint32_t sequence;
+  do {
+    sequence = beginRead();
+    sample.value = _value[index];
+    sample.changedAt = _changed_at[index];
+    sample.epoch = _epoch_of[index];
+  } while (retryRead(sequence));
+  return sample;
+}
+
+/***************************************************************************//**
+ * Collects every entry committed after a given epoch. Words with no newer entry
+ * are skipped whole, so a quiet store costs STATE_STORE_WORDS comparisons.
+ *
+ * @param[out] uint32_t epoch the mask is current to; pass as since next time
+ *
+ * @param[in]  uint32_t since
+ * @param[out] uint32_t mask[STATE_STORE_WORDS]
+ ******************************************************************************/
+uint32_t JuraStateStore::changedSince(uint32_t since, uint32_t mask[STATE_STORE_WORDS]) const {
+  uint32_t sequence;
+  uint32_t current;
+  do {
+    sequence = beginRead();
+    current = _epoch;
+    for (int w = 0; w < STATE_STORE_WORDS; w++){
+      mask[w] = 0;
+      if (_word_epoch[w] <= since){continue;}
+      for (int b = 0; b < 32 && w * 32 + b < STATE_STORE_SIZE; b++){
+        if (_epoch_of[w * 32 + b] > since){mask[w] |= (1UL << b);}
+      }
+    }
+  } while (retryRead(sequence));
+  return current;
+}
+
+/***************************************************************************//**
+ * Collects every entry stamped within a window of now, walking the change-ordered
+ * list from the newest entry and stopping at the first one outside the window.
+ * Entries stamped after now (by another task) count as inside the window.
+ *
+ * @param[out] int number of entries found
+ *
+ * @param[in]  unsigned long window
+ * @param[in]  unsigned long now
+ * @param[out] uint32_t mask[STATE_STORE_WORDS]
+ ******************************************************************************/
+int JuraStateStore::changedWithin(unsigned long window, unsigned long now, uint32_t mask[STATE_STORE_WORDS]) const {
+  uint32_t sequence;
+  int found;
+  do {
+    sequence = beginRead();
+    found = 0;
+    for (int w = 0; w < STATE_STORE_WORDS; w++){mask[w] = 0;}
+
+    /* bounded, in case links are read mid-write; the retry discards the result */
+    for (int i = _newest; i != STATE_STORE_NONE && found < STATE_STORE_SIZE; i = _older[i]){
+      long age = (long) (now - _changed_at[i]);
+      if (age >= (long) window){break;}
+      mask[i / 32] |= (1UL << (i % 32));
+      found++;
+    }
+  } while (retryRead(sequence));
+  return found;
+}
+
+/***************************************************************************//**
+ * Writes a value. Only a change is committed: the entry is stamped with the time
+ * and a new epoch, and marked dirty.
+ *
+ * @param[out] bool true if the value changed
+ *
+ * @param[in] JuraMachineStateIdentifier state
+ * @param[in] int value
+ * @param[in] unsigned long now
+ ******************************************************************************/
+bool JuraStateStore::commit(JuraMachineStateIdentifier state, int value, unsigned long now){
+  int index = (int) state;
+  bool changed = false;
+
+  portENTER_CRITICAL(&_lock);
+  if (_value[index] != value){
+    _sequence++;
+    __sync_synchronize();
+    _value[index] = value;
+    _dirty[index / 32] |= (1UL << (index % 32));
+    stamp(index, now);
+    __sync_synchronize();
+    _sequence++;
+    changed = true;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return changed;
+}
+
+bool JuraStateStore::commit(JuraMachineStateIdentifier state, int value){
+  return commit(state, value, millis());
+}
+
+void JuraStateStore::load(JuraMachineStateIdentifier state, int value){
+  portENTER_CRITICAL(&_lock);
+  _sequence++;
+  __sync_synchronize();
+  _value[(int) state] = value;
+  __sync_synchronize();
+  _sequence++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraStateStore::touch(JuraMachineStateIdentifier state, unsigned long now){
+  portENTER_CRITICAL(&_lock);
+  _sequence++;
+  __sync_synchronize();
+  stamp((int) state, now);
+  __sync_synchronize();
+  _sequence++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+bool JuraStateStore::isDirty(JuraMachineStateIdentifier state) const {
+  int index = (int) state;
+  return (_dirty[index / 32] >> (index % 32)) & 1;
+}
+
+bool JuraStateStore::takeDirty(JuraMachineStateIdentifier state){
+  int index = (int) state;
+  uint32_t bit = (1UL << (index % 32));
+  portENTER_CRITICAL(&_lock);
+  bool dirty = (_dirty[index / 32] & bit) != 0;
+  _dirty[index / 32] &= ~bit;
+  portEXIT_CRITICAL(&_lock);
+  return dirty;
+}
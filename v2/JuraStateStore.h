@@ -0,0 +1,97 @@
+#ifndef JURASTATESTORE_H
+#define JURASTATESTORE_H
+#include "JuraEnums.h"
+#include <Arduino.h>
+
+/* one entry per machine state identifier; change masks are kept 32 entries per word */
+#define STATE_STORE_SIZE    ((int) JuraMachineStateIdentifier::Count)
+#define STATE_STORE_WORDS   ((STATE_STORE_SIZE + 31) / 32)
+#define STATE_STORE_NONE    -1
+
+/* a consistent read of a single entry */
+struct JuraStateSample {
+  int value;
+  unsigned long changedAt;
+  uint32_t epoch;
+};
+
+/*
+
+  name:         JuraStateStore
+  type:         class
+  description:  value, change timestamp and dirty bit for every machine state,
+                stored as parallel arrays. every commit advances a global epoch
+                and stamps the entry with it, so consumers can ask for the set
+                of entries changed since an epoch they last saw.
+
+                writes are serialized with a spinlock and bracketed by a
+                sequence counter; reads never block and retry if a write
+                was in progress (seqlock).
+
+                stamped entries are also kept in a list ordered by change
+                time, so "what changed in the last n ms" walks only the
+                entries that did, newest first.
+
+*/
+class JuraStateStore {
+public:
+  JuraStateStore();
+
+  /* latest value; a single aligned word, safe to read from any task */
+  int operator[](int index) const {return _value[index];}
+
+  unsigned long lastChanged (JuraMachineStateIdentifier) const;
+  uint32_t      epoch       () const {return _epoch;}
+
+  /* value, timestamp and epoch of one entry, read together */
+  JuraStateSample read(JuraMachineStateIdentifier) const;
+
+  /* sets a bit in mask for every entry committed after epoch since; returns the epoch the mask is current to */
+  uint32_t changedSince(uint32_t since, uint32_t mask[STATE_STORE_WORDS]) const;
+
+  /* sets a bit in mask for every entry stamped within window ms of now; returns the number found */
+  int changedWithin(unsigned long window, unsigned long now, uint32_t mask[STATE_STORE_WORDS]) const;
+
+  static bool inMask(const uint32_t mask[STATE_STORE_WORDS], JuraMachineStateIdentifier state){
+    return (mask[(int) state / 32] >> ((int) state % 32)) & 1;
+  }
+
+  /* returns true if the value changed; unchanged values are not committed */
+  bool commit (JuraMachineStateIdentifier, int, unsigned long);
+  bool commit (JuraMachineStateIdentifier, int);
+
+  /* initial value (defaults, nvs); not a change, so neither stamped nor dirty */
+  void load   (JuraMachineStateIdentifier, int);
+
+  /* restamp the change time without changing the value (restarts timeouts) */
+  void touch  (JuraMachineStateIdentifier, unsigned long);
+
+  /* dirty bits; set on every value change, cleared by the consumer */
+  bool isDirty    (JuraMachineStateIdentifier) const;
+  bool takeDirty  (JuraMachineStateIdentifier);
+
+private:
+  int           _value      [STATE_STORE_SIZE];
+  unsigned long _changed_at [STATE_STORE_SIZE];
+  uint32_t      _epoch_of   [STATE_STORE_SIZE];
+  uint32_t      _dirty      [STATE_STORE_WORDS];
+
+  /* latest epoch of any entry in each word; lets changedSince skip unchanged words */
+  uint32_t      _word_epoch [STATE_STORE_WORDS];
+
+  /* entries ordered by change time, newest first; relinked on every stamp */
+  int16_t       _newer      [STATE_STORE_SIZE];
+  int16_t       _older      [STATE_STORE_SIZE];
+  int16_t       _newest;
+
+  uint32_t _epoch;
+  volatile uint32_t _sequence;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  void      stamp         (int, unsigned long);
+  void      moveToNewest  (int);
+  uint32_t  beginRead () const;
+  bool      retryRead (uint32_t) const;
+};
+
+#endif
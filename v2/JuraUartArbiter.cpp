@@ -0,0 +1,101 @@
+#include "JuraUartArbiter.h"
+
+JuraUartArbiter::JuraUartArbiter() {
+  memset(_waiters, 0, sizeof(_waiters));
+}
+
+/***************************************************************************//**
+ * Take the port if it is free; otherwise queue on the lane and sleep until a
+ * release hands it over. The wait is counted against the lane.
+ *
+ * @param[out] null
+ *
+ * @param[in] JuraUartLane lane
+ ******************************************************************************/
+void JuraUartArbiter::acquire(JuraUartLane lane){
+  int l = (int) lane;
+  unsigned long started = micros();
+
+  for (;;){
+    portENTER_CRITICAL(&_lock);
+    if (!_busy){
+      _busy = true;
+      _transfers[l]++;
+      portEXIT_CRITICAL(&_lock);
+      return;
+    }
+    if (_count[l] < JURA_UART_LANE_WAITERS){
+      _waiters[l][(_head[l] + _count[l]++) % JURA_UART_LANE_WAITERS] = xTaskGetCurrentTaskHandle();
+      portEXIT_CRITICAL(&_lock);
+      break;
+    }
+    /* more waiters than tasks; cannot happen with the shipped task table */
+    portEXIT_CRITICAL(&_lock);
+    vTaskDelay(1);
+  }
+
+  ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+  unsigned long wait = micros() - started;
+  portENTER_CRITICAL(&_lock);
+  _transfers[l]++;
+  _waited[l]++;
+  _wait_total[l] += wait;
+  if (wait > _wait_max[l]){_wait_max[l] = wait;}
+  portEXIT_CRITICAL(&_lock);
+}
+
+/***************************************************************************//**
+ * Hand the port to the oldest waiter of the highest waiting lane; it stays
+ * busy across the handover. Free it if nobody waits.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraUartArbiter::release(){
+  TaskHandle_t next = NULL;
+
+  portENTER_CRITICAL(&_lock);
+  for (int l = 0; l < JURA_UART_LANES && next == NULL; l++){
+    if (_count[l] == 0){continue;}
+    next = _waiters[l][_head[l]];
+    _head[l] = (_head[l] + 1) % JURA_UART_LANE_WAITERS;
+    _count[l]--;
+  }
+  if (next == NULL){_busy = false;}
+  portEXIT_CRITICAL(&_lock);
+
+  if (next != NULL){xTaskNotifyGive(next);}
+}
+
+bool JuraUartArbiter::contended(JuraUartLane lane){
+  bool waiting = false;
+  portENTER_CRITICAL(&_lock);
+  for (int l = 0; l < (int) lane; l++){waiting |= _count[l] > 0;}
+  portEXIT_CRITICAL(&_lock);
+  return waiting;
+}
+
+void JuraUartArbiter::notePreempted(JuraUartLane lane){
+  portENTER_CRITICAL(&_lock);
+  _preempted[(int) lane]++;
+  portEXIT_CRITICAL(&_lock);
+}
+
+void JuraUartArbiter::report(JuraUartLaneStats * stats){
+  portENTER_CRITICAL(&_lock);
+  for (int l = 0; l < JURA_UART_LANES; l++){
+    stats[l].transfers =  _transfers[l];
+    stats[l].waited =     _waited[l];
+    stats[l].meanWaitUs = _waited[l] > 0 ? _wait_total[l] / _waited[l] : 0;
+    stats[l].maxWaitUs =  _wait_max[l];
+    stats[l].preempted =  _preempted[l];
+    _transfers[l] = 0;
+    _waited[l] = 0;
+    _wait_total[l] = 0;
+    _wait_max[l] = 0;
+    _preempted[l] = 0;
+  }
+  portEXIT_CRITICAL(&_lock);
+}
@@ -0,0 +1,74 @@
+#ifndef JURAUARTARBITER_H
+#define JURAUARTARBITER_H
+#include "JuraConfiguration.h"
+#include <Arduino.h>
+
+/* service port lanes, highest priority first */
+enum class JuraUartLane {
+  Safety,         /* cancels and stops */
+  User,           /* presses, display text, menu navigation */
+  Background,     /* polling, research scans, probes, calibration */
+};
+#define JURA_UART_LANES 3
+
+/* one lane over one report window */
+struct JuraUartLaneStats {
+  uint32_t transfers;
+  uint32_t waited;              /* transfers that found the port busy */
+  unsigned long meanWaitUs;     /* over the transfers that waited */
+  unsigned long maxWaitUs;
+  uint32_t preempted;           /* reply waits cut short for a higher lane */
+};
+
+/*
+
+  name:         JuraUartArbiter
+  type:         class
+  description:  grants the service port to one transfer at a time. when the
+                port is released it is handed straight to the oldest waiter
+                of the highest lane, so a busy poll loop at a higher task
+                priority cannot take it back ahead of a queued press.
+
+                a transfer is never cut off while writing; a partial command
+                would corrupt the next one. a background transfer stops
+                waiting for its reply as soon as a higher lane is waiting, and
+                a user transfer after JURA_UART_PREEMPT_GRACE_MS, so the
+                safety lane waits at most one write plus that grace.
+
+                waiters sleep on their task notification; nothing else in the
+                sketch uses task notifications.
+
+*/
+class JuraUartArbiter {
+public:
+  JuraUartArbiter();
+
+  /* blocks until the port is granted to this task */
+  void acquire(JuraUartLane);
+  void release();
+
+  /* a lane above this one is waiting */
+  bool contended(JuraUartLane);
+  void notePreempted(JuraUartLane);
+
+  /* stats since the last report, per lane; resets them */
+  void report(JuraUartLaneStats *);
+
+private:
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+  bool _busy = false;
+
+  /* waiters per lane, oldest first */
+  TaskHandle_t _waiters[JURA_UART_LANES][JURA_UART_LANE_WAITERS];
+  int _head[JURA_UART_LANES] = {};
+  int _count[JURA_UART_LANES] = {};
+
+  /* report window */
+  uint32_t _transfers[JURA_UART_LANES] = {};
+  uint32_t _waited[JURA_UART_LANES] = {};
+  unsigned long long _wait_total[JURA_UART_LANES] = {};
+  unsigned long _wait_max[JURA_UART_LANES] = {};
+  uint32_t _preempted[JURA_UART_LANES] = {};
+};
+
+#endif
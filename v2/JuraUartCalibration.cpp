@@ -0,0 +1,134 @@
+#include "JuraUartCalibration.h"
+#include "JuraResponseLayouts.h"
+#include "Preferences.h"
+
+JuraUartCalibrator::JuraUartCalibrator(JuraMachine &machine, JuraBridge &bridge, Preferences &prefsRef) : _machine(&machine), _bridge(&bridge), preferences(prefsRef) {}
+
+/***************************************************************************//**
+ * Apply the gap stored by the last calibration or fallback. Without one, or
+ * with one outside 0 to the default, calibration is requested.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraUartCalibrator::begin(){
+  unsigned long gap = preferences.getULong(PREF_UART_GAP_KEY, 0);
+  if (gap == 0 || gap > DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL){
+    _requested = true;
+    return;
+  }
+  _bridge->servicePort.setCharacterGap(gap);
+  ESP_LOGI(TAG,"--> UART: character gap %lu us from nvs", gap);
+}
+
+/***************************************************************************//**
+ * Store a default gap restored by the service port, start a requested
+ * calibration once the machine is ready, and send one trial if calibrating.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraUartCalibrator::service(){
+  if (_bridge->servicePort.takeCharacterGapFallback()){
+    _fallbacks++;
+    store(DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL);
+    publishStatus();
+  }
+
+  if (!_calibrating){
+    if (!_requested || (long) (millis() - _retry_at) < 0){return;}
+    if (!(_machine->awaitMachineEvents(MACHINE_EVENT_READY, true, 0) & MACHINE_EVENT_READY)){return;}
+    _requested = false;
+    _calibrating = true;
+    _baseline = true;
+    _lo = 0;
+    _hi = DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL;
+    _candidate = _hi;
+    _trial = 0;
+    ESP_LOGI(TAG,"--> UART: calibrating character gap");
+  }
+
+  if (!(_machine->awaitMachineEvents(MACHINE_EVENT_READY, true, 0) & MACHINE_EVENT_READY)){
+    postpone("machine left ready");
+    return;
+  }
+
+  if (trial(_candidate)){
+    if (++_trial < JURA_UART_CALIBRATION_TRIALS){return;}
+    _hi = _candidate;
+  } else if (_baseline){
+    postpone("no reply at the default gap");
+    return;
+  } else {
+    _lo = _candidate;
+  }
+  _baseline = false;
+  next();
+}
+
+/* one IC: read at a gap; any reply but four hex characters fails it */
+bool JuraUartCalibrator::trial(unsigned long gap){
+  String response = _bridge->servicePort.transferEncodeCommandAtGap(JuraServicePortCommand::IC, gap);
+  if (response.length() != JuraInputControlBoardLayout::responseLength()){return false;}
+  for (int k = 0; k < response.length(); k++){
+    if (!isxdigit(response.charAt(k))){return false;}
+  }
+  return true;
+}
+
+/***************************************************************************//**
+ * Halve the interval, or, at the resolution, settle on the shortest passing
+ * gap plus JURA_UART_CALIBRATION_MARGIN_PCT of it (at least
+ * JURA_UART_CALIBRATION_MARGIN_MIN_US), never above the default.
+ *
+ * @param[out] null
+ *
+ * @param[in] null
+ ******************************************************************************/
+void JuraUartCalibrator::next(){
+  if (_hi - _lo > JURA_UART_CALIBRATION_RESOLUTION_US){
+    _candidate = _lo + (_hi - _lo) / 2;
+    _trial = 0;
+    return;
+  }
+
+  unsigned long margin = _hi * JURA_UART_CALIBRATION_MARGIN_PCT / 100;
+  if (margin < JURA_UART_CALIBRATION_MARGIN_MIN_US){margin = JURA_UART_CALIBRATION_MARGIN_MIN_US;}
+  unsigned long gap = _hi + margin;
+  if (gap > DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL){gap = DEV_BOARD_UART_CHAR_DELAY_MS * 1000UL;}
+
+  _calibrating = false;
+  _measured = _hi;
+  _calibrations++;
+  _bridge->servicePort.setCharacterGap(gap);
+  store(gap);
+  ESP_LOGI(TAG,"--> UART: shortest passing gap %lu us; using %lu us", _measured, gap);
+  publishStatus();
+}
+
+void JuraUartCalibrator::postpone(const char * reason){
+  ESP_LOGI(TAG,"--> UART: calibration postponed, %s", reason);
+  _calibrating = false;
+  _requested = true;
+  _retry_at = millis() + JURA_UART_CALIBRATION_RETRY_MS;
+}
+
+void JuraUartCalibrator::store(unsigned long gap){
+  if (preferences.getULong(PREF_UART_GAP_KEY, 0) != gap){preferences.putULong(PREF_UART_GAP_KEY, gap);}
+}
+
+JuraUartCalibrationStatus JuraUartCalibrator::status(){
+  JuraUartCalibrationStatus status;
+  status.gapUs =        _bridge->servicePort.characterGap();
+  status.measuredUs =   _measured;
+  status.calibrations = _calibrations;
+  status.fallbacks =    _fallbacks;
+  status.calibrating =  _calibrating;
+  return status;
+}
+
+void JuraUartCalibrator::publishStatus(){
+  _bridge->publishUartCalibration(status());
+}
@@ -0,0 +1,82 @@
+#ifndef JURAUARTCALIBRATION_H
+#define JURAUARTCALIBRATION_H
+#include "JuraConfiguration.h"
+#include "JuraMachine.h"
+#include "JuraBridge.h"
+
+/* forward declarations */
+class Preferences;
+
+/* snapshot for reporting */
+struct JuraUartCalibrationStatus {
+  unsigned long gapUs;          /* in use */
+  unsigned long measuredUs;     /* shortest passing gap of the last calibration since boot; 0 if none */
+  uint32_t calibrations;        /* completed since boot */
+  uint32_t fallbacks;           /* default gap restored since boot */
+  bool calibrating;
+};
+
+/*
+
+  name:         JuraUartCalibrator
+  type:         class
+  description:  finds the shortest pause after each encoded character that the
+                machine reliably accepts. a gap passes when
+                JURA_UART_CALIBRATION_TRIALS IC: reads in a row each return a
+                valid input board reply; the default gap must pass first, then
+                the range between 0 and the default is bisected down to
+                JURA_UART_CALIBRATION_RESOLUTION_US.
+
+                the shortest passing gap plus a margin is kept in nvs and used
+                from then on. one trial is sent per poll, between polls, and
+                only while the machine is ready; a machine that leaves ready or
+                stops answering the default gap postpones the calibration.
+
+                if unanswered transfers pile up at the calibrated gap, the
+                service port restores the default; that is stored too, so it
+                holds across a reboot until calibration is requested again.
+
+*/
+class JuraUartCalibrator {
+public:
+  JuraUartCalibrator(JuraMachine &, JuraBridge &, Preferences &);
+
+  /* apply the stored gap, or calibrate once the machine is ready; call after preferences are opened */
+  void begin();
+
+  /* calibrate again; from any task */
+  void request() {_requested = true;}
+
+  /* one trial if calibrating, and a default gap restored; poll task, between polls */
+  void service();
+
+  JuraUartCalibrationStatus status();
+  void publishStatus();
+
+private:
+  JuraMachine * _machine;
+  JuraBridge * _bridge;
+  Preferences &preferences;
+
+  volatile bool _requested = false;
+  unsigned long _retry_at = 0;
+
+  /* bisection; the gap at _hi passed, the gap at _lo did not or is 0 */
+  bool _calibrating = false;
+  bool _baseline = false;
+  unsigned long _lo = 0;
+  unsigned long _hi = 0;
+  unsigned long _candidate = 0;
+  int _trial = 0;
+
+  unsigned long _measured = 0;
+  uint32_t _calibrations = 0;
+  uint32_t _fallbacks = 0;
+
+  bool trial(unsigned long);
+  void next();
+  void postpone(const char *);
+  void store(unsigned long);
+};
+
+#endif
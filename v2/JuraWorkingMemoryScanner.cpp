@@ -0,0 +1,161 @@
+#include "JuraWorkingMemoryScanner.h"
+#include "JuraResponseLayouts.h"
+#include "JuraPollPlan.h"
+
+JuraWorkingMemoryScanner::JuraWorkingMemoryScanner() {
+  memset(_watch, 0, sizeof(_watch));
+  memset(_changes, 0, sizeof(_changes));
+}
+
+bool JuraWorkingMemoryScanner::isDue(int rate, int iterator){
+  return rate > 0 && rate < POLL_DISABLED && iterator % rate == 0;
+}
+
+/***************************************************************************//**
+ * Read a watch point or the next sweep batch, whichever is due; a watch point
+ * first, so at most one of them costs uart time in a poll.
+ *
+ * @param[out] bool true if changes are waiting and a sweep completed, or the
+ *                  watch points stopped (the dispense ended)
+ *
+ * @param[in] int iterator
+ * @param[in] JuraServicePort &servicePort
+ ******************************************************************************/
+bool JuraWorkingMemoryScanner::step(int iterator, JuraServicePort &servicePort){
+  bool waiting = false;
+
+  bool watching = _watch_rate > 0 && _watch_rate < POLL_DISABLED;
+  if (_watching && !watching){waiting = true;}
+  _watching = watching;
+
+  if (isDue(_watch_rate, iterator)){
+    stepWatch(servicePort);
+  } else if (isDue(_scan_rate, iterator)){
+    waiting |= stepScan(servicePort);
+  }
+  return waiting && _sequence != _published;
+}
+
+bool JuraWorkingMemoryScanner::stepWatch(JuraServicePort &servicePort){
+  portENTER_CRITICAL(&_lock);
+  int count = _watch_count;
+  uint8_t address = count > 0 ? _watch[_watch_next++ % count] : 0;
+  portEXIT_CRITICAL(&_lock);
+
+  return count > 0 && readAddress(address, true, servicePort);
+}
+
+/***************************************************************************//**
+ * Read up to JURA_WORKING_MEMORY_BATCH addresses of the current range. A batch
+ * ends early at the end of a range; an address that fails to read is retried on
+ * the next due poll.
+ *
+ * @param[out] bool true if the batch completed a sweep of every range
+ *
+ * @param[in] JuraServicePort &servicePort
+ ******************************************************************************/
+bool JuraWorkingMemoryScanner::stepScan(JuraServicePort &servicePort){
+  constexpr int ranges = sizeof(JuraWorkingMemoryRanges) / sizeof(JuraWorkingMemoryRanges[0]);
+
+  for (int n = 0; n < JURA_WORKING_MEMORY_BATCH; n++){
+    const JuraWorkingMemoryRange &range = JuraWorkingMemoryRanges[_range];
+    if (_address < range.first){_address = range.first;}
+
+    if (!readAddress(_address, false, servicePort)){return false;}
+
+    if (_address++ < range.last){continue;}
+    _address = -1;
+    if (++_range < ranges){return false;}
+    _range = 0;
+    _sweeps++;
+    return true;
+  }
+  return false;
+}
+
+/***************************************************************************//**
+ * Read one word into the shadow copy, logging it if it changed.
+ *
+ * @param[out] bool false if the response was invalid
+ *
+ * @param[in] uint8_t address
+ * @param[in] bool watched
+ * @param[in] JuraServicePort &servicePort
+ ******************************************************************************/
+bool JuraWorkingMemoryScanner::readAddress(uint8_t address, bool watched, JuraServicePort &servicePort){
+  if (address >= JURA_WORKING_MEMORY_WORDS){return false;}
+
+  JuraServicePortCommand command = (JuraServicePortCommand) ((int) JuraServicePortCommand::RM00 + address);
+  String response = servicePort.transferEncodeCommand(command);
+  if (response.length() != JuraWorkingMemoryLayout::responseLength()){return false;}
+
+  uint16_t value = 0;
+  for (int k = 0; k < JuraWorkingMemoryLayout::responseLength(); k++){
+    char c = response.charAt(k);
+    int digit = (c >= '0' && c <= '9') ? c - '0' : (c >= 'A' && c <= 'F') ? c - 'A' + 10 : (c >= 'a' && c <= 'f') ? c - 'a' + 10 : -1;
+    if (digit < 0){return false;}
+    value = (value << 4) | digit;
+  }
+
+  uint32_t bit = 1UL << (address % 32);
+  if ((_read[address / 32] & bit) && value != _shadow[address]){
+    _changed[address / 32] |= bit;
+
+    JuraWorkingMemoryChange &change = _changes[_head];
+    change.sequence = ++_sequence;
+    change.address =  address;
+    change.from =     _shadow[address];
+    change.to =       value;
+    change.watched =  watched;
+    change.state =    _state;
+    change.at =       millis();
+    _head = (_head + 1) % JURA_WORKING_MEMORY_HISTORY;
+    if (_count < JURA_WORKING_MEMORY_HISTORY){_count++;}
+
+    if (PRINT_UNHANDLED){ESP_LOGI(TAG,"UKN: [cmd:RM] [0x%02X] = %d -> %d (state %d%s)", address, change.from, change.to, _state, watched ? ", watched" : "");}
+  }
+  _read[address / 32] |= bit;
+  _shadow[address] = value;
+  return true;
+}
+
+/* adds a watch point; false if the list is full or the address is out of range */
+bool JuraWorkingMemoryScanner::watch(uint8_t address){
+  if (address >= JURA_WORKING_MEMORY_WORDS){return false;}
+  portENTER_CRITICAL(&_lock);
+  bool added = false;
+  bool present = false;
+  for (int i = 0; i < _watch_count; i++){present |= _watch[i] == address;}
+  if (!present && _watch_count < JURA_WORKING_MEMORY_WATCH_MAX){
+    _watch[_watch_count++] = address;
+    added = true;
+  }
+  portEXIT_CRITICAL(&_lock);
+  return added || present;
+}
+
+void JuraWorkingMemoryScanner::clearWatches(){
+  portENTER_CRITICAL(&_lock);
+  _watch_count = 0;
+  _watch_next = 0;
+  portEXIT_CRITICAL(&_lock);
+}
+
+int JuraWorkingMemoryScanner::watches(uint8_t * addresses, int max){
+  portENTER_CRITICAL(&_lock);
+  int n = _watch_count < max ? _watch_count : max;
+  memcpy(addresses, _watch, n);
+  portEXIT_CRITICAL(&_lock);
+  return n;
+}
+
+int JuraWorkingMemoryScanner::takeChanges(JuraWorkingMemoryChange * changes, int max){
+  int n = 0;
+  for (int i = 0; i < _count && n < max; i++){
+    const JuraWorkingMemoryChange &change = _changes[(_head + JURA_WORKING_MEMORY_HISTORY - _count + i) % JURA_WORKING_MEMORY_HISTORY];
+    if ((int16_t) (change.sequence - _published) <= 0){continue;}
+    changes[n++] = change;
+  }
+  _published = n < max ? _sequence : changes[n - 1].sequence;
+  return n;
+}
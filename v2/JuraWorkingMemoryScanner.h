@@ -0,0 +1,93 @@
+#ifndef JURAWORKINGMEMORYSCANNER_H
+#define JURAWORKINGMEMORYSCANNER_H
+#include "JuraConfiguration.h"
+#include "JuraServicePort.h"
+#include <Arduino.h>
+
+/* one word that changed between two reads */
+struct JuraWorkingMemoryChange {
+  uint16_t sequence;
+  uint8_t address;
+  uint16_t from;
+  uint16_t to;
+  bool watched;             /* read as a watch point, not by the sweep */
+  uint8_t state;            /* operational state when read */
+  unsigned long at;
+};
+
+/*
+
+  name:         JuraWorkingMemoryScanner
+  type:         class
+  description:  research reader for RM: working memory. two poll plan sources:
+                the sweep reads JuraWorkingMemoryRanges in batches while idle
+                or ready, and watch points, read one per due poll during grind,
+                brew, water and milk operations, so chosen addresses are
+                sampled far more often than a sweep revisits them.
+
+                every read lands in a shadow copy of the whole memory; a word
+                that differs from its shadow is flagged in a change bitmap and
+                logged. the first read of a word only sets its shadow. polling
+                is on the poll task only; watch points may be set from any.
+
+*/
+class JuraWorkingMemoryScanner {
+public:
+  JuraWorkingMemoryScanner();
+
+  /* set by the poll plans; POLL_DISABLED stops either */
+  void setScanRate(int modulus) {_scan_rate = modulus;}
+  void setWatchRate(int modulus) {_watch_rate = modulus;}
+  void noteOperationalState(int state) {_state = state;}
+
+  /* read the next batch or watch point if due; true when changes are waiting at the end of a sweep or a watch */
+  bool step(int, JuraServicePort &);
+
+  /* watch points */
+  bool watch(uint8_t);
+  void clearWatches();
+  int watches(uint8_t *, int);
+
+  int sweeps() {return _sweeps;}
+  bool hasChanged(int address) {return (_changed[address / 32] >> (address % 32)) & 1;}
+  uint16_t value(int address) {return _shadow[address];}
+
+  /* changes not yet published, oldest first; marks them published */
+  int takeChanges(JuraWorkingMemoryChange *, int);
+
+private:
+  int _scan_rate = 0;
+  int _watch_rate = 0;
+  int _state = 0;
+  bool _watching = false;
+
+  /* sweep position */
+  int _range = 0;
+  int _address = -1;
+  int _sweeps = 0;
+
+  /* shadow copy */
+  uint16_t _shadow[JURA_WORKING_MEMORY_WORDS] = {};
+  uint32_t _read[(JURA_WORKING_MEMORY_WORDS + 31) / 32] = {};
+  uint32_t _changed[(JURA_WORKING_MEMORY_WORDS + 31) / 32] = {};
+
+  /* watch points */
+  uint8_t _watch[JURA_WORKING_MEMORY_WATCH_MAX];
+  int _watch_count = 0;
+  int _watch_next = 0;
+  portMUX_TYPE _lock = portMUX_INITIALIZER_UNLOCKED;
+
+  /* recent changes */
+  JuraWorkingMemoryChange _changes[JURA_WORKING_MEMORY_HISTORY];
+  int _head = 0;
+  int _count = 0;
+  uint16_t _sequence = 0;
+  uint16_t _published = 0;
+
+  static bool isDue(int, int);
+  bool stepWatch(JuraServicePort &);
+  bool stepScan(JuraServicePort &);
+  bool readAddress(uint8_t, bool, JuraServicePort &);
+};
+
+#endif
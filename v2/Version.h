@@ -2,14 +2,39 @@
 #define VERSION_H
 
 /* current version */
-#define VERSION_STR         "0.7.12" /* reported via mqtt device discovery as version number*/
-#define VERSION_INT         12       /* iteration of this value will trigger an automatic mqtt configuration update on boot*/
+#define VERSION_STR         "0.7.37" /* reported via mqtt device discovery as version number*/
+#define VERSION_INT         37       /* iteration of this value will trigger an automatic mqtt configuration update on boot*/
 #define VERSION_MAJOR_STR   "7"     /* needs to be string type; displayed in the display*/
 
 /* useful for debugging unusual errors; usually related to EEPROM states getting improperly set*/
 #define DISABLE_NONVOLATILE_LOAD false
 
 /*
+0.7.37 - states not delivered during a broker outage are replayed on reconnect; drink counters logged in order on /backlog
+0.7.36 - Home Assistant restarts trigger a background rediscovery (discovery configs and last states) instead of a reboot
+0.7.35 - event driven wi-fi and broker reconnects with cached access point and jittered backoff; no reboot on network loss; recovery time on /diagnostics/network
+0.7.34 - DT: display writes deduplicated, rate limited and merged, with priorities so connection status does not overwrite the button menu
+0.7.33 - service port access arbitrated by lane (safety, user, background); background reply waits yield to higher lanes; waits per lane on /diagnostics/uart/lanes
+0.7.32 - UART character gap calibrated by bisection over IC: reads, stored in nvs with a margin; default restored when transfers go unanswered
+0.7.31 - machine connection state machine (online, degraded, offline, probing); polling stops while offline, IC: probe with backoff, status on /diagnostics/connection
+0.7.30 - working memory (WORKING_MEMORY_SCANNER); RM: commands pre-encoded, batched sweep into a shadow copy while idle or ready, watch points during dispenses via /research/memory/watch
+0.7.29 - eeprom research scanner (EEPROM_SCANNER); every RT: line while idle or ready, changed words and their state transitions on /research/eeprom
+0.7.28 - static service port commands pre-encoded to wire bytes at compile time; no String constants or per-poll encoding
+0.7.27 - memory monitor: heap and stack headroom as bridge diagnostic entities, /diagnostics/memory, MEMORY_PROFILING per path; stacks right-sized
+0.7.26 - task topology table (core, priority, stack); poll pinned to core 1; poll jitter probe on /diagnostics/jitter
+0.7.25 - drink latency milestones from mqtt receipt to ready; per product p50/p90 per stage on /latency/<function>
+0.7.24 - predictive preheat; first drink times learned in nvs, hot water flush ahead of demand, results on /preheat
+0.7.23 - user recipes compiled to bytecode in nvs; set via /recipe/set, run via /recipe/run, listed on /recipe/list and in the menu
+0.7.22 - custom menu compiled to packed recipes at build time; user menu items in nvs via MQTT_ROOT/menu/item
+0.7.21 - order queue on MQTT_ROOT/order; drinks served back-to-back, eta and service time on /order/status
+0.7.20 - menu navigation confirms each press from the machine instead of fixed 300 ms delays
+0.7.19 - machine events for dispense and error edges; product selection waits on events instead of polling
+0.7.18 - event-driven recipe engine for add shot; machine event group; drink-to-drink gap logged
+0.7.17 - change-ordered state index; completion handler reads recent changes instead of scanning all states
+0.7.16 - machine states move to a state store; serialized commits, change epochs, seqlock reads
+0.7.15 - single templated response source with per-command layouts replaces RT/IC/HZ/CS/RM parsers
+0.7.14 - constexpr poll plan tables per operational state; applied on state transition only
+0.7.13 - shot profile recorder; compressed per-dispense trace published to MQTT_ROOT/profile
 0.7.12 - bypass broker for custom menu
 0.7.11 - fix race condition for add shot; remove drip tray language == drainage tray 
 0.7.10 - fix polling error skipping over error correction